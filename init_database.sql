@@ -207,6 +207,41 @@ SELECT
 FROM products p
 LEFT JOIN categories c ON p.category_id = c.id;
 
+-- Уведомления об изменениях: агент слушает канал table_changes
+-- и сбрасывает закэшированные результаты запросов к изменённой таблице
+CREATE OR REPLACE FUNCTION notify_table_change() RETURNS trigger AS $$
+BEGIN
+    PERFORM pg_notify('table_changes', TG_TABLE_NAME);
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE TRIGGER users_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON users
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+CREATE TRIGGER categories_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON categories
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+CREATE TRIGGER products_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON products
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+CREATE TRIGGER customers_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON customers
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+CREATE TRIGGER orders_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON orders
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+CREATE TRIGGER order_items_notify_change AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON order_items
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_table_change();
+
+-- DDL: пустое уведомление в тот же канал - агент сверяет каталог схемы
+-- и сбрасывает кэш результатов целиком. Событийные триггеры создаёт только
+-- суперпользователь; без них каталог обновляется по schema_refresh_seconds.
+CREATE OR REPLACE FUNCTION notify_schema_change() RETURNS event_trigger AS $$
+BEGIN
+    PERFORM pg_notify('table_changes', '');
+END;
+$$ LANGUAGE plpgsql;
+
+DROP EVENT TRIGGER IF EXISTS schema_change_notify;
+CREATE EVENT TRIGGER schema_change_notify ON ddl_command_end
+    EXECUTE FUNCTION notify_schema_change();
+
 -- Вывод статистики
 SELECT 'Database initialized successfully!' as status;
 SELECT 'Total users: ' || COUNT(*) as info FROM users;
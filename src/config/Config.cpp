@@ -23,12 +23,47 @@ void Config::setDefaults() {
     config_["training_data_path"] = "training_data/queries.json";
     config_["log_file"] = "agent.log";
     config_["log_level"] = "INFO";
+    config_["log_overflow"] = "block";
+    config_["log_flush_interval_ms"] = "100";
+    config_["speculative_decoding"] = "true";
+    config_["constrained_decoding"] = "true";
+    config_["nl_cache_bytes"] = "16777216";
+    config_["nl_cache_shards"] = "16";
+    config_["semantic_cache_capacity"] = "4096";
+    config_["semantic_cache_threshold"] = "0.95";
+    config_["result_cache_bytes"] = "67108864";
+    config_["result_cache_shards"] = "16";
+    config_["result_cache_ttl_seconds"] = "300";
+    config_["pool_min_size"] = "1";
+    config_["pool_max_size"] = "8";
+    config_["pool_acquire_timeout_ms"] = "5000";
+    config_["pool_idle_timeout_seconds"] = "300";
+    config_["pool_health_check_seconds"] = "30";
+    config_["pool_max_backoff_ms"] = "30000";
+    config_["statement_cache_size"] = "64";
+    config_["binary_results"] = "true";
+    config_["async_connections"] = "2";
+    config_["async_pipeline_depth"] = "64";
+    config_["schema_refresh_seconds"] = "60";
+    config_["db_replicas"] = "";
+    config_["replica_max_lag_seconds"] = "5";
+    config_["replica_check_seconds"] = "5";
+    config_["stream_batch_rows"] = "1000";
+    config_["stream_batch_bytes"] = "4194304";
+    config_["max_result_rows"] = "100000";
+    config_["max_query_length"] = "1000";
+    config_["timeout_seconds"] = "30";
+    config_["generated_row_limit"] = "1000";
+    config_["csv_delimiter"] = ",";
+    config_["csv_null"] = "";
+    config_["table_max_column_width"] = "40";
+    config_["table_sample_rows"] = "1000";
 }
 
 bool Config::loadFromFile(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
-        Logger::getInstance().error("Cannot open config file: " + filename);
+        LOG_ERROR("Cannot open config file: ", filename);
         return false;
     }
     
@@ -44,8 +79,8 @@ bool Config::loadFromFile(const std::string& filename) {
         
         size_t pos = line.find('=');
         if (pos == std::string::npos) {
-            Logger::getInstance().warning("Invalid config line " + 
-                                        std::to_string(lineNumber) + ": " + line);
+            LOG_WARNING("Invalid config line ", 
+                      lineNumber, ": ", line);
             continue;
         }
         
@@ -55,7 +90,7 @@ bool Config::loadFromFile(const std::string& filename) {
         config_[key] = value;
     }
     
-    Logger::getInstance().info("Configuration loaded from: " + filename);
+    LOG_INFO("Configuration loaded from: ", filename);
     return true;
 }
 
@@ -76,6 +111,18 @@ int Config::getInt(const std::string& key, int defaultValue) const {
     return defaultValue;
 }
 
+double Config::getDouble(const std::string& key, double defaultValue) const {
+    auto it = config_.find(key);
+    if (it != config_.end()) {
+        try {
+            return std::stod(it->second);
+        } catch (...) {
+            return defaultValue;
+        }
+    }
+    return defaultValue;
+}
+
 bool Config::getBool(const std::string& key, bool defaultValue) const {
     auto it = config_.find(key);
     if (it != config_.end()) {
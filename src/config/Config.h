@@ -13,6 +13,7 @@ public:
     
     std::string get(const std::string& key, const std::string& defaultValue = "") const;
     int getInt(const std::string& key, int defaultValue = 0) const;
+    double getDouble(const std::string& key, double defaultValue = 0.0) const;
     bool getBool(const std::string& key, bool defaultValue = false) const;
     
     void set(const std::string& key, const std::string& value);
@@ -1,5 +1,16 @@
 #include "src/core/Agent.h"
+#include "src/core/CsvWriter.h"
+#include "src/core/PgValue.h"
 #include "src/utils/Logger.h"
+#include "src/utils/SqlParser.h"
+#include "src/utils/SqlText.h"
+#include "src/utils/Utilities.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
 
 Agent::Agent() 
     : outputFormat_(ResponseParser::OutputFormat::TABLE),
@@ -18,25 +29,101 @@ Agent::~Agent() {
 }
 
 bool Agent::initialize(const std::string& configFile) {
-    Logger::getInstance().info("Initializing AI Query Agent...");
+    LOG_INFO("Initializing AI Query Agent...");
     
     Config& config = Config::getInstance();
     
     if (!configFile.empty()) {
         if (!config.loadFromFile(configFile)) {
-            Logger::getInstance().warning("Using default configuration");
+            LOG_WARNING("Using default configuration");
         }
     }
     
     // Настройка логирования
     Logger::getInstance().setLogFile(config.get("log_file", "agent.log"));
+    LogLevel level = LogLevel::INFO;
+    std::string levelName = config.get("log_level", "INFO");
+    if (!Logger::parseLevel(levelName, level)) {
+        LOG_WARNING("Unknown log_level '", levelName, "', using INFO");
+    }
+    Logger::getInstance().setLogLevel(level);
+    Logger::getInstance().setFlushInterval(
+        std::chrono::milliseconds(config.getInt("log_flush_interval_ms", 100)));
+    std::string overflow = Utils::toLower(config.get("log_overflow", "block"));
+    if (overflow == "drop") {
+        Logger::getInstance().setOverflowPolicy(Logger::OverflowPolicy::Drop);
+    } else {
+        if (overflow != "block") {
+            LOG_WARNING("Unknown log_overflow '", overflow, "', using block");
+        }
+        Logger::getInstance().setOverflowPolicy(Logger::OverflowPolicy::Block);
+    }
     
     // Инициализация NL процессора
     std::string modelPath = config.getModelPath();
+    nlProcessor_->setSpeculativeDecoding(config.getBool("speculative_decoding", true));
+    nlProcessor_->setConstrainedDecoding(config.getBool("constrained_decoding", true));
+    nlProcessor_->configureCache(
+        static_cast<size_t>(config.getInt("nl_cache_bytes", 16 * 1024 * 1024)),
+        static_cast<size_t>(config.getInt("nl_cache_shards", 16)));
+    nlProcessor_->configureSemanticCache(
+        static_cast<size_t>(config.getInt("semantic_cache_capacity", 4096)),
+        config.getDouble("semantic_cache_threshold", 0.95));
     nlProcessor_->initialize(modelPath);
     
+    ConnectionPool::Options pool;
+    pool.minSize = static_cast<size_t>(config.getInt("pool_min_size", 1));
+    pool.maxSize = static_cast<size_t>(config.getInt("pool_max_size", 8));
+    pool.acquireTimeout = std::chrono::milliseconds(config.getInt("pool_acquire_timeout_ms", 5000));
+    pool.idleTimeout = std::chrono::seconds(config.getInt("pool_idle_timeout_seconds", 300));
+    pool.healthCheckInterval = std::chrono::seconds(config.getInt("pool_health_check_seconds", 30));
+    pool.maxBackoff = std::chrono::milliseconds(config.getInt("pool_max_backoff_ms", 30000));
+    pool.statementCacheSize = static_cast<size_t>(config.getInt("statement_cache_size", 64));
+    pool.binaryResults = config.getBool("binary_results", true);
+    dbConnector_->configurePool(pool);
+    
+    AsyncExecutor::Options async;
+    async.connections = static_cast<size_t>(config.getInt("async_connections", 2));
+    async.pipelineDepth = static_cast<size_t>(config.getInt("async_pipeline_depth", 64));
+    dbConnector_->configureAsync(async);
+    
+    streamOptions_.batchRows = static_cast<size_t>(config.getInt("stream_batch_rows", 1000));
+    streamOptions_.batchBytes = static_cast<size_t>(config.getInt("stream_batch_bytes", 4 * 1024 * 1024));
+    streamOptions_.maxRows = static_cast<size_t>(config.getInt("max_result_rows", 100000));
+    
+    ReplicaRouter::Options replicas;
+    replicas.maxLag = std::chrono::milliseconds(
+        static_cast<int64_t>(config.getDouble("replica_max_lag_seconds", 5.0) * 1000));
+    replicas.checkInterval = std::chrono::seconds(std::max(config.getInt("replica_check_seconds", 5), 1));
+    dbConnector_->configureReplicas(Utils::split(config.get("db_replicas"), ','), replicas);
+    
+    dbConnector_->configureStatementTimeout(
+        std::chrono::seconds(config.getInt("timeout_seconds", 30)));
+    maxQueryLength_ = static_cast<size_t>(std::max(config.getInt("max_query_length", 1000), 0));
+    generatedRowLimit_ = static_cast<size_t>(std::max(config.getInt("generated_row_limit", 1000), 0));
+    
+    std::string delimiter = config.get("csv_delimiter", ",");
+    if (delimiter == "\\t") delimiter = "\t";
+    CsvWriter::Options csv{delimiter.size() == 1 ? delimiter[0] : '\0', config.get("csv_null", "")};
+    if (!CsvWriter::valid(csv)) {
+        LOG_WARNING("Invalid csv_delimiter/csv_null, using defaults");
+        csv = CsvWriter::Options();
+    }
+    responseParser_->setCsvOptions(csv.delimiter, csv.nullText);
+    responseParser_->setTableOptions(
+        static_cast<size_t>(std::max(config.getInt("table_max_column_width", 40), 0)),
+        static_cast<size_t>(std::max(config.getInt("table_sample_rows", 1000), 0)));
+    
+    dbConnector_->configureSchemaCatalog(
+        std::chrono::seconds(config.getInt("schema_refresh_seconds", 60)));
+    
+    dbConnector_->configureResultCache(
+        static_cast<size_t>(config.getInt("result_cache_bytes", 64 * 1024 * 1024)),
+        static_cast<size_t>(config.getInt("result_cache_shards", 16)),
+        config.getInt("result_cache_ttl_seconds", 300));
+    
     initialized_ = true;
-    Logger::getInstance().info("Agent initialized successfully");
+    LOG_INFO("Agent initialized successfully");
     
     return true;
 }
@@ -46,9 +133,89 @@ bool Agent::connectToDatabase(const std::string& host, int port,
                               const std::string& user,
                               const std::string& password) {
     
-    Logger::getInstance().info("Connecting to database: " + dbname);
+    LOG_INFO("Connecting to database: ", dbname);
+    
+    if (!dbConnector_->connect(host, port, dbname, user, password)) {
+        return false;
+    }
     
-    return dbConnector_->connect(host, port, dbname, user, password);
+    refreshSchema();
+    return true;
+}
+
+void Agent::refreshSchema() {
+    std::map<std::string, std::vector<std::string>> schema;
+    
+    auto snapshot = dbConnector_->getSchemaSnapshot();
+    if (snapshot->version > 0) {
+        for (const auto& [name, table] : snapshot->tables) {
+            auto& columns = schema[name];
+            for (const auto& column : table->columns) {
+                columns.push_back(column.name);
+            }
+        }
+    } else {
+        for (const auto& [table, tableSchema] : dbConnector_->getTableSchemas(dbConnector_->getTableNames())) {
+            auto& columns = schema[table];
+            for (const auto& [column, info] : tableSchema) {
+                columns.push_back(column);
+            }
+        }
+    }
+    
+    schemaVersion_ = snapshot->version;
+    nlProcessor_->setSchema(schema);
+}
+
+std::string Agent::listTables() {
+    if (!dbConnector_->isConnected()) {
+        return "Error: Not connected to database";
+    }
+    
+    auto snapshot = dbConnector_->getSchemaSnapshot();
+    if (snapshot->version == 0) {
+        return executeSQL("SELECT table_name FROM information_schema.tables "
+                          "WHERE table_schema = 'public'");
+    }
+    
+    DatabaseConnector::QueryResult result;
+    result.addColumn("table_name", 0);
+    result.addColumn("columns", PgValue::kInt4);
+    result.addColumn("primary_key", 0);
+    result.addColumn("references", 0);
+    
+    auto append = [&result](size_t column, const std::string& value) {
+        result.data[column].append(value.data(), value.size());
+    };
+    auto joinNames = [](const std::vector<std::string>& names) {
+        std::string out;
+        for (const auto& name : names) {
+            if (!out.empty()) out += ", ";
+            out += name;
+        }
+        return out;
+    };
+    
+    for (const auto& [name, table] : snapshot->tables) {
+        std::string primaryKey;
+        for (const auto& index : table->indexes) {
+            if (index.primary) primaryKey = joinNames(index.columns);
+        }
+        std::string references;
+        for (const auto& key : table->foreignKeys) {
+            if (!references.empty()) references += "; ";
+            references += joinNames(key.columns) + " -> " + key.refTable + "(" + joinNames(key.refColumns) + ")";
+        }
+        
+        append(0, name);
+        append(1, std::to_string(table->columns.size()));
+        append(2, primaryKey);
+        append(3, references);
+        result.rowCount++;
+    }
+    
+    result.success = true;
+    return responseParser_->formatResponse(result, outputFormat_);
 }
 
 std::string Agent::processNaturalLanguageQuery(const std::string& query) {
@@ -57,19 +224,48 @@ std::string Agent::processNaturalLanguageQuery(const std::string& query) {
 }
 
 Agent::QueryResponse Agent::processQueryDetailed(const std::string& naturalLanguageQuery) {
+    QueryResponse response = generateSQL(naturalLanguageQuery);
+    if (!response.success || !dbConnector_->isConnected()) {
+        return response;
+    }
+    
+    // Выполнение запроса (когда БД подключена)
+    StringSink out;
+    std::string error;
+    if (!streamResult(response.sqlQuery, out, error)) {
+        response.success = false;
+        response.errorMessage = error;
+        return response;
+    }
+    response.result = out.take();
+    return response;
+}
+
+Agent::QueryResponse Agent::generateSQL(const std::string& naturalLanguageQuery) {
     QueryResponse response;
     response.success = false;
     response.confidence = 0.0;
     
     if (!initialized_) {
         response.errorMessage = "Agent not initialized";
-        Logger::getInstance().error(response.errorMessage);
+        LOG_ERROR(response.errorMessage);
+        return response;
+    }
+
+    if (maxQueryLength_ > 0 && naturalLanguageQuery.size() > maxQueryLength_) {
+        response.errorMessage = "Query is too long (max " + std::to_string(maxQueryLength_) + " characters)";
+        LOG_ERROR(response.errorMessage);
         return response;
     }
 
     const bool dbReady = dbConnector_->isConnected();
     
-    Logger::getInstance().info("Processing query: " + naturalLanguageQuery);
+    // Схема изменилась (DDL) - ограничения декодера и кэши NL устарели
+    if (dbReady && dbConnector_->getSchemaSnapshot()->version != schemaVersion_) {
+        refreshSchema();
+    }
+    
+    LOG_INFO("Processing query: ", naturalLanguageQuery);
     
     // Обработка естественного языка
     auto nlResult = nlProcessor_->processQueryDetailed(naturalLanguageQuery);
@@ -85,53 +281,135 @@ Agent::QueryResponse Agent::processQueryDetailed(const std::string& naturalLangu
     // Валидация SQL
     if (!queryBuilder_->validateSQL(response.sqlQuery)) {
         response.errorMessage = "Generated SQL failed validation";
-        Logger::getInstance().error(response.errorMessage);
+        LOG_ERROR(response.errorMessage);
         return response;
     }
     
+    // Сгенерированный SELECT не должен выгружать таблицу целиком
+    if (generatedRowLimit_ > 0) {
+        std::string limited = Utils::limitRows(response.sqlQuery, generatedRowLimit_);
+        if (Utils::normalizeSql(limited) != Utils::normalizeSql(response.sqlQuery)) {
+            response.sqlQuery = limited;
+            limitsInjected_++;
+        }
+    }
+    
     // Если БД недоступна, но оффлайн-режим разрешён — вернуть только сгенерированный SQL
     if (!dbReady) {
         if (allowOfflineSQL_) {
             response.result = ""; // нет результата без выполнения
             response.success = true;
-            Logger::getInstance().warning("Offline SQL generation: database is not connected, returning SQL only");
+            LOG_WARNING("Offline SQL generation: database is not connected, returning SQL only");
             return response;
         } else {
             response.errorMessage = "Not connected to database";
-            Logger::getInstance().error(response.errorMessage);
+            LOG_ERROR(response.errorMessage);
             return response;
         }
     }
-
-    // Выполнение запроса (когда БД подключена)
-    {
-        auto dbResult = dbConnector_->executeQuery(response.sqlQuery);
-        if (!dbResult.success) {
-            response.errorMessage = dbResult.errorMessage;
-            return response;
-        }
-        response.result = responseParser_->formatResponse(dbResult, outputFormat_);
-        response.success = true;
-    }
     
+    response.success = true;
     return response;
 }
 
 std::string Agent::executeSQL(const std::string& sqlQuery) {
+    StringSink out;
+    executeSQL(sqlQuery, out);
+    return out.take();
+}
+
+bool Agent::executeSQL(const std::string& sqlQuery, OutputSink& out) {
     if (!dbConnector_->isConnected()) {
-        return "Error: Not connected to database";
+        out.write("Error: Not connected to database");
+        return false;
+    }
+    
+    if (maxQueryLength_ > 0 && sqlQuery.size() > maxQueryLength_) {
+        out.write("Error: SQL is too long (max " + std::to_string(maxQueryLength_) + " characters)");
+        return false;
     }
     
     if (!queryBuilder_->validateSQL(sqlQuery)) {
-        return "Error: SQL validation failed";
+        out.write("Error: SQL validation failed");
+        return false;
     }
     
-    auto result = dbConnector_->executeQuery(sqlQuery);
-    return responseParser_->formatResponse(result, outputFormat_);
+    return writeResult(sqlQuery, out);
+}
+
+bool Agent::writeResult(const std::string& sql, OutputSink& out) {
+    if (!outputFile_.empty()) {
+        return writeResultToFile(sql, out);
+    }
+    std::string error;
+    if (!streamResult(sql, out, error)) {
+        out.write("Error: " + error);
+        return false;
+    }
+    return true;
+}
+
+bool Agent::writeResultToFile(const std::string& sql, OutputSink& out) {
+    int fd = ::open(outputFile_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        out.write("Error: Cannot open " + outputFile_ + ": " + std::strerror(errno));
+        return false;
+    }
+    
+    std::string error;
+    uint64_t bytes = 0;
+    bool ok;
+    {
+        FdSink file(fd);
+        ok = streamResult(sql, file, error);
+        if (ok && !file.flush()) {
+            ok = false;
+            error = "Write to " + outputFile_ + " failed";
+        }
+        bytes = file.bytesWritten();
+    }
+    ::close(fd);
+    
+    if (!ok) {
+        out.write("Error: " + error);
+        return false;
+    }
+    out.write("Result written to " + outputFile_ + " (" + std::to_string(bytes) + " bytes)");
+    return true;
+}
+
+bool Agent::streamResult(const std::string& sql, OutputSink& out, std::string& error) {
+    // CSV одиночного SELECT формирует сервер: байты COPY сразу идут в вывод
+    if (outputFormat_ == ResponseParser::OutputFormat::CSV && Utils::isPlainSelect(Utils::normalizeSql(sql))) {
+        auto copy = dbConnector_->copyOut(sql, responseParser_->csvCopyOptions(), [&out](const char* data, size_t size) {
+            out.write(data, size);
+            return out.good();
+        });
+        if (!copy.success && out.good()) {
+            error = copy.errorMessage;
+            return false;
+        }
+        return true;
+    }
+    
+    // Строки форматируются пачками по мере чтения, результат целиком не
+    // собирается (кроме форматов, которым нужен весь результат)
+    auto writer = responseParser_->makeWriter(outputFormat_, out);
+    auto stream = dbConnector_->streamQuery(sql, [&writer, &out](const DatabaseConnector::QueryResult& batch) {
+        writer->write(batch);
+        return out.good();
+    }, streamOptions_);
+    
+    if (!stream.success) {
+        error = stream.errorMessage;
+        return false;
+    }
+    writer->finish(stream.rowCount, stream.truncated);
+    return true;
 }
 
 bool Agent::trainModel(const std::string& trainingDataPath) {
-    Logger::getInstance().info("Training model with data from: " + trainingDataPath);
+    LOG_INFO("Training model with data from: ", trainingDataPath);
     
     Config& config = Config::getInstance();
     std::string modelPath = config.getModelPath();
@@ -139,6 +417,100 @@ bool Agent::trainModel(const std::string& trainingDataPath) {
     return nlProcessor_->trainModel(trainingDataPath, modelPath);
 }
 
+std::string Agent::getStatistics() const {
+    std::ostringstream oss;
+    
+    auto nl = nlProcessor_->getCacheStats();
+    oss << "NL cache: hits=" << nl.hits
+        << " misses=" << nl.misses
+        << " evictions=" << nl.evictions
+        << " entries=" << nl.entries
+        << " bytes=" << nl.bytes << "/" << nl.byteBudget << "\n";
+    
+    auto semantic = nlProcessor_->getSemanticCacheStats();
+    oss << "Semantic cache: hits=" << semantic.hits
+        << " misses=" << semantic.misses
+        << " entries=" << semantic.entries
+        << " lists=" << semantic.lists << "\n";
+    
+    auto results = dbConnector_->getResultCacheStats();
+    oss << "Result cache: hits=" << results.hits
+        << " misses=" << results.misses
+        << " evictions=" << results.evictions
+        << " expirations=" << results.expirations
+        << " invalidations=" << results.invalidations
+        << " entries=" << results.entries
+        << " bytes=" << results.bytes << "/" << results.byteBudget
+        << " listening=" << (results.listening ? "yes" : "no") << "\n";
+    
+    auto pool = dbConnector_->getPoolStats();
+    oss << "Connection pool: size=" << pool.size << "/" << pool.maxSize
+        << " idle=" << pool.idle
+        << " in_use=" << pool.inUse
+        << " peak=" << pool.peakInUse
+        << " acquisitions=" << pool.acquisitions
+        << " timeouts=" << pool.timeouts
+        << " connect_failures=" << pool.connectFailures
+        << " reconnects=" << pool.reconnects
+        << " dropped=" << pool.dropped
+        << " reaped=" << pool.reaped
+        << " wait_ms(avg/max)=" << pool.avgWaitMs << "/" << pool.maxWaitMs
+        << " utilisation=" << (pool.utilisation * 100.0) << "%\n";
+    
+    auto statements = dbConnector_->getStatementStats();
+    oss << "Prepared statements: reused=" << statements.cached
+        << " prepared=" << statements.prepared
+        << " unpreparable=" << statements.failed
+        << " unparsed=" << statements.unparsed
+        << " fallback=" << statements.fallbacks << "\n";
+    
+    auto log = Logger::getInstance().getStats();
+    oss << "Logger: written=" << log.written
+        << " dropped=" << log.dropped
+        << " queued=" << log.queued << "\n";
+    
+    auto schema = dbConnector_->getSchemaStats();
+    oss << "Schema catalog: version=" << schema.version
+        << " tables=" << schema.tables
+        << " full_loads=" << schema.fullLoads
+        << " checks=" << schema.checks
+        << " tables_reloaded=" << schema.tablesReloaded
+        << " last_load_ms=" << schema.lastLoadMs << "\n";
+    
+    auto async = dbConnector_->getAsyncStats();
+    oss << "Async executor: submitted=" << async.submitted
+        << " completed=" << async.completed
+        << " failed=" << async.failed
+        << " queued=" << async.queued
+        << " in_flight=" << async.inFlight
+        << " peak_in_flight=" << async.peakInFlight
+        << " connections=" << async.connections
+        << " pipelined=" << (async.pipelined ? "yes" : "no") << "\n";
+    
+    auto replicas = dbConnector_->getReplicaStats();
+    if (!replicas.nodes.empty()) {
+        oss << "Read replicas: replica_reads=" << replicas.replicaReads
+            << " primary_fallbacks=" << replicas.primaryFallbacks
+            << " write_retries=" << replicas.writeRetries << "\n";
+        for (const auto& node : replicas.nodes) {
+            oss << "  " << node.name << ": healthy=" << (node.healthy ? "yes" : "no")
+                << " lag_ms=" << node.lagMs
+                << " outstanding=" << node.outstanding
+                << " routed=" << node.routed
+                << " failures=" << node.failures
+                << " latency_ms(avg/max)=" << node.avgLatencyMs << "/" << node.maxLatencyMs << "\n";
+        }
+    }
+    
+    auto timeouts = dbConnector_->getTimeoutStats();
+    oss << "Query limits: statement_timeouts=" << timeouts.statementTimeouts
+        << " watchdog_cancels=" << timeouts.watchdogCancels
+        << " stream_cancels=" << timeouts.streamCancels
+        << " limits_injected=" << limitsInjected_ << "\n";
+    
+    return oss.str();
+}
+
 void Agent::setOutputFormat(ResponseParser::OutputFormat format) {
     outputFormat_ = format;
 }
\ No newline at end of file
@@ -22,10 +22,26 @@ public:
     
     std::string processNaturalLanguageQuery(const std::string& query);
     std::string executeSQL(const std::string& sqlQuery);
+    // То же с выводом в приёмник по мере чтения результата; ошибка
+    // записывается в out как "Error: ..."
+    bool executeSQL(const std::string& sqlQuery, OutputSink& out);
+    // Выполнить уже проверенный запрос (sqlQuery из generateSQL) с выводом в out
+    bool writeResult(const std::string& sql, OutputSink& out);
+    // Таблицы из каталога схемы (команда tables)
+    std::string listTables();
     
     bool trainModel(const std::string& trainingDataPath);
     
     void setOutputFormat(ResponseParser::OutputFormat format);
+    ResponseParser::OutputFormat getOutputFormat() const { return outputFormat_; }
+    // Писать результаты в файл (перезаписывается каждым запросом) вместо
+    // приёмника; в приёмник идёт только итог или ошибка. Пустой путь - снова в приёмник
+    void setOutputFile(const std::string& path) { outputFile_ = path; }
+    const std::string& getOutputFile() const { return outputFile_; }
+    bool isConnected() const { return dbConnector_->isConnected(); }
+    
+    // Счётчики кэшей и подсистем в текстовом виде (команда stats)
+    std::string getStatistics() const;
 
     // Разрешить оффлайн-генерацию SQL без подключения к БД.
     // Если включено, метод processQueryDetailed() будет генерировать SQL и возвращать
@@ -41,6 +57,8 @@ public:
     };
     
     QueryResponse processQueryDetailed(const std::string& naturalLanguageQuery);
+    // Только генерация и проверка SQL, без выполнения (result пуст)
+    QueryResponse generateSQL(const std::string& naturalLanguageQuery);
 
 private:
     std::unique_ptr<DatabaseConnector> dbConnector_;
@@ -51,7 +69,21 @@ private:
     ResponseParser::OutputFormat outputFormat_;
     
     bool initialized_;
+    
+    // Передать актуальную схему БД в NL процессор
+    void refreshSchema();
+    // Выполнить запрос потоково (не больше max_result_rows строк) и
+    // форматировать пачки в out; CSV одиночного SELECT выгружается через COPY
+    bool streamResult(const std::string& sql, OutputSink& out, std::string& error);
+    bool writeResultToFile(const std::string& sql, OutputSink& out);
+    
+    DatabaseConnector::StreamOptions streamOptions_;
+    uint64_t schemaVersion_ = 0;  // версия каталога, переданная в NL процессор
+    size_t maxQueryLength_ = 1000;   // 0 - без ограничения
+    size_t generatedRowLimit_ = 1000;  // LIMIT для сгенерированных SELECT; 0 - без ограничения
+    uint64_t limitsInjected_ = 0;
     bool allowOfflineSQL_ = false;
+    std::string outputFile_;
 };
 
 #endif // AGENT_H
\ No newline at end of file
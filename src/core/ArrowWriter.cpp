@@ -0,0 +1,495 @@
+#include "src/core/ArrowWriter.h"
+#include "src/core/PgValue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    using Result = DatabaseConnector::QueryResult;
+
+    // Message.fbs / Schema.fbs формата Arrow
+    constexpr int16_t kMetadataV5 = 4;
+    constexpr uint8_t kHeaderSchema = 1;
+    constexpr uint8_t kHeaderRecordBatch = 3;
+    constexpr uint8_t kTypeInt = 2;
+    constexpr uint8_t kTypeFloatingPoint = 3;
+    constexpr uint8_t kTypeUtf8 = 5;
+    constexpr uint8_t kTypeBool = 6;
+    constexpr uint8_t kTypeDate = 8;
+    constexpr uint8_t kTypeTimestamp = 10;
+    constexpr int16_t kPrecisionSingle = 1;
+    constexpr int16_t kPrecisionDouble = 2;
+    constexpr int16_t kDateUnitDay = 0;
+    constexpr int16_t kTimeUnitMicrosecond = 2;
+
+    constexpr uint32_t kContinuation = 0xFFFFFFFFu;
+
+    // Эпоха PostgreSQL (2000-01-01) относительно эпохи Unix
+    constexpr int32_t kPgEpochDays = 10957;
+    constexpr int64_t kPgEpochMicros = 946684800LL * 1000000;
+
+    size_t align8(size_t size) {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    // Построение FlatBuffers от начала к концу: дочерние объекты ставятся
+    // после родителя, смещения на них (uoffset, всегда вперёд) дописываются
+    // в зарезервированные места через link. Таблица выровнена на 8 байт,
+    // её поля разложены по убыванию размера - каждое выровнено по размеру.
+    class FlatBuilder {
+    public:
+        struct Table {
+            struct Field {
+                uint16_t id;
+                uint8_t size;
+                uint64_t value;
+                bool offset;
+            };
+            std::vector<Field> fields;
+
+            Table& scalar(uint16_t id, uint64_t value, uint8_t size) {
+                fields.push_back({id, size, value, false});
+                return *this;
+            }
+            Table& offset(uint16_t id) {
+                fields.push_back({id, 4, 0, true});
+                return *this;
+            }
+        };
+
+        // Места смещений поставленной таблицы по номерам полей
+        struct Placed {
+            size_t pos = 0;
+            size_t slots[8] = {};
+        };
+
+        FlatBuilder() {
+            buf_.assign(4, '\0');  // смещение корневой таблицы
+        }
+
+        Placed place(const Table& table) {
+            std::vector<Table::Field> fields = table.fields;
+            std::stable_sort(fields.begin(), fields.end(),
+                             [](const Table::Field& a, const Table::Field& b) { return a.size > b.size; });
+
+            uint16_t maxId = 0;
+            for (const auto& f : fields) maxId = std::max<uint16_t>(maxId, static_cast<uint16_t>(f.id + 1));
+            std::vector<uint16_t> layout(maxId, 0);
+            size_t tableSize = 4;  // soffset на vtable
+            for (const auto& f : fields) {
+                tableSize = (tableSize + f.size - 1) / f.size * f.size;
+                layout[f.id] = static_cast<uint16_t>(tableSize);
+                tableSize += f.size;
+            }
+
+            pad(2);
+            size_t vtable = buf_.size();
+            put16(static_cast<uint16_t>(4 + 2 * maxId));
+            put16(static_cast<uint16_t>(tableSize));
+            for (uint16_t at : layout) put16(at);
+
+            pad(8);
+            Placed placed;
+            placed.pos = buf_.size();
+            buf_.resize(placed.pos + tableSize, '\0');
+            store(placed.pos, static_cast<uint64_t>(placed.pos - vtable), 4);
+            for (const auto& f : fields) {
+                size_t at = placed.pos + layout[f.id];
+                if (f.offset) {
+                    placed.slots[f.id] = at;
+                } else {
+                    store(at, f.value, f.size);
+                }
+            }
+            return placed;
+        }
+
+        size_t string(std::string_view text) {
+            pad(4);
+            size_t pos = buf_.size();
+            put32(static_cast<uint32_t>(text.size()));
+            buf_.append(text.data(), text.size());
+            buf_.push_back('\0');
+            return pos;
+        }
+
+        // Вектор смещений; место i-го элемента - pos + 4 + 4 * i
+        size_t offsetVector(size_t count) {
+            pad(4);
+            size_t pos = buf_.size();
+            put32(static_cast<uint32_t>(count));
+            buf_.resize(buf_.size() + 4 * count, '\0');
+            return pos;
+        }
+
+        // Вектор структур из пар int64 (FieldNode, Buffer): элементы по 8 байт
+        size_t pairVector(const std::vector<int64_t>& values) {
+            while ((buf_.size() + 4) % 8 != 0) buf_.push_back('\0');
+            size_t pos = buf_.size();
+            put32(static_cast<uint32_t>(values.size() / 2));
+            for (int64_t v : values) {
+                size_t at = buf_.size();
+                buf_.resize(at + 8);
+                store(at, static_cast<uint64_t>(v), 8);
+            }
+            return pos;
+        }
+
+        void link(size_t slot, size_t target) {
+            store(slot, static_cast<uint64_t>(target - slot), 4);
+        }
+
+        std::string finish(size_t root) {
+            link(0, root);
+            return std::move(buf_);
+        }
+
+    private:
+        void pad(size_t alignment) {
+            while (buf_.size() % alignment != 0) buf_.push_back('\0');
+        }
+        void put16(uint16_t v) {
+            buf_.push_back(static_cast<char>(v & 0xFF));
+            buf_.push_back(static_cast<char>(v >> 8));
+        }
+        void put32(uint32_t v) {
+            size_t at = buf_.size();
+            buf_.resize(at + 4);
+            store(at, v, 4);
+        }
+        // Little-endian, как требует формат
+        void store(size_t at, uint64_t value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                buf_[at + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+            }
+        }
+
+        std::string buf_;
+    };
+
+    FlatBuilder::Placed placeMessage(FlatBuilder& fb, uint8_t headerType, size_t bodyLength) {
+        FlatBuilder::Table table;
+        table.scalar(0, static_cast<uint16_t>(kMetadataV5), 2)
+             .scalar(1, headerType, 1)
+             .offset(2)
+             .scalar(3, bodyLength, 8);
+        return fb.place(table);
+    }
+
+    // Номер типа в union Type
+    uint8_t unionTypeOf(ArrowWriter::Type type) {
+        switch (type) {
+            case ArrowWriter::Type::Bool: return kTypeBool;
+            case ArrowWriter::Type::Int16:
+            case ArrowWriter::Type::Int32:
+            case ArrowWriter::Type::Int64: return kTypeInt;
+            case ArrowWriter::Type::Float32:
+            case ArrowWriter::Type::Float64: return kTypeFloatingPoint;
+            case ArrowWriter::Type::Date32: return kTypeDate;
+            case ArrowWriter::Type::TimestampUs: return kTypeTimestamp;
+            case ArrowWriter::Type::Utf8:
+            default: return kTypeUtf8;
+        }
+    }
+
+    // Таблица параметров типа (Int, FloatingPoint, Date, Timestamp; у Utf8
+    // и Bool параметров нет)
+    size_t placeType(FlatBuilder& fb, ArrowWriter::Type type) {
+        FlatBuilder::Table table;
+        switch (type) {
+            case ArrowWriter::Type::Int16:
+                table.scalar(0, 16, 4).scalar(1, 1, 1);
+                break;
+            case ArrowWriter::Type::Int32:
+                table.scalar(0, 32, 4).scalar(1, 1, 1);
+                break;
+            case ArrowWriter::Type::Int64:
+                table.scalar(0, 64, 4).scalar(1, 1, 1);
+                break;
+            case ArrowWriter::Type::Float32:
+                table.scalar(0, static_cast<uint16_t>(kPrecisionSingle), 2);
+                break;
+            case ArrowWriter::Type::Float64:
+                table.scalar(0, static_cast<uint16_t>(kPrecisionDouble), 2);
+                break;
+            case ArrowWriter::Type::Date32:
+                table.scalar(0, static_cast<uint16_t>(kDateUnitDay), 2);
+                break;
+            case ArrowWriter::Type::TimestampUs:
+                table.scalar(0, static_cast<uint16_t>(kTimeUnitMicrosecond), 2);
+                break;
+            default:
+                break;
+        }
+        return fb.place(table).pos;
+    }
+
+    size_t valueWidth(ArrowWriter::Type type) {
+        switch (type) {
+            case ArrowWriter::Type::Int16: return 2;
+            case ArrowWriter::Type::Int32:
+            case ArrowWriter::Type::Float32:
+            case ArrowWriter::Type::Date32: return 4;
+            case ArrowWriter::Type::Int64:
+            case ArrowWriter::Type::Float64:
+            case ArrowWriter::Type::TimestampUs: return 8;
+            default: return 0;
+        }
+    }
+
+    template <typename T>
+    T loadNative(std::string_view value) {
+        T out;
+        std::memcpy(&out, value.data(), sizeof(out));
+        return out;
+    }
+
+    template <typename T>
+    void storeValue(std::vector<char>& values, size_t row, T value) {
+        std::memcpy(values.data() + row * sizeof(T), &value, sizeof(T));
+    }
+
+    bool parseFloat(Oid type, bool native, std::string_view value, double& out) {
+        if (native) {
+            out = type == PgValue::kFloat4 ? loadNative<float>(value) : loadNative<double>(value);
+            return true;
+        }
+        if (PgValue::toDouble(type, native, value, out)) return true;
+        if (value == "NaN") out = std::numeric_limits<double>::quiet_NaN();
+        else if (value == "Infinity") out = std::numeric_limits<double>::infinity();
+        else if (value == "-Infinity") out = -std::numeric_limits<double>::infinity();
+        else return false;
+        return true;
+    }
+}
+
+ArrowWriter::ArrowWriter(OutputSink& out) : out_(out) {}
+
+ArrowWriter::Type ArrowWriter::typeOf(Oid type, bool native) {
+    switch (type) {
+        case PgValue::kBool: return Type::Bool;
+        case PgValue::kInt2: return Type::Int16;
+        case PgValue::kInt4: return Type::Int32;
+        case PgValue::kInt8: return Type::Int64;
+        case PgValue::kFloat4: return Type::Float32;
+        case PgValue::kFloat8: return Type::Float64;
+        case PgValue::kDate: return native ? Type::Date32 : Type::Utf8;
+        case PgValue::kTimestamp: return native ? Type::TimestampUs : Type::Utf8;
+        default: return Type::Utf8;
+    }
+}
+
+void ArrowWriter::writeMessage(const std::string& metadata, const std::vector<Buffer>& body, size_t bodyLength) {
+    // Префикс и метаданные вместе кратны 8: тело начинается выровненным
+    uint32_t header[2] = {kContinuation, static_cast<uint32_t>(align8(metadata.size() + 8) - 8)};
+    out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out_.write(metadata);
+    out_.fill('\0', header[1] - metadata.size());
+
+    size_t written = 0;
+    for (const auto& buffer : body) {
+        out_.write(buffer.data, buffer.size);
+        out_.fill('\0', align8(buffer.size) - buffer.size);
+        written += align8(buffer.size);
+    }
+    out_.fill('\0', bodyLength - written);
+}
+
+void ArrowWriter::writeSchema(const Result& batch) {
+    const size_t columns = std::min(batch.columns.size(), batch.data.size());
+    types_.resize(columns);
+    for (size_t i = 0; i < columns; ++i) {
+        types_[i] = typeOf(batch.data[i].type(), batch.data[i].native());
+    }
+    validityScratch_.resize(columns);
+    valueScratch_.resize(columns);
+
+    FlatBuilder fb;
+    auto msg = placeMessage(fb, kHeaderSchema, 0);
+    FlatBuilder::Table schema;
+    schema.scalar(0, 0, 2).offset(1);  // endianness = Little
+    auto placedSchema = fb.place(schema);
+    fb.link(msg.slots[2], placedSchema.pos);
+    size_t fields = fb.offsetVector(columns);
+    fb.link(placedSchema.slots[1], fields);
+
+    for (size_t i = 0; i < columns; ++i) {
+        FlatBuilder::Table field;
+        field.offset(0).scalar(1, 1, 1).scalar(2, unionTypeOf(types_[i]), 1).offset(3).offset(5);
+        auto placedField = fb.place(field);
+        fb.link(fields + 4 + 4 * i, placedField.pos);
+        fb.link(placedField.slots[0], fb.string(batch.columns[i]));
+        fb.link(placedField.slots[3], placeType(fb, types_[i]));
+        fb.link(placedField.slots[5], fb.offsetVector(0));  // children обязателен
+    }
+
+    writeMessage(fb.finish(msg.pos), {}, 0);
+    started_ = true;
+}
+
+void ArrowWriter::prepare(const Result::Column& column, Type type, size_t rows, Prepared& prepared,
+                          std::vector<char>& validity, std::vector<char>& values) {
+    const size_t validityBytes = (rows + 7) / 8;
+    const bool native = column.native();
+    const Oid pgType = column.type();
+
+    // Маска NULL колонки (1 - NULL) -> битовая карта Arrow (1 - значение)
+    auto invertNulls = [&]() {
+        validity.resize(validityBytes);
+        const auto& nulls = column.nullBitmap();
+        for (size_t b = 0; b < validityBytes; ++b) {
+            validity[b] = static_cast<char>(~(nulls[b / 8] >> (8 * (b % 8))) & 0xFF);
+        }
+        if (rows % 8 != 0) validity[validityBytes - 1] &= static_cast<char>((1u << (rows % 8)) - 1);
+    };
+    auto markNull = [&](size_t row) {
+        validity[row / 8] &= static_cast<char>(~(1u << (row % 8)));
+        prepared.nullCount++;
+    };
+
+    prepared = Prepared();
+    if (column.hasNulls()) {
+        for (size_t r = 0; r < rows; ++r) {
+            if (column.isNull(r)) prepared.nullCount++;
+        }
+    }
+    invertNulls();
+
+    if (type == Type::Utf8) {
+        if (native && pgType != PgValue::kNumeric) {
+            // Машинное значение без типа Arrow - текстом сервера
+            std::vector<int32_t> offsets(rows + 1, 0);
+            values.clear();
+            std::string text;
+            for (size_t r = 0; r < rows; ++r) {
+                if (!column.isNull(r)) {
+                    text = column.text(r);
+                    values.insert(values.end(), text.begin(), text.end());
+                }
+                offsets[r + 1] = static_cast<int32_t>(values.size());
+            }
+            size_t dataSize = values.size();
+            values.resize(dataSize + offsets.size() * sizeof(int32_t));
+            std::memcpy(values.data() + dataSize, offsets.data(), offsets.size() * sizeof(int32_t));
+            prepared.bytes = {values.data(), dataSize};
+            prepared.values = {values.data() + dataSize, offsets.size() * sizeof(int32_t)};
+        } else {
+            // Смещения и байты колонки совпадают с раскладкой Utf8
+            prepared.values = {reinterpret_cast<const char*>(column.offsets().data()), (rows + 1) * sizeof(uint32_t)};
+            prepared.bytes = {column.arena().data(), column.offsets()[rows]};
+        }
+    } else if (type == Type::Bool) {
+        values.assign(validityBytes, '\0');
+        for (size_t r = 0; r < rows; ++r) {
+            bool value;
+            if (column.isNull(r)) continue;
+            if (!PgValue::toBool(native, column.value(r), value)) {
+                markNull(r);
+            } else if (value) {
+                values[r / 8] |= static_cast<char>(1u << (r % 8));
+            }
+        }
+        prepared.values = {values.data(), validityBytes};
+    } else {
+        const size_t width = valueWidth(type);
+        if (native && prepared.nullCount == 0 && type != Type::Date32 && type != Type::TimestampUs) {
+            // Без NULL машинные значения лежат в arena подряд - как в Arrow
+            prepared.values = {column.arena().data(), rows * width};
+        } else {
+            values.assign(rows * width, '\0');
+            for (size_t r = 0; r < rows; ++r) {
+                if (column.isNull(r)) continue;
+                std::string_view value = column.value(r);
+                int64_t integer = 0;
+                double real = 0.0;
+                switch (type) {
+                    case Type::Int16:
+                    case Type::Int32:
+                    case Type::Int64:
+                        if (!PgValue::toInt64(pgType, native, value, integer)) {
+                            markNull(r);
+                        } else if (type == Type::Int16) {
+                            storeValue(values, r, static_cast<int16_t>(integer));
+                        } else if (type == Type::Int32) {
+                            storeValue(values, r, static_cast<int32_t>(integer));
+                        } else {
+                            storeValue(values, r, integer);
+                        }
+                        break;
+                    case Type::Float32:
+                    case Type::Float64:
+                        if (!parseFloat(pgType, native, value, real)) {
+                            markNull(r);
+                        } else if (type == Type::Float32) {
+                            storeValue(values, r, static_cast<float>(real));
+                        } else {
+                            storeValue(values, r, real);
+                        }
+                        break;
+                    case Type::Date32:
+                        storeValue(values, r, loadNative<int32_t>(value) + kPgEpochDays);
+                        break;
+                    case Type::TimestampUs:
+                        storeValue(values, r, loadNative<int64_t>(value) + kPgEpochMicros);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            prepared.values = {values.data(), values.size()};
+        }
+    }
+
+    if (prepared.nullCount > 0) {
+        prepared.validity = {validity.data(), validityBytes};
+    }
+}
+
+void ArrowWriter::write(const Result& batch) {
+    if (!started_) writeSchema(batch);
+
+    const size_t rows = static_cast<size_t>(batch.rowCount);
+    if (rows == 0) return;
+    const size_t columns = std::min(types_.size(), batch.data.size());
+
+    std::vector<Prepared> prepared(columns);
+    std::vector<Buffer> body;
+    std::vector<int64_t> nodes;
+    std::vector<int64_t> buffers;
+    size_t bodyLength = 0;
+    auto addBuffer = [&](const Buffer& buffer) {
+        body.push_back(buffer);
+        buffers.push_back(static_cast<int64_t>(bodyLength));
+        buffers.push_back(static_cast<int64_t>(buffer.size));
+        bodyLength += align8(buffer.size);
+    };
+
+    for (size_t i = 0; i < columns; ++i) {
+        prepare(batch.data[i], types_[i], rows, prepared[i], validityScratch_[i], valueScratch_[i]);
+        nodes.push_back(static_cast<int64_t>(rows));
+        nodes.push_back(static_cast<int64_t>(prepared[i].nullCount));
+        addBuffer(prepared[i].validity);
+        addBuffer(prepared[i].values);
+        if (types_[i] == Type::Utf8) addBuffer(prepared[i].bytes);
+    }
+
+    FlatBuilder fb;
+    auto msg = placeMessage(fb, kHeaderRecordBatch, bodyLength);
+    FlatBuilder::Table recordBatch;
+    recordBatch.scalar(0, rows, 8).offset(1).offset(2);
+    auto placedBatch = fb.place(recordBatch);
+    fb.link(msg.slots[2], placedBatch.pos);
+    fb.link(placedBatch.slots[1], fb.pairVector(nodes));
+    fb.link(placedBatch.slots[2], fb.pairVector(buffers));
+
+    writeMessage(fb.finish(msg.pos), body, bodyLength);
+}
+
+void ArrowWriter::finish(size_t, bool) {
+    if (!started_) writeSchema(Result());
+
+    // Конец потока: продолжение с нулевой длиной метаданных
+    uint32_t end[2] = {kContinuation, 0};
+    out_.write(reinterpret_cast<const char*>(end), sizeof(end));
+}
@@ -0,0 +1,57 @@
+#ifndef ARROW_WRITER_H
+#define ARROW_WRITER_H
+
+#include "src/core/ResponseParser.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Вывод результата в формате Arrow IPC stream (читается pyarrow.ipc,
+// pandas через pyarrow, DuckDB, Polars): схема, затем пачка потокового
+// чтения - одно сообщение RecordBatch, в конце маркер конца потока.
+// Типизированные колонки передаются машинными значениями без перевода в
+// текст: int2/int4/int8, float4/float8, bool, date (дни от 1970-01-01),
+// timestamp (микросекунды от 1970-01-01, без часового пояса). Остальные
+// типы (в том числе numeric) - Utf8; смещения и байты текстовой колонки
+// QueryResult уходят в вывод как есть (32-битные смещения Arrow, поэтому
+// данные одной колонки в пачке должны быть меньше 2 ГБ - пачки потокового
+// чтения ограничены stream_batch_bytes). Метаданные FlatBuffers строятся
+// здесь же, без внешних библиотек.
+class ArrowWriter : public ResultWriter {
+public:
+    explicit ArrowWriter(OutputSink& out);
+
+    void write(const DatabaseConnector::QueryResult& batch) override;
+    void finish(size_t rowCount, bool truncated) override;
+
+    enum class Type : uint8_t { Utf8, Bool, Int16, Int32, Int64, Float32, Float64, Date32, TimestampUs };
+    // Тип Arrow для колонки PostgreSQL (date и timestamp - только машинные)
+    static Type typeOf(Oid type, bool native);
+
+private:
+    // Буфер тела сообщения: указатель на данные колонки или на scratch
+    struct Buffer {
+        const char* data = nullptr;
+        size_t size = 0;
+    };
+    struct Prepared {
+        size_t nullCount = 0;
+        Buffer validity;
+        Buffer values;
+        Buffer bytes;  // только Utf8
+    };
+
+    void writeSchema(const DatabaseConnector::QueryResult& batch);
+    void prepare(const DatabaseConnector::QueryResult::Column& column, Type type, size_t rows,
+                 Prepared& prepared, std::vector<char>& validity, std::vector<char>& values);
+    void writeMessage(const std::string& metadata, const std::vector<Buffer>& body, size_t bodyLength);
+
+    OutputSink& out_;
+    bool started_ = false;
+    std::vector<Type> types_;
+    // Переиспользуемые между пачками буферы преобразованных значений
+    std::vector<std::vector<char>> validityScratch_;
+    std::vector<std::vector<char>> valueScratch_;
+};
+
+#endif // ARROW_WRITER_H
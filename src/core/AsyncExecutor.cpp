@@ -0,0 +1,386 @@
+#include "src/core/AsyncExecutor.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int kPollTimeoutMs = 250;
+    // Такт повторной попытки взять соединение, когда очередь ждёт пул
+    constexpr int kAcquireRetryMs = 10;
+
+#ifdef LIBPQ_HAS_PIPELINING
+    constexpr bool kPipelined = true;
+#else
+    constexpr bool kPipelined = false;
+#endif
+}
+
+AsyncExecutor::AsyncExecutor(ConnectionPool& pool, Options options)
+    : pool_(pool), options_(options) {
+    options_.connections = std::max<size_t>(options_.connections, 1);
+    options_.pipelineDepth = kPipelined ? std::max<size_t>(options_.pipelineDepth, 1) : 1;
+    counters_.pipelined = kPipelined;
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    stop();
+}
+
+bool AsyncExecutor::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return true;
+
+    if (pipe(wakePipe_) != 0) {
+        LOG_ERROR("Async executor: cannot create wake pipe");
+        return false;
+    }
+    for (int fd : wakePipe_) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    running_ = true;
+    thread_ = std::thread(&AsyncExecutor::run, this);
+    LOG_INFO("Async executor started: ", options_.connections,
+             " connections, pipeline depth ", options_.pipelineDepth);
+    return true;
+}
+
+void AsyncExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (int& fd : wakePipe_) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void AsyncExecutor::submit(std::string sql, std::vector<std::string> params, Callback callback) {
+    Pending pending;
+    pending.sql = std::move(sql);
+    pending.params = std::move(params);
+    pending.callback = std::move(callback);
+    pending.queuedAt = std::chrono::steady_clock::now();
+
+    bool accepted = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            counters_.submitted++;
+            queue_.push_back(std::move(pending));
+            counters_.queued = queue_.size();
+            accepted = true;
+            // Под блокировкой: stop() не закроет канал между проверкой и записью
+            wake();
+        }
+    }
+
+    if (!accepted) {
+        pending.result.errorMessage = "Async executor is not running";
+        if (pending.callback) pending.callback(std::move(pending.result));
+    }
+}
+
+std::future<QueryResult> AsyncExecutor::submit(std::string sql, std::vector<std::string> params) {
+    auto promise = std::make_shared<std::promise<QueryResult>>();
+    auto future = promise->get_future();
+    submit(std::move(sql), std::move(params), [promise](QueryResult result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+AsyncExecutor::Stats AsyncExecutor::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+}
+
+void AsyncExecutor::wake() {
+    if (wakePipe_[1] >= 0) {
+        char byte = 1;
+        // Переполненный канал тоже разбудит цикл - ошибку можно игнорировать
+        (void)!write(wakePipe_[1], &byte, 1);
+    }
+}
+
+bool AsyncExecutor::attach(Slot& slot) {
+    PGconn* raw = slot.lease->raw();
+    if (PQsetnonblocking(raw, 1) != 0) {
+        return false;
+    }
+#ifdef LIBPQ_HAS_PIPELINING
+    if (PQenterPipelineMode(raw) != 1) {
+        PQsetnonblocking(raw, 0);
+        return false;
+    }
+#endif
+    slot.lastActive = std::chrono::steady_clock::now();
+    return true;
+}
+
+void AsyncExecutor::detach(Slot& slot, bool dirty) {
+    if (!slot.lease) return;
+    PGconn* raw = slot.lease->raw();
+    if (dirty || !slot.inFlight.empty() || slot.needFlush) {
+        // Ответы не дочитаны: соединение в неизвестном состоянии
+        slot.lease->reset();
+    }
+#ifdef LIBPQ_HAS_PIPELINING
+    PQexitPipelineMode(raw);
+#endif
+    PQsetnonblocking(raw, 0);
+    slot.lease.release();
+}
+
+bool AsyncExecutor::dispatch() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!queue_.empty()) {
+        Slot* target = nullptr;
+        for (auto& slot : slots_) {
+            if (slot.inFlight.size() < options_.pipelineDepth &&
+                (!target || slot.inFlight.size() < target->inFlight.size())) {
+                target = &slot;
+            }
+        }
+
+        if (!target && slots_.size() < options_.connections) {
+            // Только свободное или новое соединение: ожидая пул, цикл не
+            // читал бы ответы, не вызывал колбэки и не видел stop()
+            lock.unlock();
+            Slot slot;
+            slot.lease = pool_.acquire(std::chrono::milliseconds(0));
+            bool attached = slot.lease && attach(slot);
+            lock.lock();
+            if (attached) {
+                slots_.push_back(std::move(slot));
+                counters_.connections = slots_.size();
+                continue;
+            }
+            if (slots_.empty()) {
+                // Запросы остаются в очереди до следующего такта; ошибку
+                // получают только прождавшие дольше acquireTimeout пула
+                auto deadline = std::chrono::steady_clock::now() - pool_.options().acquireTimeout;
+                std::deque<Pending> expired;
+                while (!queue_.empty() && queue_.front().queuedAt <= deadline) {
+                    expired.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                counters_.queued = queue_.size();
+                bool waiting = !queue_.empty();
+                lock.unlock();
+                fail(expired, "No database connection available: " + pool_.lastError(), false);
+                return waiting;
+            }
+        }
+        if (!target) break;
+
+        Pending pending = std::move(queue_.front());
+        queue_.pop_front();
+        counters_.queued = queue_.size();
+        lock.unlock();
+
+        if (send(*target, pending)) {
+            lock.lock();
+            counters_.inFlight++;
+            counters_.peakInFlight = std::max(counters_.peakInFlight, counters_.inFlight);
+        } else {
+            complete(pending, false);
+            lock.lock();
+        }
+    }
+    return false;
+}
+
+bool AsyncExecutor::send(Slot& slot, Pending& pending) {
+    PGconn* raw = slot.lease->raw();
+
+    std::vector<const char*> values;
+    values.reserve(pending.params.size());
+    for (const auto& p : pending.params) values.push_back(p.c_str());
+
+    int sent = PQsendQueryParams(raw, pending.sql.c_str(), static_cast<int>(values.size()),
+                                 nullptr, values.data(), nullptr, nullptr, 0);
+#ifdef LIBPQ_HAS_PIPELINING
+    // Точка синхронизации на каждый запрос: своя неявная транзакция
+    if (sent) sent = PQpipelineSync(raw);
+#endif
+    if (!sent) {
+        pending.result.errorMessage = PQerrorMessage(raw);
+        return false;
+    }
+
+    slot.needFlush = PQflush(raw) == 1;
+    slot.lastActive = std::chrono::steady_clock::now();
+    slot.inFlight.push_back(std::move(pending));
+    return true;
+}
+
+bool AsyncExecutor::receive(Slot& slot) {
+    PGconn* raw = slot.lease->raw();
+    if (!PQconsumeInput(raw) || PQstatus(raw) != CONNECTION_OK) {
+        return false;
+    }
+
+    while (!slot.inFlight.empty() && !PQisBusy(raw)) {
+        Pending& front = slot.inFlight.front();
+        PGresult* r = PQgetResult(raw);
+        if (!r) {
+            // NULL завершает результаты запроса
+            if (!front.received || front.ended) break;
+            front.ended = true;
+            if (!kPipelined) {
+                complete(front, true);
+                slot.inFlight.pop_front();
+            }
+            continue;
+        }
+
+        PgResult res(r);
+        ExecStatusType status = PQresultStatus(r);
+#ifdef LIBPQ_HAS_PIPELINING
+        if (status == PGRES_PIPELINE_SYNC) {
+            complete(front, true);
+            slot.inFlight.pop_front();
+            continue;
+        }
+#endif
+        if (front.received) continue;
+        front.received = true;
+
+        if (status == PGRES_TUPLES_OK) {
+            front.result.setColumns(r);
+            front.result.appendRows(r);
+            front.result.success = true;
+        } else if (status == PGRES_COMMAND_OK) {
+            front.result.success = true;
+        } else {
+            front.result.errorMessage = PQresultErrorMessage(r);
+            if (front.result.errorMessage.empty()) {
+                front.result.errorMessage = "Query aborted";
+            }
+        }
+    }
+
+    slot.lastActive = std::chrono::steady_clock::now();
+    return true;
+}
+
+void AsyncExecutor::complete(Pending& pending, bool inFlight) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inFlight && counters_.inFlight > 0) {
+            counters_.inFlight--;
+        }
+        if (pending.result.success) {
+            counters_.completed++;
+        } else {
+            counters_.failed++;
+        }
+    }
+    if (pending.callback) {
+        pending.callback(std::move(pending.result));
+    }
+}
+
+void AsyncExecutor::fail(std::deque<Pending>& pending, const std::string& error, bool inFlight) {
+    for (auto& p : pending) {
+        p.result = QueryResult();
+        p.result.errorMessage = error;
+        complete(p, inFlight);
+    }
+    pending.clear();
+}
+
+void AsyncExecutor::run() {
+    std::vector<pollfd> fds;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) break;
+        }
+
+        bool waiting = dispatch();
+
+        fds.clear();
+        fds.push_back(pollfd{wakePipe_[0], POLLIN, 0});
+        for (auto& slot : slots_) {
+            short events = POLLIN;
+            if (slot.needFlush) events |= POLLOUT;
+            fds.push_back(pollfd{PQsocket(slot.lease->raw()), events, 0});
+        }
+
+        int rc = poll(fds.data(), fds.size(), waiting ? kAcquireRetryMs : kPollTimeoutMs);
+        if (rc < 0 && errno != EINTR) {
+            LOG_WARNING("Async executor: poll failed");
+        }
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(wakePipe_[0], buffer, sizeof(buffer)) > 0) {}
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < slots_.size();) {
+            Slot& slot = slots_[i];
+            bool alive = true;
+
+            if (slot.needFlush) {
+                int flushed = PQflush(slot.lease->raw());
+                slot.needFlush = flushed == 1;
+                alive = flushed >= 0;
+            }
+            // Ответ мог осесть в буфере libpq во время PQflush - читаем всегда
+            if (alive && !slot.inFlight.empty()) {
+                alive = receive(slot);
+            }
+
+            if (!alive) {
+                std::string error = PQerrorMessage(slot.lease->raw());
+                LOG_WARNING("Async executor: connection lost: ", error);
+                std::deque<Pending> lost;
+                lost.swap(slot.inFlight);
+                fail(lost, "Connection lost: " + error, true);
+                detach(slot, true);
+            } else if (slot.inFlight.empty() && now - slot.lastActive >= options_.idleRelease) {
+                detach(slot, false);
+            }
+
+            if (!slot.lease) {
+                slots_.erase(slots_.begin() + static_cast<long>(i));
+                std::lock_guard<std::mutex> lock(mutex_);
+                counters_.connections = slots_.size();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Остановка: незавершённые запросы получают ошибку, соединения - в пул
+    for (auto& slot : slots_) {
+        std::deque<Pending> unfinished;
+        unfinished.swap(slot.inFlight);
+        bool dirty = !unfinished.empty();
+        fail(unfinished, "Async executor stopped", true);
+        detach(slot, dirty);
+    }
+    slots_.clear();
+
+    std::deque<Pending> queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued.swap(queue_);
+        counters_.queued = 0;
+        counters_.inFlight = 0;
+        counters_.connections = 0;
+    }
+    fail(queued, "Async executor stopped", false);
+}
@@ -0,0 +1,110 @@
+#ifndef ASYNC_EXECUTOR_H
+#define ASYNC_EXECUTOR_H
+
+#include "src/core/ConnectionPool.h"
+#include "src/core/QueryResult.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Асинхронное выполнение запросов в режиме конвейера libpq (PG14+).
+// Фоновый цикл арендует у пула до connections соединений (только
+// свободные, без ожидания: цикл не должен останавливаться), переводит их в
+// неблокирующий режим и отправляет запросы из очереди, не дожидаясь ответа
+// на предыдущие: до pipelineDepth запросов на соединение. После каждого
+// запроса ставится точка синхронизации, поэтому запрос выполняется в своей
+// неявной транзакции без BEGIN/COMMIT, а его ошибка не задевает соседей.
+// Без поддержки конвейера в libpq на соединении выполняется один запрос.
+//
+// Колбэки вызываются из потока цикла и не должны блокироваться.
+class AsyncExecutor {
+public:
+    using Callback = std::function<void(QueryResult result)>;
+
+    struct Options {
+        size_t connections = 2;
+        size_t pipelineDepth = 64;  // запросов в полёте на соединение
+        std::chrono::milliseconds idleRelease{1000};  // вернуть соединения пулу после простоя
+    };
+
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        size_t queued = 0;
+        size_t inFlight = 0;
+        size_t peakInFlight = 0;
+        size_t connections = 0;  // арендовано сейчас
+        bool pipelined = false;
+    };
+
+    AsyncExecutor(ConnectionPool& pool, Options options);
+    ~AsyncExecutor();
+
+    bool start();
+    // Незавершённые запросы получают ошибку
+    void stop();
+
+    void submit(std::string sql, std::vector<std::string> params, Callback callback);
+    std::future<QueryResult> submit(std::string sql, std::vector<std::string> params = {});
+
+    Stats stats() const;
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+private:
+    struct Pending {
+        std::string sql;
+        std::vector<std::string> params;
+        Callback callback;
+        QueryResult result;
+        bool received = false;  // пришёл результат запроса
+        bool ended = false;     // за ним пришёл NULL - ждём точку синхронизации
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    struct Slot {
+        ConnectionPool::Lease lease;
+        std::deque<Pending> inFlight;
+        bool needFlush = false;
+        std::chrono::steady_clock::time_point lastActive;
+    };
+
+    void run();
+    void wake();
+    bool attach(Slot& slot);
+    // Вернуть соединение пулу; dirty - ответы не дочитаны, соединение сбрасывается
+    void detach(Slot& slot, bool dirty);
+    // Отправить запросы из очереди; true - соединений нет и запросы ждут
+    // следующего такта цикла
+    bool dispatch();
+    bool send(Slot& slot, Pending& pending);
+    // Забрать готовые результаты; false - соединение потеряно
+    bool receive(Slot& slot);
+    // inFlight - запрос был отправлен на сервер
+    void complete(Pending& pending, bool inFlight);
+    void fail(std::deque<Pending>& pending, const std::string& error, bool inFlight);
+
+    ConnectionPool& pool_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::deque<Pending> queue_;
+    bool running_ = false;
+    std::thread thread_;
+    int wakePipe_[2] = {-1, -1};
+
+    // Принадлежат потоку цикла
+    std::vector<Slot> slots_;
+
+    Stats counters_;
+};
+
+#endif // ASYNC_EXECUTOR_H
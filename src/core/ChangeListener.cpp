@@ -0,0 +1,141 @@
+#include "src/core/ChangeListener.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+
+namespace {
+    // Таблицы, на которых висит триггер notify_table_change()
+    const char* kWatchedTablesQuery =
+        "SELECT DISTINCT c.relname FROM pg_trigger t "
+        "JOIN pg_class c ON c.oid = t.tgrelid "
+        "JOIN pg_proc p ON p.oid = t.tgfoid "
+        "WHERE p.proname = 'notify_table_change' AND NOT t.tgisinternal";
+
+    constexpr int kPollTimeoutMs = 250;
+    constexpr int kMaxBackoffMs = 30000;
+}
+
+ChangeListener::ChangeListener(std::string connectionString, std::string channel, Callback onChange)
+    : connectionString_(std::move(connectionString)),
+      channel_(std::move(channel)),
+      onChange_(std::move(onChange)) {}
+
+ChangeListener::~ChangeListener() {
+    stop();
+}
+
+void ChangeListener::start() {
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&ChangeListener::run, this);
+}
+
+void ChangeListener::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stopCv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    closeConnection();
+}
+
+bool ChangeListener::isWatched(const std::string& table) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watched_.count(table) > 0;
+}
+
+bool ChangeListener::connect() {
+    conn_ = PQconnectdb(connectionString_.c_str());
+    if (PQstatus(conn_) != CONNECTION_OK) {
+        LOG_WARNING("Change listener connection failed: ",
+                    PQerrorMessage(conn_));
+        closeConnection();
+        return false;
+    }
+
+    std::set<std::string> watched;
+    PGresult* res = PQexec(conn_, kWatchedTablesQuery);
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+        for (int i = 0; i < PQntuples(res); ++i) {
+            watched.insert(PQgetvalue(res, i, 0));
+        }
+    }
+    PQclear(res);
+
+    char* channel = PQescapeIdentifier(conn_, channel_.c_str(), channel_.size());
+    std::string listen = "LISTEN " + std::string(channel ? channel : "");
+    PQfreemem(channel);
+    res = PQexec(conn_, listen.c_str());
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    if (!ok) {
+        LOG_WARNING("LISTEN failed: ", PQerrorMessage(conn_));
+        closeConnection();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        watched_ = std::move(watched);
+    }
+    listening_.store(true, std::memory_order_release);
+    LOG_INFO("Listening for table changes on channel '", channel_, "'");
+    return true;
+}
+
+void ChangeListener::closeConnection() {
+    listening_.store(false, std::memory_order_release);
+    if (conn_) {
+        PQfinish(conn_);
+        conn_ = nullptr;
+    }
+}
+
+void ChangeListener::waitBackoff(int milliseconds) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopCv_.wait_for(lock, std::chrono::milliseconds(milliseconds),
+                     [this] { return stopping_.load(); });
+}
+
+void ChangeListener::run() {
+    int backoffMs = 500;
+
+    while (!stopping_) {
+        if (!conn_) {
+            if (!connect()) {
+                waitBackoff(backoffMs);
+                backoffMs = std::min(backoffMs * 2, kMaxBackoffMs);
+                continue;
+            }
+            backoffMs = 500;
+            onChange_("");
+        }
+
+        pollfd pfd{PQsocket(conn_), POLLIN, 0};
+        int rc = poll(&pfd, 1, kPollTimeoutMs);
+        if (rc < 0 && errno != EINTR) {
+            closeConnection();
+            continue;
+        }
+        if (rc <= 0) continue;
+
+        if (!PQconsumeInput(conn_)) {
+            LOG_WARNING("Change listener connection lost: ",
+                        PQerrorMessage(conn_));
+            closeConnection();
+            continue;
+        }
+
+        while (PGnotify* notify = PQnotifies(conn_)) {
+            std::string table = notify->extra ? notify->extra : "";
+            PQfreemem(notify);
+            // Пустой payload - неизвестно, что изменилось: сбросить всё
+            onChange_(table);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CHANGE_LISTENER_H
+#define CHANGE_LISTENER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <libpq-fe.h>
+
+// Слушатель LISTEN/NOTIFY на выделенном соединении. Триггеры из
+// init_database.sql шлют в канал имя изменённой таблицы; колбэк вызывается
+// из фонового потока. После (пере)подключения колбэк получает пустую строку:
+// уведомления за время разрыва потеряны, и подписчик должен сбросить всё.
+class ChangeListener {
+public:
+    using Callback = std::function<void(const std::string& table)>;
+
+    ChangeListener(std::string connectionString, std::string channel, Callback onChange);
+    ~ChangeListener();
+
+    void start();
+    void stop();
+
+    // Соединение установлено и LISTEN выполнен
+    bool isListening() const { return listening_.load(std::memory_order_acquire); }
+    // Таблица оснащена триггером уведомлений
+    bool isWatched(const std::string& table) const;
+
+    ChangeListener(const ChangeListener&) = delete;
+    ChangeListener& operator=(const ChangeListener&) = delete;
+
+private:
+    void run();
+    bool connect();
+    void closeConnection();
+    void waitBackoff(int milliseconds);
+
+    std::string connectionString_;
+    std::string channel_;
+    Callback onChange_;
+
+    PGconn* conn_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> listening_{false};
+
+    mutable std::mutex mutex_;
+    std::condition_variable stopCv_;
+    std::set<std::string> watched_;
+};
+
+#endif // CHANGE_LISTENER_H
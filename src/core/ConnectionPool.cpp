@@ -0,0 +1,292 @@
+#include "src/core/ConnectionPool.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+
+namespace {
+    constexpr std::chrono::milliseconds kInitialBackoff{250};
+    constexpr std::chrono::milliseconds kMaintenanceTick{1000};
+
+    double toMs(ConnectionPool::Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Lease
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, std::unique_ptr<PgConnection> conn)
+    : pool_(pool), conn_(std::move(conn)), acquiredAt_(Clock::now()) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), conn_(std::move(other.conn_)), acquiredAt_(other.acquiredAt_) {
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        conn_ = std::move(other.conn_);
+        acquiredAt_ = other.acquiredAt_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool_ && conn_) {
+        pool_->release(std::move(conn_), acquiredAt_);
+    }
+    pool_ = nullptr;
+    conn_.reset();
+}
+
+// ---------------------------------------------------------------------------
+// ConnectionPool
+
+ConnectionPool::ConnectionPool(std::string connectionString, Options options)
+    : connectionString_(std::move(connectionString)), options_(options) {
+    options_.maxSize = std::max<size_t>(options_.maxSize, 1);
+    options_.minSize = std::min(options_.minSize, options_.maxSize);
+}
+
+ConnectionPool::~ConnectionPool() {
+    shutdown();
+}
+
+bool ConnectionPool::start() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (running_) return true;
+
+    startedAt_ = Clock::now();
+    nextConnectAttempt_ = startedAt_;
+    backoff_ = std::chrono::milliseconds(0);
+
+    size_t target = std::max<size_t>(options_.minSize, 1);
+    for (size_t i = 0; i < target; ++i) {
+        auto conn = openLocked(lock);
+        if (!conn) break;
+        idle_.push_back(Idle{std::move(conn), Clock::now()});
+    }
+
+    if (total_ == 0) {
+        LOG_ERROR("Connection pool: no connection could be opened: ", lastError_);
+        return false;
+    }
+
+    running_ = true;
+    maintenance_ = std::thread(&ConnectionPool::maintain, this);
+    LOG_INFO("Connection pool started: ", total_, " open, max ",
+             options_.maxSize);
+    return true;
+}
+
+void ConnectionPool::shutdown() {
+    std::vector<Idle> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ && idle_.empty()) return;
+        running_ = false;
+        closing.swap(idle_);
+        total_ -= closing.size();
+    }
+    available_.notify_all();
+    stopCv_.notify_all();
+    if (maintenance_.joinable()) {
+        maintenance_.join();
+    }
+    // Соединения закрываются вне блокировки
+    closing.clear();
+}
+
+std::unique_ptr<PgConnection> ConnectionPool::openLocked(std::unique_lock<std::mutex>& lock) {
+    total_++;
+    lock.unlock();
+    auto conn = std::make_unique<PgConnection>(connectionString_);
+    lock.lock();
+
+    if (conn->isOpen()) {
+        conn->setStatementCacheCapacity(options_.statementCacheSize);
+        conn->setBinaryResults(options_.binaryResults);
+        backoff_ = std::chrono::milliseconds(0);
+        nextConnectAttempt_ = Clock::now();
+        return conn;
+    }
+
+    total_--;
+    counters_.connectFailures++;
+    lastError_ = conn->lastError();
+    backoff_ = backoff_.count() == 0 ? kInitialBackoff : std::min(backoff_ * 2, options_.maxBackoff);
+    nextConnectAttempt_ = Clock::now() + backoff_;
+    LOG_WARNING("Connection pool: connect failed, retry in ",
+                backoff_.count(), " ms");
+    return nullptr;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(std::chrono::milliseconds timeout) {
+    const auto start = Clock::now();
+    const auto deadline = start + timeout;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::unique_ptr<PgConnection> conn;
+
+    while (running_) {
+        if (!idle_.empty()) {
+            // LIFO: горячие соединения используются чаще, холодные доживают до reap
+            conn = std::move(idle_.back().conn);
+            idle_.pop_back();
+            break;
+        }
+
+        auto now = Clock::now();
+        if (total_ < options_.maxSize && now >= nextConnectAttempt_) {
+            conn = openLocked(lock);
+            if (conn) break;
+            continue;
+        }
+
+        if (now >= deadline) break;
+        auto wakeAt = deadline;
+        if (total_ < options_.maxSize) {
+            wakeAt = std::min(wakeAt, nextConnectAttempt_);
+        }
+        available_.wait_until(lock, wakeAt);
+    }
+
+    auto waited = Clock::now() - start;
+    totalWait_ += waited;
+    counters_.maxWaitMs = std::max(counters_.maxWaitMs, toMs(waited));
+
+    if (!conn) {
+        if (timeout.count() > 0) counters_.timeouts++;
+        return Lease();
+    }
+
+    counters_.acquisitions++;
+    inUse_++;
+    counters_.peakInUse = std::max(counters_.peakInUse, inUse_);
+    return Lease(this, std::move(conn));
+}
+
+void ConnectionPool::release(std::unique_ptr<PgConnection> conn, Clock::time_point acquiredAt) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    inUse_--;
+    busyTime_ += Clock::now() - acquiredAt;
+
+    if (!running_ || !conn->isOpen()) {
+        total_--;
+        if (running_) counters_.dropped++;
+        lock.unlock();
+        conn.reset();
+        available_.notify_one();
+        return;
+    }
+
+    conn->touch();
+    idle_.push_back(Idle{std::move(conn), Clock::now()});
+    lock.unlock();
+    available_.notify_one();
+}
+
+void ConnectionPool::maintain() {
+    auto lastHealthCheck = Clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        stopCv_.wait_for(lock, kMaintenanceTick, [this] { return !running_; });
+        if (!running_) break;
+
+        auto now = Clock::now();
+        std::vector<std::unique_ptr<PgConnection>> closing;
+
+        // Лишние простаивающие соединения (самые старые - в начале вектора)
+        while (total_ > options_.minSize && !idle_.empty() &&
+               now - idle_.front().since >= options_.idleTimeout) {
+            closing.push_back(std::move(idle_.front().conn));
+            idle_.erase(idle_.begin());
+            total_--;
+            counters_.reaped++;
+        }
+
+        // Проверка простаивающих соединений вне блокировки
+        if (now - lastHealthCheck >= options_.healthCheckInterval && !idle_.empty()) {
+            lastHealthCheck = now;
+            std::vector<Idle> checking;
+            checking.swap(idle_);
+            lock.unlock();
+
+            std::vector<Idle> healthy;
+            size_t reconnected = 0;
+            for (auto& entry : checking) {
+                if (entry.conn->ping()) {
+                    healthy.push_back(std::move(entry));
+                } else if (entry.conn->reset()) {
+                    reconnected++;
+                    healthy.push_back(Idle{std::move(entry.conn), Clock::now()});
+                } else {
+                    closing.push_back(std::move(entry.conn));
+                }
+            }
+
+            lock.lock();
+            size_t dropped = checking.size() - healthy.size();
+            total_ -= dropped;
+            counters_.dropped += dropped;
+            counters_.reconnects += reconnected;
+            for (auto& entry : healthy) {
+                if (running_) {
+                    idle_.push_back(std::move(entry));
+                } else {
+                    total_--;
+                    closing.push_back(std::move(entry.conn));
+                }
+            }
+            // Сохранить порядок "старые впереди" для reap
+            std::sort(idle_.begin(), idle_.end(),
+                      [](const Idle& a, const Idle& b) { return a.since < b.since; });
+            if (!healthy.empty()) available_.notify_all();
+        }
+
+        // Добор до minSize с учётом задержки после неудач
+        while (running_ && total_ < options_.minSize && Clock::now() >= nextConnectAttempt_) {
+            auto conn = openLocked(lock);
+            if (!conn) break;
+            idle_.push_back(Idle{std::move(conn), Clock::now()});
+            available_.notify_one();
+        }
+
+        if (!closing.empty()) {
+            lock.unlock();
+            closing.clear();
+            lock.lock();
+        }
+    }
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = counters_;
+    s.size = total_;
+    s.idle = idle_.size();
+    s.inUse = inUse_;
+    s.maxSize = options_.maxSize;
+    if (s.acquisitions + s.timeouts > 0) {
+        s.avgWaitMs = toMs(totalWait_) / static_cast<double>(s.acquisitions + s.timeouts);
+    }
+    if (running_) {
+        auto elapsed = Clock::now() - startedAt_;
+        if (elapsed.count() > 0) {
+            s.utilisation = toMs(busyTime_) / (toMs(elapsed) * static_cast<double>(options_.maxSize));
+        }
+    }
+    return s;
+}
+
+std::string ConnectionPool::lastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
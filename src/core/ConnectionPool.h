@@ -0,0 +1,134 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include "src/core/PgConnection.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Пул соединений PostgreSQL.
+// - acquire() выдаёт свободное соединение или открывает новое (до maxSize),
+//   иначе ждёт не дольше acquireTimeout;
+// - соединение возвращается в пул деструктором Lease, разорванное - закрывается;
+// - фоновый поток проверяет простаивающие соединения пустым запросом,
+//   закрывает лишние после idleTimeout и добирает пул до minSize;
+// - неудачные подключения повторяются с экспоненциальной задержкой.
+class ConnectionPool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t minSize = 1;
+        size_t maxSize = 8;
+        std::chrono::milliseconds acquireTimeout{5000};
+        std::chrono::milliseconds idleTimeout{300000};
+        std::chrono::milliseconds healthCheckInterval{30000};
+        std::chrono::milliseconds maxBackoff{30000};
+        size_t statementCacheSize = 0;  // подготовленных операторов на соединение
+        bool binaryResults = false;     // бинарный формат результата операторов
+    };
+
+    struct Stats {
+        size_t size = 0;          // открытые соединения
+        size_t idle = 0;
+        size_t inUse = 0;
+        size_t peakInUse = 0;
+        size_t maxSize = 0;
+        uint64_t acquisitions = 0;
+        uint64_t timeouts = 0;
+        uint64_t connectFailures = 0;
+        uint64_t reconnects = 0;  // восстановлено PQreset после неудачной проверки
+        uint64_t dropped = 0;     // закрыто разорванных
+        uint64_t reaped = 0;      // закрыто по простою
+        double avgWaitMs = 0.0;
+        double maxWaitMs = 0.0;
+        double utilisation = 0.0; // доля занятого времени от maxSize с момента старта
+    };
+
+    // Аренда соединения: возвращает его в пул при разрушении
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        explicit operator bool() const { return conn_ != nullptr; }
+        PgConnection* operator->() const { return conn_.get(); }
+        PgConnection& operator*() const { return *conn_; }
+
+        void release();
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, std::unique_ptr<PgConnection> conn);
+
+        ConnectionPool* pool_ = nullptr;
+        std::unique_ptr<PgConnection> conn_;
+        Clock::time_point acquiredAt_;
+    };
+
+    ConnectionPool(std::string connectionString, Options options);
+    ~ConnectionPool();
+
+    // Открыть minSize соединений и запустить обслуживание; false, если
+    // не удалось открыть ни одного
+    bool start();
+    void shutdown();
+
+    // Пустая аренда, если за acquireTimeout соединение не нашлось
+    Lease acquire() { return acquire(options_.acquireTimeout); }
+    // То же с явным ожиданием; timeout == 0 - только свободное или новое
+    // соединение, без ожидания (не учитывается как таймаут)
+    Lease acquire(std::chrono::milliseconds timeout);
+
+    Stats stats() const;
+    std::string lastError() const;
+    const Options& options() const { return options_; }
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+private:
+    struct Idle {
+        std::unique_ptr<PgConnection> conn;
+        Clock::time_point since;
+    };
+
+    void release(std::unique_ptr<PgConnection> conn, Clock::time_point acquiredAt);
+    // Вызывается под блокировкой: занимает слот, открывает соединение без
+    // блокировки и возвращает его, либо nullptr с обновлённой задержкой
+    std::unique_ptr<PgConnection> openLocked(std::unique_lock<std::mutex>& lock);
+    void maintain();
+
+    std::string connectionString_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable stopCv_;
+    std::vector<Idle> idle_;
+    size_t total_ = 0;
+    size_t inUse_ = 0;
+    bool running_ = false;
+    std::thread maintenance_;
+
+    Clock::time_point nextConnectAttempt_;
+    std::chrono::milliseconds backoff_{0};
+    std::string lastError_;
+
+    Clock::time_point startedAt_;
+    Stats counters_;
+    Clock::duration totalWait_{0};
+    Clock::duration busyTime_{0};
+};
+
+#endif // CONNECTION_POOL_H
@@ -0,0 +1,112 @@
+#include "src/core/CsvWriter.h"
+#include "src/utils/SimdScan.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    // Поля не длиннее копируются прямо в буфер приёмника (reserve/commit)
+    constexpr size_t kInlineField = 1024;
+}
+
+CsvWriter::CsvWriter(OutputSink& out) : CsvWriter(out, Options()) {}
+
+CsvWriter::CsvWriter(OutputSink& out, Options options) : out_(out), options_(std::move(options)) {
+    if (!valid(options_)) {
+        options_ = Options();
+    }
+    special_[static_cast<unsigned char>(options_.delimiter)] = true;
+    special_['"'] = special_['\n'] = special_['\r'] = true;
+}
+
+bool CsvWriter::valid(const Options& options) {
+    const char d = options.delimiter;
+    if (d == '"' || d == '\n' || d == '\r' || d == '\0') return false;
+    // Те же ограничения, что у COPY: иначе NULL не отличить от значения
+    return options.nullText.find_first_of(std::string{d, '"', '\n', '\r'}) == std::string::npos;
+}
+
+std::string CsvWriter::copyOptions(const Options& options) {
+    auto literal = [](std::string_view text) {
+        std::string quoted = "'";
+        for (char c : text) {
+            if (c == '\'') quoted += '\'';
+            quoted += c;
+        }
+        return quoted + "'";
+    };
+    const Options& checked = valid(options) ? options : Options();
+    return "FORMAT csv, HEADER, DELIMITER " + literal(std::string_view(&checked.delimiter, 1)) +
+           ", NULL " + literal(checked.nullText);
+}
+
+void CsvWriter::writeField(std::string_view value) {
+    const char* data = value.data();
+    size_t size = value.size();
+    size_t special = 0;
+    if (size < 16) {
+        // Короче блока SIMD: проверка по таблице, одно сравнение на байт
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        while (special < size && !special_[bytes[special]]) ++special;
+    } else {
+        special = Utils::findCsvSpecial(data, size, options_.delimiter);
+    }
+
+    if (special == size && value != options_.nullText) {
+        // reserve требует size <= capacity(), а приёмник может быть меньше kInlineField
+        if (size <= std::min(kInlineField, out_.capacity())) {
+            std::memcpy(out_.reserve(size), data, size);
+            out_.commit(size);
+        } else {
+            out_.write(data, size);
+        }
+        return;
+    }
+
+    // В кавычках: участки между '"' копируются целиком, кавычка удваивается
+    out_.put('"');
+    while (size > 0) {
+        const char* quote = static_cast<const char*>(std::memchr(data, '"', size));
+        size_t run = quote ? static_cast<size_t>(quote - data) : size;
+        out_.write(data, run);
+        if (!quote) break;
+        out_.write("\"\"", 2);
+        data += run + 1;
+        size -= run + 1;
+    }
+    out_.put('"');
+}
+
+void CsvWriter::writeHeader(const std::vector<std::string>& columns) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) out_.put(options_.delimiter);
+        writeField(columns[i]);
+    }
+    out_.put('\n');
+    headerWritten_ = true;
+}
+
+void CsvWriter::write(const DatabaseConnector::QueryResult& batch) {
+    if (!headerWritten_) writeHeader(batch.columns);
+
+    const size_t rows = static_cast<size_t>(batch.rowCount);
+    const size_t columns = batch.data.size();
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < columns; ++i) {
+            if (i > 0) out_.put(options_.delimiter);
+            const auto& column = batch.data[i];
+            if (column.isNull(r)) {
+                out_.write(options_.nullText);
+            } else if (column.native()) {
+                writeField(column.text(r));
+            } else {
+                writeField(column.value(r));
+            }
+        }
+        out_.put('\n');
+    }
+}
+
+void CsvWriter::finish(size_t, bool) {
+    if (!headerWritten_) writeHeader({});
+}
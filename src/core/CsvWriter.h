@@ -0,0 +1,44 @@
+#ifndef CSV_WRITER_H
+#define CSV_WRITER_H
+
+#include "src/core/ResponseParser.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Вывод результата в CSV по RFC 4180. Поле берётся в кавычки, только если
+// содержит разделитель, '"' или перевод строки (кавычки внутри удваиваются),
+// а также если совпадает с nullText (по умолчанию - пустая строка), иначе
+// его не отличить от NULL - так же поступает COPY ... CSV. Поля без
+// спецсимволов (поиск поблочно, Utils::findCsvSpecial) копируются целиком.
+class CsvWriter : public ResultWriter {
+public:
+    struct Options {
+        char delimiter = ',';
+        std::string nullText;  // представление NULL; по умолчанию пусто, как в COPY
+    };
+
+    explicit CsvWriter(OutputSink& out);
+    CsvWriter(OutputSink& out, Options options);
+
+    void write(const DatabaseConnector::QueryResult& batch) override;
+    void finish(size_t rowCount, bool truncated) override;
+
+    // Те же настройки в виде параметров COPY ... TO STDOUT WITH (...)
+    static std::string copyOptions(const Options& options);
+    // Разделитель - не кавычка и не перевод строки, в nullText нет ни
+    // разделителя, ни кавычек, ни переводов строк. Недопустимые настройки
+    // заменяются значениями по умолчанию
+    static bool valid(const Options& options);
+
+private:
+    void writeField(std::string_view value);
+    void writeHeader(const std::vector<std::string>& columns);
+
+    OutputSink& out_;
+    Options options_;
+    bool headerWritten_ = false;
+    bool special_[256] = {};  // байты, из-за которых поле берётся в кавычки
+};
+
+#endif // CSV_WRITER_H
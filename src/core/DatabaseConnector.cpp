@@ -1,8 +1,94 @@
 #include "src/core/DatabaseConnector.h"
+#include "src/core/ChangeListener.h"
 #include "src/utils/Logger.h"
+#include "src/utils/SqlParser.h"
+#include "src/utils/SqlText.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 #include <sstream>
 
-DatabaseConnector::DatabaseConnector() : connection_(nullptr) {}
+namespace {
+    // Канал, в который пишет notify_table_change() из init_database.sql
+    const char* kChangeChannel = "table_changes";
+    
+    // Запас сверх statement_timeout: сначала срабатывает сервер, сторож -
+    // только если ответ так и не пришёл
+    constexpr std::chrono::milliseconds kWatchdogGrace{2000};
+    
+    // SQLSTATE query_canceled; текст различает таймаут и отмену клиентом
+    bool isStatementTimeout(const PGresult* res) {
+        const char* state = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+        const char* message = PQresultErrorMessage(res);
+        return state && std::string(state) == "57014" && message &&
+               std::string(message).find("statement timeout") != std::string::npos;
+    }
+    
+    // SQLSTATE read_only_sql_transaction: запрос с записью ушёл на реплику
+    constexpr const char* kReadOnlyViolation = "25006";
+    
+    std::string errorState(const PGresult* res) {
+        const char* state = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+        return state ? state : "";
+    }
+    
+    // Ошибка, которую могла вызвать подстановка литерала параметром: тип $n
+    // сервер выводит из другой стороны сравнения (int_col > $1 при '30.5'),
+    // а у литерала в тексте был свой тип. Только коды вывода типов: ошибка
+    // синтаксиса или неизвестная колонка повторилась бы и в исходном тексте
+    constexpr const char* kParameterTypeStates[] = {
+        "42804",  // datatype_mismatch
+        "42883",  // undefined_function
+        "42P18",  // indeterminate_datatype
+        "42725",  // ambiguous_function
+        "22P02",  // invalid_text_representation
+        "22003",  // numeric_value_out_of_range
+    };
+    
+    // feature_not_supported: "cached plan must not change result type" -
+    // колонки таблицы изменились после подготовки оператора
+    bool isStalePlan(const PGresult* res) {
+        const char* state = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+        return state && std::strcmp(state, "0A000") == 0;
+    }
+    
+    bool isParameterTypeError(const PGresult* res) {
+        const char* state = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+        if (!state) return false;
+        return std::any_of(std::begin(kParameterTypeStates), std::end(kParameterTypeStates),
+                           [state](const char* code) { return std::strcmp(state, code) == 0; });
+    }
+    
+    const char* kTableSchemaQuery =
+        "SELECT column_name, data_type, is_nullable "
+        "FROM information_schema.columns "
+        "WHERE table_name = $1 "
+        "ORDER BY ordinal_position";
+    
+    std::map<std::string, std::vector<std::string>> parseSchema(const QueryResult& result) {
+        std::map<std::string, std::vector<std::string>> schema;
+        if (!result.success) return schema;
+        for (auto row : result) {
+            if (row.size() >= 3) {
+                schema[row[0]] = {row[1], row[2]};
+            }
+        }
+        return schema;
+    }
+    
+    // Тот же формат из каталога: колонка -> {тип, "YES"/"NO"}
+    std::map<std::string, std::vector<std::string>> catalogSchema(const CatalogTable* table) {
+        std::map<std::string, std::vector<std::string>> schema;
+        if (!table) return schema;
+        for (const auto& column : table->columns) {
+            schema[column.name] = {column.type, column.nullable ? "YES" : "NO"};
+        }
+        return schema;
+    }
+}
+
+DatabaseConnector::DatabaseConnector() = default;
 
 DatabaseConnector::~DatabaseConnector() {
     disconnect();
@@ -24,6 +110,10 @@ std::string DatabaseConnector::buildConnectionString(
         oss << " password=" << password;
     }
     
+    if (statementTimeout_.count() > 0) {
+        oss << " options='-c statement_timeout=" << statementTimeout_.count() << "'";
+    }
+    
     return oss.str();
 }
 
@@ -31,79 +121,753 @@ bool DatabaseConnector::connect(const std::string& host, int port,
                                const std::string& dbname,
                                const std::string& user,
                                const std::string& password) {
-    try {
-        connectionString_ = buildConnectionString(host, port, dbname, user, password);
-        connection_ = std::make_unique<pqxx::connection>(connectionString_);
-        
-        if (connection_->is_open()) {
-            Logger::getInstance().info("Successfully connected to database: " + dbname);
-            return true;
-        }
-    } catch (const std::exception& e) {
-        Logger::getInstance().error("Database connection failed: " + std::string(e.what()));
-        connection_.reset();
+    disconnect();
+    
+    connectionString_ = buildConnectionString(host, port, dbname, user, password);
+    pool_ = std::make_unique<ConnectionPool>(connectionString_, poolOptions_);
+    
+    if (!pool_->start()) {
+        LOG_ERROR("Database connection failed: ", pool_->lastError());
+        pool_.reset();
+        return false;
     }
     
-    return false;
+    LOG_INFO("Successfully connected to database: ", dbname);
+    watchdog_.start();
+    if (!replicaHosts_.empty()) {
+        replicaRouter_ = std::make_unique<ReplicaRouter>(replicaOptions_);
+        for (const auto& replica : replicaHosts_) {
+            std::string replicaHost = replica;
+            int replicaPort = port;
+            size_t colon = replica.rfind(':');
+            if (colon != std::string::npos) {
+                replicaHost = replica.substr(0, colon);
+                replicaPort = std::atoi(replica.c_str() + colon + 1);
+            }
+            replicaRouter_->addReplica(replicaHost + ":" + std::to_string(replicaPort),
+                                       buildConnectionString(replicaHost, replicaPort, dbname, user, password),
+                                       poolOptions_);
+        }
+        replicaRouter_->start();
+    }
+    {
+        auto lease = pool_->acquire();
+        if (!lease || !schemaCatalog_.load(*lease)) {
+            LOG_WARNING("Schema catalog unavailable, metadata will be queried directly");
+        }
+    }
+    if (asyncEnabled_) {
+        asyncExecutor_ = std::make_unique<AsyncExecutor>(*pool_, asyncOptions_);
+        if (!asyncExecutor_->start()) {
+            asyncExecutor_.reset();
+        }
+    }
+    // Слушатель нужен и без кэша результатов: пустое уведомление (DDL или
+    // переподключение) помечает каталог схемы устаревшим
+    changeListener_ = std::make_unique<ChangeListener>(
+        connectionString_, kChangeChannel,
+        [this](const std::string& table) {
+            if (table.empty()) {
+                schemaCatalog_.markStale();
+                schemaEpoch_.fetch_add(1, std::memory_order_acq_rel);
+            }
+            invalidateTable(table);
+        });
+    changeListener_->start();
+    return true;
 }
 
 void DatabaseConnector::disconnect() {
-    if (connection_ && connection_->is_open()) {
-        connection_->close();
-        Logger::getInstance().info("Database connection closed");
+    if (changeListener_) {
+        changeListener_->stop();
+        changeListener_.reset();
+    }
+    clearResultCache();
+    schemaCatalog_.reset();
+    if (asyncExecutor_) {
+        asyncExecutor_->stop();
+        asyncExecutor_.reset();
+    }
+    if (replicaRouter_) {
+        replicaRouter_->stop();
+        replicaRouter_.reset();
+    }
+    watchdog_.stop();
+    if (pool_) {
+        pool_->shutdown();
+        pool_.reset();
+        LOG_INFO("Database connection closed");
     }
-    connection_.reset();
 }
 
 bool DatabaseConnector::isConnected() const {
-    return connection_ && connection_->is_open();
+    return pool_ != nullptr;
+}
+
+void DatabaseConnector::configurePool(const ConnectionPool::Options& options) {
+    poolOptions_ = options;
+}
+
+ConnectionPool::Stats DatabaseConnector::getPoolStats() const {
+    return pool_ ? pool_->stats() : ConnectionPool::Stats{};
+}
+
+void DatabaseConnector::configureAsync(const AsyncExecutor::Options& options) {
+    asyncOptions_ = options;
+    asyncEnabled_ = options.connections > 0;
+}
+
+AsyncExecutor::Stats DatabaseConnector::getAsyncStats() const {
+    return asyncExecutor_ ? asyncExecutor_->stats() : AsyncExecutor::Stats{};
+}
+
+void DatabaseConnector::executeAsync(const std::string& query, const std::vector<std::string>& params,
+                                     AsyncExecutor::Callback callback) {
+    if (!asyncExecutor_) {
+        callback(execute(query, params));
+        return;
+    }
+    asyncExecutor_->submit(query, params, std::move(callback));
+}
+
+std::future<DatabaseConnector::QueryResult> DatabaseConnector::executeAsync(
+    const std::string& query, const std::vector<std::string>& params) {
+    if (!asyncExecutor_) {
+        std::promise<QueryResult> ready;
+        ready.set_value(execute(query, params));
+        return ready.get_future();
+    }
+    return asyncExecutor_->submit(query, params);
+}
+
+void DatabaseConnector::configureReplicas(const std::vector<std::string>& hosts,
+                                          const ReplicaRouter::Options& options) {
+    replicaHosts_.clear();
+    for (const auto& host : hosts) {
+        if (!host.empty()) replicaHosts_.push_back(host);
+    }
+    replicaOptions_ = options;
+}
+
+ReplicaRouter::Stats DatabaseConnector::getReplicaStats() const {
+    return replicaRouter_ ? replicaRouter_->stats() : ReplicaRouter::Stats{};
+}
+
+PgConnection* DatabaseConnector::acquireConnection(bool readOnly, ReplicaRouter::Route& replica,
+                                                   ConnectionPool::Lease& lease) {
+    if (readOnly && replicaRouter_) {
+        replica = replicaRouter_->route();
+        if (replica) return &*replica;
+    }
+    lease = pool_->acquire();
+    return lease ? &*lease : nullptr;
+}
+
+void DatabaseConnector::releaseRejectingReplica(ReplicaRouter::Route& replica) {
+    replica = ReplicaRouter::Route();
+    replicaRouter_->recordWriteRetry();
+    LOG_DEBUG("Replica rejected a write, retrying on primary");
+}
+
+PgConnection* DatabaseConnector::retryOnPrimary(ReplicaRouter::Route& replica, ConnectionPool::Lease& lease) {
+    releaseRejectingReplica(replica);
+    lease = pool_->acquire();
+    return lease ? &*lease : nullptr;
+}
+
+void DatabaseConnector::configureStatementTimeout(std::chrono::milliseconds timeout) {
+    statementTimeout_ = std::max(timeout, std::chrono::milliseconds(0));
+}
+
+DatabaseConnector::TimeoutStats DatabaseConnector::getTimeoutStats() const {
+    TimeoutStats stats;
+    stats.statementTimeouts = statementTimeouts_.load(std::memory_order_relaxed);
+    stats.watchdogCancels = watchdog_.cancellations();
+    stats.streamCancels = streamCancels_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+QueryWatchdog::Guard DatabaseConnector::watchQuery(PgConnection& conn, std::chrono::milliseconds timeout) {
+    if (timeout.count() <= 0) {
+        return QueryWatchdog::Guard();
+    }
+    return watchdog_.watch(conn, timeout + kWatchdogGrace);
+}
+
+void DatabaseConnector::recordFailure(const PGresult* res) {
+    if (res && isStatementTimeout(res)) {
+        statementTimeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DatabaseConnector::configureSchemaCatalog(std::chrono::seconds refreshInterval) {
+    schemaCatalog_.setRefreshInterval(refreshInterval);
+}
+
+std::shared_ptr<const SchemaSnapshot> DatabaseConnector::getSchemaSnapshot() {
+    if (pool_ && schemaCatalog_.isDue()) {
+        auto lease = pool_->acquire();
+        if (lease) {
+            schemaCatalog_.refresh(*lease);
+        }
+    }
+    return schemaCatalog_.snapshot();
+}
+
+SchemaCatalog::Stats DatabaseConnector::getSchemaStats() const {
+    return schemaCatalog_.stats();
+}
+
+void DatabaseConnector::configureResultCache(size_t byteBudget, size_t shardCount, int ttlSeconds) {
+    resultCacheTtl_ = std::chrono::seconds(std::max(ttlSeconds, 0));
+    if (byteBudget == 0) {
+        resultCache_.reset();
+        LOG_INFO("Query result cache disabled");
+        return;
+    }
+    resultCache_ = std::make_unique<ShardedLruCache<CachedResult>>(byteBudget, shardCount);
+    LOG_INFO("Query result cache: ", byteBudget, " bytes, TTL ",
+             resultCacheTtl_.count(), "s");
+}
+
+void DatabaseConnector::clearResultCache() {
+    if (resultCache_) {
+        invalidationEpoch_.fetch_add(1, std::memory_order_acq_rel);
+        resultCache_->clear();
+    }
+}
+
+DatabaseConnector::ResultCacheStats DatabaseConnector::getResultCacheStats() const {
+    ResultCacheStats stats;
+    if (resultCache_) {
+        auto s = resultCache_->stats();
+        stats.hits = s.hits;
+        stats.misses = s.misses;
+        stats.evictions = s.evictions;
+        stats.expirations = s.expirations;
+        stats.entries = s.entries;
+        stats.bytes = s.bytes;
+        stats.byteBudget = s.byteBudget;
+    }
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    stats.listening = changeListener_ && changeListener_->isListening();
+    return stats;
+}
+
+DatabaseConnector::StatementStats DatabaseConnector::getStatementStats() const {
+    StatementStats stats;
+    stats.cached = statementsCached_.load(std::memory_order_relaxed);
+    stats.prepared = statementsPrepared_.load(std::memory_order_relaxed);
+    stats.failed = statementsFailed_.load(std::memory_order_relaxed);
+    stats.unparsed = statementsUnparsed_.load(std::memory_order_relaxed);
+    stats.fallbacks = statementFallbacks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Utils::SqlShape DatabaseConnector::analyzeQuery(const std::string& query) {
+    Utils::SqlShape shape = Utils::analyzeSql(query);
+    if (!shape.parsed) {
+        statementsUnparsed_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return shape;
+}
+
+std::string DatabaseConnector::resultCacheKey(const Utils::SqlShape& shape) const {
+    // Без активного LISTEN об изменениях не узнать - не кэшируем вовсе
+    if (!resultCache_ || !changeListener_ || !changeListener_->isListening()) {
+        return "";
+    }
+    
+    // Разобранный запрос - всегда SELECT (в том числе с WITH); остальное
+    // проверяется по тексту
+    if (!shape.parsed && shape.key.compare(0, 7, "select ") != 0) {
+        return "";
+    }
+    
+    // Кэшируются только запросы к таблицам с триггерами: иначе изменение
+    // (или представление поверх них) пройдёт незамеченным
+    if (shape.tables.empty()) {
+        return "";
+    }
+    for (const auto& table : shape.tables) {
+        if (!changeListener_->isWatched(table)) {
+            return "";
+        }
+    }
+    
+    return shape.key;
+}
+
+void DatabaseConnector::invalidateTable(const std::string& table) {
+    if (!resultCache_) return;
+    
+    invalidationEpoch_.fetch_add(1, std::memory_order_acq_rel);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+    
+    if (table.empty()) {
+        resultCache_->clear();
+        return;
+    }
+    
+    size_t erased = resultCache_->eraseIf([&table](const std::string&, const CachedResult& entry) {
+        return std::find(entry.tables.begin(), entry.tables.end(), table) != entry.tables.end();
+    });
+    if (erased > 0) {
+        LOG_DEBUG("Result cache: dropped ", erased,
+                  " entries for table ", table);
+    }
 }
 
 DatabaseConnector::QueryResult DatabaseConnector::executeQuery(const std::string& query) {
+    Utils::SqlShape shape = analyzeQuery(query);
+    std::string cacheKey = resultCacheKey(shape);
+    uint64_t epoch = invalidationEpoch_.load(std::memory_order_acquire);
+    if (!cacheKey.empty()) {
+        if (auto cached = resultCache_->get(cacheKey)) {
+            LOG_INFO("Query result served from cache. Rows: ",
+                    cached->result->rowCount);
+            return *cached->result;
+        }
+    }
+    
+    QueryResult result;
+    bool fromReplica = false;
+    if (poolOptions_.statementCacheSize > 0) {
+        result = execute(shape.statement.text, shape.statement.params, query, &fromReplica);
+    } else {
+        result = execute(query, {}, "", &fromReplica);
+    }
+    
+    // Ответ реплики не кэшируется, как и в stream: иначе строки, устаревшие
+    // к приходу NOTIFY, остались бы в кэше до TTL
+    if (result.success && !cacheKey.empty() && !fromReplica) {
+        storeResult(cacheKey, shape.tables, epoch, result);
+    }
+    
+    return result;
+}
+
+void DatabaseConnector::storeResult(const std::string& key, const std::vector<std::string>& tables,
+                                    uint64_t epoch, const QueryResult& result) {
+    // Если во время выполнения пришло уведомление, результат мог устареть
+    if (epoch != invalidationEpoch_.load(std::memory_order_acquire)) {
+        return;
+    }
+    resultCache_->put(key, CachedResult{std::make_shared<const QueryResult>(result), tables},
+                      result.byteSize(), resultCacheTtl_);
+    // Инвалидация между проверкой и вставкой: eraseIf мог пройти раньше put
+    if (epoch != invalidationEpoch_.load(std::memory_order_acquire)) {
+        resultCache_->erase(key);
+    }
+}
+
+DatabaseConnector::QueryResult DatabaseConnector::executeQuery(const std::string& query,
+                                                               const std::vector<std::string>& params) {
+    return execute(query, params);
+}
+
+DatabaseConnector::QueryResult DatabaseConnector::execute(const std::string& query,
+                                                          const std::vector<std::string>& params,
+                                                          const std::string& fallback,
+                                                          bool* fromReplica) {
     QueryResult result;
     result.success = false;
     result.rowCount = 0;
     
     if (!isConnected()) {
         result.errorMessage = "Not connected to database";
-        Logger::getInstance().error(result.errorMessage);
+        LOG_ERROR(result.errorMessage);
+        return result;
+    }
+    
+    ReplicaRouter::Route replica;
+    ConnectionPool::Lease lease;
+    const bool readOnly = Utils::isReadOnlySelect(query);
+    PgConnection* conn = acquireConnection(readOnly, replica, lease);
+    if (!conn) {
+        result.errorMessage = "No database connection available: " + pool_->lastError();
+        LOG_ERROR(result.errorMessage);
         return result;
     }
     
-    try {
-        pqxx::work txn(*connection_);
-        pqxx::result res = txn.exec(query);
+    bool ok = runQuery(*conn, query, params, readOnly, result, fallback);
+    if (!ok && replica && result.sqlState == kReadOnlyViolation) {
+        conn = retryOnPrimary(replica, lease);
+        result = QueryResult{};
+        if (!conn) {
+            result.errorMessage = "No database connection available: " + pool_->lastError();
+            LOG_ERROR(result.errorMessage);
+            return result;
+        }
+        ok = runQuery(*conn, query, params, readOnly, result, fallback);
+    }
+    if (fromReplica) *fromReplica = static_cast<bool>(replica);
+    if (ok) {
+        LOG_INFO("Query executed successfully. Rows: ", 
+                result.rowCount);
+    } else {
+        LOG_ERROR("Query execution failed: ", result.errorMessage);
+    }
+    
+    return result;
+}
+
+std::string DatabaseConnector::prepareStatement(PgConnection& conn, const std::string& query,
+                                                size_t paramCount) {
+    if (poolOptions_.statementCacheSize == 0) {
+        return "";
+    }
+    
+    conn.syncStatements(schemaEpoch_.load(std::memory_order_acquire));
+    PgConnection::PrepareOutcome outcome;
+    std::string statement = conn.prepare(query, static_cast<int>(paramCount), outcome);
+    switch (outcome) {
+        case PgConnection::PrepareOutcome::Cached:
+            statementsCached_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case PgConnection::PrepareOutcome::Prepared:
+            statementsPrepared_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case PgConnection::PrepareOutcome::Failed:
+            statementsFailed_.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+    return statement;
+}
+
+void DatabaseConnector::fallBackToText(PgConnection& conn, const std::string& statement,
+                                       const std::string& error) {
+    conn.evictStatement(statement);
+    statementFallbacks_.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("Parameterized form rejected, retrying original text: ", error);
+}
+
+void DatabaseConnector::replanStatement(PgConnection& conn, const std::string& statement,
+                                        const std::string& error) {
+    conn.evictStatement(statement);
+    LOG_DEBUG("Prepared statement outdated by schema change, preparing again: ", error);
+}
+
+bool DatabaseConnector::runQuery(PgConnection& conn, const std::string& query,
+                                 const std::vector<std::string>& params, bool readOnly,
+                                 QueryResult& result, const std::string& fallback) {
+    // Подготовка до BEGIN: ошибка PQprepare не должна прерывать транзакцию
+    std::string statement = prepareStatement(conn, query, params.size());
+    
+    // Одиночное чтение выполняется в неявной транзакции - на два обмена меньше
+    const bool transactional = !readOnly;
+    PgResult res;
+    for (bool replanned = false;; replanned = true) {
+        if (transactional && !conn.command("BEGIN")) {
+            result.errorMessage = conn.lastError();
+            return false;
+        }
         
-        // Получение имен колонок
-        for (size_t i = 0; i < res.columns(); ++i) {
-            result.columns.push_back(res.column_name(i));
+        {
+            auto guard = watchQuery(conn, statementTimeout_);
+            if (!statement.empty()) {
+                res = conn.execPrepared(statement, params);
+            } else if (!params.empty()) {
+                res = conn.execParams(query, params);
+            } else {
+                res = conn.exec(query);
+            }
+        }
+        ExecStatusType status = res ? PQresultStatus(res.get()) : PGRES_FATAL_ERROR;
+        if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK) {
+            break;
         }
         
-        // Получение данных
-        for (const auto& row : res) {
-            std::vector<std::string> rowData;
-            for (size_t i = 0; i < row.size(); ++i) {
-                rowData.push_back(row[i].is_null() ? "NULL" : row[i].c_str());
+        result.errorMessage = res ? PQresultErrorMessage(res.get()) : conn.lastError();
+        result.sqlState = errorState(res.get());
+        recordFailure(res.get());
+        if (transactional) conn.command("ROLLBACK");
+        // План оператора устарел после DDL - подготовить заново, один раз
+        if (!replanned && !statement.empty() && isStalePlan(res.get())) {
+            replanStatement(conn, query, result.errorMessage);
+            statement = prepareStatement(conn, query, params.size());
+            result = QueryResult{};
+            continue;
+        }
+        if (!fallback.empty() && fallback != query && isParameterTypeError(res.get())) {
+            fallBackToText(conn, query, result.errorMessage);
+            result = QueryResult{};
+            return runQuery(conn, fallback, {}, readOnly, result);
+        }
+        return false;
+    }
+    
+    // Колонки и данные копируются из буферов libpq колонка за колонкой
+    result.setColumns(res.get());
+    result.appendRows(res.get());
+    
+    if (transactional && !conn.command("COMMIT")) {
+        result = QueryResult{};
+        result.errorMessage = conn.lastError();
+        return false;
+    }
+    
+    result.success = true;
+    return true;
+}
+
+DatabaseConnector::StreamResult DatabaseConnector::streamQuery(const std::string& query,
+                                                               const RowConsumer& consumer,
+                                                               const StreamOptions& options) {
+    return stream(query, consumer, options, true);
+}
+
+DatabaseConnector::StreamResult DatabaseConnector::stream(const std::string& query,
+                                                          const RowConsumer& consumer,
+                                                          const StreamOptions& options,
+                                                          bool allowReplica) {
+    StreamResult out;
+    
+    if (!isConnected()) {
+        out.errorMessage = "Not connected to database";
+        LOG_ERROR(out.errorMessage);
+        return out;
+    }
+    
+    Utils::SqlShape shape = analyzeQuery(query);
+    std::string cacheKey = resultCacheKey(shape);
+    uint64_t epoch = invalidationEpoch_.load(std::memory_order_acquire);
+    
+    if (!cacheKey.empty()) {
+        if (auto cached = resultCache_->get(cacheKey)) {
+            const QueryResult& full = *cached->result;
+            size_t rows = static_cast<size_t>(full.rowCount);
+            if (options.maxRows > 0 && rows > options.maxRows) {
+                QueryResult head = full;
+                head.truncateRows(options.maxRows);
+                consumer(head);
+                out.rowCount = options.maxRows;
+                out.truncated = true;
+            } else {
+                consumer(full);
+                out.rowCount = rows;
             }
-            result.rows.push_back(rowData);
+            out.success = true;
+            return out;
         }
+    }
+    
+    Utils::ParameterizedSql statement{query, {}};
+    if (poolOptions_.statementCacheSize > 0) {
+        statement = std::move(shape.statement);
+    }
+    
+    // Чтение - то же, что для маршрутизации на реплику (isReadOnlySelect)
+    const bool readOnly = shape.parsed;
+    ReplicaRouter::Route replica;
+    ConnectionPool::Lease lease;
+    PgConnection* leased = acquireConnection(allowReplica && readOnly, replica, lease);
+    if (!leased) {
+        out.errorMessage = "No database connection available: " + pool_->lastError();
+        LOG_ERROR(out.errorMessage);
+        return out;
+    }
+    PgConnection& conn = *leased;
+    PGconn* raw = conn.raw();
+    
+    // Свой срок действует только внутри транзакции (SET LOCAL), поэтому
+    // чтение с переопределённым таймаутом тоже выполняется в BEGIN/COMMIT
+    const std::chrono::milliseconds timeout = options.timeout.count() > 0 ? options.timeout : statementTimeout_;
+    const bool overrideTimeout = options.timeout.count() > 0 && options.timeout != statementTimeout_;
+    const bool transactional = overrideTimeout || !readOnly;
+    const std::string setTimeout = "SET LOCAL statement_timeout = " + std::to_string(timeout.count());
+    
+    QueryResult batch;
+    batch.success = true;
+    batch.rowCount = 0;
+    size_t batchBytes = 0;
+    
+    // Копия для кэша результатов, пока результат не перерос долю шарда.
+    // Ответ реплики не кэшируется: NOTIFY приходит с основного сервера
+    // раньше, чем реплика применит изменение.
+    const bool collect = !cacheKey.empty() && !replica;
+    const size_t collectLimit = collect ? resultCache_->stats().byteBudget / 16 : 0;
+    QueryResult collected;
+    size_t collectedBytes = 0;
+    bool collecting = collect;
+    
+    bool stopped = false;
+    bool failed = false;
+    
+    auto flush = [&]() {
+        if (batch.empty()) return true;
+        if (collecting) {
+            collected.append(batch);
+        }
+        bool more = consumer(batch);
+        batch.clearRows();
+        batchBytes = 0;
+        return more;
+    };
+    auto cancel = [&]() {
+        stopped = true;
+        collecting = false;
+        streamCancels_.fetch_add(1, std::memory_order_relaxed);
+        conn.cancel();
+    };
+    
+    QueryWatchdog::Guard guard;
+    bool replanned = false;
+    while (true) {
+        std::string prepared = prepareStatement(conn, statement.text, statement.params.size());
         
-        result.rowCount = res.size();
-        result.success = true;
-        txn.commit();
+        if (transactional && !conn.command("BEGIN")) {
+            out.errorMessage = conn.lastError();
+            return out;
+        }
+        if (overrideTimeout && !conn.command(setTimeout.c_str())) {
+            out.errorMessage = conn.lastError();
+            conn.command("ROLLBACK");
+            return out;
+        }
+        
+        guard = watchQuery(conn, timeout);
+        
+        std::vector<const char*> values;
+        for (const auto& p : statement.params) values.push_back(p.c_str());
+        int sent;
+        if (!prepared.empty()) {
+            sent = PQsendQueryPrepared(raw, prepared.c_str(), static_cast<int>(values.size()),
+                                       values.data(), nullptr, nullptr, conn.resultFormat(prepared));
+        } else {
+            sent = PQsendQueryParams(raw, statement.text.c_str(), static_cast<int>(values.size()),
+                                     nullptr, values.data(), nullptr, nullptr, 0);
+        }
+        if (!sent || !PQsetSingleRowMode(raw)) {
+            out.errorMessage = conn.lastError();
+            while (PGresult* r = PQgetResult(raw)) PQclear(r);
+            if (transactional) conn.command("ROLLBACK");
+            return out;
+        }
         
-        Logger::getInstance().info("Query executed successfully. Rows: " + 
-                                  std::to_string(result.rowCount));
+        bool typeError = false;
+        bool stalePlan = false;
+        bool writeRejected = false;
+        while (PGresult* r = PQgetResult(raw)) {
+            PgResult res(r);
+            ExecStatusType status = PQresultStatus(r);
+            
+            if (status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK) {
+                if (batch.columns.empty()) {
+                    batch.setColumns(r);
+                }
+                if (status == PGRES_TUPLES_OK || stopped) {
+                    continue;  // конец результата или дочитывание после отмены
+                }
+                
+                int columnCount = PQnfields(r);
+                size_t rowBytes = sizeof(uint32_t) * columnCount;
+                for (int i = 0; i < columnCount; ++i) {
+                    rowBytes += PQgetlength(r, 0, i);
+                }
+                batch.appendRows(r);
+                batchBytes += rowBytes;
+                out.rowCount++;
+                
+                if (collecting) {
+                    collectedBytes += rowBytes;
+                    if (collectedBytes > collectLimit) {
+                        collecting = false;
+                        collected = QueryResult();
+                    }
+                }
+                
+                bool limitReached = options.maxRows > 0 && out.rowCount >= options.maxRows;
+                if (static_cast<size_t>(batch.rowCount) >= options.batchRows || batchBytes >= options.batchBytes || limitReached) {
+                    if (!flush()) {
+                        cancel();
+                    } else if (limitReached) {
+                        out.truncated = true;
+                        cancel();
+                    }
+                }
+            } else if (status != PGRES_COMMAND_OK && !stopped) {
+                failed = true;
+                typeError = isParameterTypeError(r);
+                stalePlan = isStalePlan(r);
+                writeRejected = errorState(r) == kReadOnlyViolation;
+                out.errorMessage = PQresultErrorMessage(r);
+                recordFailure(r);
+            }
+        }
+        guard = QueryWatchdog::Guard();
         
-    } catch (const std::exception& e) {
-        result.errorMessage = e.what();
-        Logger::getInstance().error("Query execution failed: " + result.errorMessage);
+        // План оператора устарел после DDL - подготовить заново, один раз
+        if (failed && stalePlan && !prepared.empty() && !replanned && out.rowCount == 0 &&
+            batch.columns.empty()) {
+            if (transactional) conn.command("ROLLBACK");
+            replanStatement(conn, statement.text, out.errorMessage);
+            replanned = true;
+            failed = false;
+            out.errorMessage.clear();
+            continue;
+        }
+        // Форма с параметрами отвергнута до первой строки - повторить
+        // исходным текстом на том же соединении
+        if (failed && typeError && statement.text != query && out.rowCount == 0 && batch.columns.empty()) {
+            if (transactional) conn.command("ROLLBACK");
+            fallBackToText(conn, statement.text, out.errorMessage);
+            statement = Utils::ParameterizedSql{query, {}};
+            failed = false;
+            out.errorMessage.clear();
+            continue;
+        }
+        // Реплика отказала в записи до первой строки - повторить на основном
+        if (failed && writeRejected && replica && out.rowCount == 0 && batch.columns.empty()) {
+            if (transactional) conn.command("ROLLBACK");
+            releaseRejectingReplica(replica);
+            return stream(query, consumer, options, false);
+        }
+        break;
     }
     
-    return result;
+    if (!failed && !stopped) {
+        if (out.rowCount == 0 && !batch.columns.empty()) {
+            // Пустой результат: форматтеру нужны колонки (заголовок CSV, схема Arrow)
+            if (collecting) collected.append(batch);
+            consumer(batch);
+        } else {
+            flush();
+        }
+    }
+    
+    if (transactional) {
+        if (failed || stopped) {
+            conn.command("ROLLBACK");
+        } else if (!conn.command("COMMIT")) {
+            failed = true;
+            out.errorMessage = conn.lastError();
+        }
+    }
+    
+    if (failed) {
+        LOG_ERROR("Query execution failed: ", out.errorMessage);
+        return out;
+    }
+    
+    out.success = true;
+    LOG_INFO("Query streamed successfully. Rows: ", out.rowCount,
+             (out.truncated ? " (truncated)" : ""));
+    
+    if (collecting) {
+        collected.success = true;
+        storeResult(cacheKey, shape.tables, epoch, collected);
+    }
+    
+    return out;
 }
 
 std::vector<std::string> DatabaseConnector::getTableNames() {
+    auto snapshot = getSchemaSnapshot();
+    if (snapshot->version > 0) {
+        return snapshot->tableNames();
+    }
+    
     std::vector<std::string> tables;
     
     std::string query = 
@@ -113,9 +877,9 @@ std::vector<std::string> DatabaseConnector::getTableNames() {
     auto result = executeQuery(query);
     
     if (result.success) {
-        for (const auto& row : result.rows) {
-            if (!row.empty()) {
-                tables.push_back(row[0]);
+        for (auto row : result) {
+            if (row.size() > 0) {
+                tables.emplace_back(row[0]);
             }
         }
     }
@@ -125,23 +889,133 @@ std::vector<std::string> DatabaseConnector::getTableNames() {
 
 std::map<std::string, std::vector<std::string>> 
 DatabaseConnector::getTableSchema(const std::string& tableName) {
-    std::map<std::string, std::vector<std::string>> schema;
+    auto snapshot = getSchemaSnapshot();
+    if (snapshot->version > 0) {
+        return catalogSchema(snapshot->find(tableName));
+    }
+    return parseSchema(executeQuery(kTableSchemaQuery, {tableName}));
+}
+
+std::map<std::string, std::map<std::string, std::vector<std::string>>>
+DatabaseConnector::getTableSchemas(const std::vector<std::string>& tableNames) {
+    std::map<std::string, std::map<std::string, std::vector<std::string>>> schemas;
     
-    std::string query = 
-        "SELECT column_name, data_type, is_nullable "
-        "FROM information_schema.columns "
-        "WHERE table_name = '" + tableName + "' "
-        "ORDER BY ordinal_position";
+    auto snapshot = getSchemaSnapshot();
+    if (snapshot->version > 0) {
+        for (const auto& table : tableNames) {
+            schemas[table] = catalogSchema(snapshot->find(table));
+        }
+        return schemas;
+    }
     
-    auto result = executeQuery(query);
+    // Все запросы отправляются сразу, ответы собираются по мере готовности
+    std::vector<std::future<QueryResult>> pending;
+    pending.reserve(tableNames.size());
+    for (const auto& table : tableNames) {
+        pending.push_back(executeAsync(kTableSchemaQuery, {table}));
+    }
     
-    if (result.success) {
-        for (const auto& row : result.rows) {
-            if (row.size() >= 3) {
-                schema[row[0]] = {row[1], row[2]};
+    for (size_t i = 0; i < tableNames.size(); ++i) {
+        schemas[tableNames[i]] = parseSchema(pending[i].get());
+    }
+    return schemas;
+}
+
+DatabaseConnector::CopyResult DatabaseConnector::copyOut(const std::string& query, const std::string& options,
+                                                         const CopyConsumer& consumer) {
+    CopyResult out;
+    
+    if (!isConnected()) {
+        out.errorMessage = "Not connected to database";
+        LOG_ERROR(out.errorMessage);
+        return out;
+    }
+    if (!Utils::isPlainSelect(Utils::normalizeSql(query))) {
+        out.errorMessage = "COPY export supports a single SELECT statement";
+        return out;
+    }
+    
+    ReplicaRouter::Route replica;
+    ConnectionPool::Lease lease;
+    PgConnection* leased = acquireConnection(Utils::isReadOnlySelect(query), replica, lease);
+    
+    // Перевод строки перед ')': запрос может заканчиваться комментарием --
+    const std::string copy = "COPY (" + Utils::stripStatementEnd(query) + "\n) TO STDOUT WITH (" + options + ")";
+    QueryWatchdog::Guard guard;
+    PgResult start;
+    if (leased) {
+        guard = watchQuery(*leased, statementTimeout_);
+        start = leased->exec(copy);
+        if (replica && errorState(start.get()) == kReadOnlyViolation) {
+            guard = QueryWatchdog::Guard();
+            start.reset();
+            leased = retryOnPrimary(replica, lease);
+            if (leased) {
+                guard = watchQuery(*leased, statementTimeout_);
+                start = leased->exec(copy);
             }
         }
     }
+    if (!leased) {
+        out.errorMessage = "No database connection available: " + pool_->lastError();
+        LOG_ERROR(out.errorMessage);
+        return out;
+    }
+    PgConnection& conn = *leased;
+    PGconn* raw = conn.raw();
+    
+    if (!start || PQresultStatus(start.get()) != PGRES_COPY_OUT) {
+        out.errorMessage = start ? PQresultErrorMessage(start.get()) : conn.lastError();
+        recordFailure(start.get());
+        LOG_ERROR("COPY export failed: ", out.errorMessage);
+        return out;
+    }
+    start.reset();
+    
+    bool stopped = false;
+    char* buffer = nullptr;
+    int size;
+    while ((size = PQgetCopyData(raw, &buffer, 0)) > 0) {
+        // После отмены данные дочитываются до ошибки сервера и отбрасываются
+        if (!stopped) {
+            out.bytes += static_cast<uint64_t>(size);
+            if (!consumer(buffer, static_cast<size_t>(size))) {
+                stopped = true;
+                streamCancels_.fetch_add(1, std::memory_order_relaxed);
+                conn.cancel();
+            }
+        }
+        PQfreemem(buffer);
+    }
     
-    return schema;
-}
\ No newline at end of file
+    bool failed = size == -2;
+    if (failed) {
+        out.errorMessage = conn.lastError();
+    }
+    while (PGresult* r = PQgetResult(raw)) {
+        PgResult res(r);
+        if (PQresultStatus(r) == PGRES_COMMAND_OK) {
+            out.rowCount = std::strtoull(PQcmdTuples(r), nullptr, 10);
+        } else if (!failed && !stopped) {
+            failed = true;
+            out.errorMessage = PQresultErrorMessage(r);
+            recordFailure(r);
+        }
+    }
+    guard = QueryWatchdog::Guard();
+    
+    if (stopped) {
+        out.errorMessage = "COPY export aborted by consumer";
+        LOG_WARNING(out.errorMessage);
+        return out;
+    }
+    if (failed) {
+        LOG_ERROR("COPY export failed: ", out.errorMessage);
+        return out;
+    }
+    
+    out.success = true;
+    LOG_INFO("COPY export finished. Rows: ", out.rowCount,
+             ", bytes: ", out.bytes);
+    return out;
+}
@@ -1,12 +1,27 @@
 #ifndef DATABASE_CONNECTOR_H
 #define DATABASE_CONNECTOR_H
 
+#include "src/core/AsyncExecutor.h"
+#include "src/core/ConnectionPool.h"
+#include "src/core/QueryResult.h"
+#include "src/core/QueryWatchdog.h"
+#include "src/core/ReplicaRouter.h"
+#include "src/core/SchemaCatalog.h"
+#include "src/utils/ShardedLruCache.h"
+#include "src/utils/SqlParser.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <string>
 #include <memory>
 #include <vector>
 #include <map>
-#include <pqxx/pqxx>
 
+class ChangeListener;
+
+// Доступ к PostgreSQL через пул соединений. executeQuery и метаданные
+// можно вызывать из нескольких потоков одновременно.
 class DatabaseConnector {
 public:
     DatabaseConnector();
@@ -20,22 +35,223 @@ public:
     void disconnect();
     bool isConnected() const;
     
-    struct QueryResult {
-        std::vector<std::string> columns;
-        std::vector<std::vector<std::string>> rows;
-        int rowCount;
-        bool success;
-        std::string errorMessage;
+    // Размеры и таймауты пула; вызывать до connect()
+    void configurePool(const ConnectionPool::Options& options);
+    ConnectionPool::Stats getPoolStats() const;
+    
+    // Реплики для чтения ("host" или "host:port"; база, пользователь и пароль
+    // как у основного сервера). На реплике выполняются только запросы,
+    // прошедшие Utils::isReadOnlySelect; если реплика всё же отказала в
+    // записи (25006), запрос повторяется на основном. Остальные запросы и все
+    // запросы при недоступных репликах - на основном. Вызывать до connect().
+    void configureReplicas(const std::vector<std::string>& hosts, const ReplicaRouter::Options& options);
+    ReplicaRouter::Stats getReplicaStats() const;
+    
+    // statement_timeout сессии (передаётся в строке подключения) и срок,
+    // после которого сторожевой поток отменяет запрос сам. 0 - без
+    // ограничения. Вызывать до connect().
+    void configureStatementTimeout(std::chrono::milliseconds timeout);
+    
+    struct TimeoutStats {
+        uint64_t statementTimeouts = 0;  // сервер прервал по statement_timeout
+        uint64_t watchdogCancels = 0;    // отменено сторожевым потоком
+        uint64_t streamCancels = 0;      // отменено по лимиту строк или потребителем
     };
+    TimeoutStats getTimeoutStats() const;
     
+    using QueryResult = ::QueryResult;
+    
+    // Литералы в позициях значений выносятся в параметры $n, и запросы
+    // одинаковой формы переиспользуют подготовленный оператор соединения.
+    // Если сервер отверг форму с параметрами из-за типа (тип $n выводится
+    // из другой стороны сравнения), запрос повторяется исходным текстом.
     QueryResult executeQuery(const std::string& query);
+    // Запрос с уже расставленными $n и их значениями
+    QueryResult executeQuery(const std::string& query, const std::vector<std::string>& params);
+    
+    // Потоковое чтение: строки приходят с сервера по одной (single-row mode)
+    // и передаются потребителю пачками, поэтому память ограничена размером
+    // пачки, а не результата. Потребитель получает columns и очередные rows
+    // (rowCount - число строк в пачке; память пачки переиспользуется после
+    // возврата); false из потребителя прерывает запрос.
+    using RowConsumer = std::function<bool(const QueryResult& batch)>;
+    
+    struct StreamOptions {
+        size_t batchRows = 1000;
+        size_t batchBytes = 4 * 1024 * 1024;  // потолок памяти под пачку
+        size_t maxRows = 0;                    // 0 - без ограничения
+        // Свой срок выполнения (SET LOCAL statement_timeout в транзакции);
+        // 0 - таймаут сессии
+        std::chrono::milliseconds timeout{0};
+    };
+    
+    struct StreamResult {
+        bool success = false;
+        size_t rowCount = 0;
+        bool truncated = false;  // достигнут maxRows, запрос отменён на сервере
+        std::string errorMessage;
+    };
+    
+    StreamResult streamQuery(const std::string& query, const RowConsumer& consumer,
+                             const StreamOptions& options);
+    
+    // Выгрузка COPY (query) TO STDOUT: данные сервера передаются потребителю
+    // кусками как есть, без разбора на строки и колонки, поэтому скорость
+    // ограничена только сетью. query - одиночный SELECT, options - параметры
+    // COPY ("FORMAT csv, HEADER"). false из потребителя прерывает выгрузку.
+    // Кэш результатов и max_result_rows не применяются.
+    using CopyConsumer = std::function<bool(const char* data, size_t size)>;
+    
+    struct CopyResult {
+        bool success = false;
+        uint64_t rowCount = 0;
+        uint64_t bytes = 0;
+        std::string errorMessage;
+    };
+    
+    CopyResult copyOut(const std::string& query, const std::string& options, const CopyConsumer& consumer);
+    
+    // Асинхронный исполнитель на конвейере libpq; connections == 0 отключает.
+    // Вызывать до connect().
+    void configureAsync(const AsyncExecutor::Options& options);
+    AsyncExecutor::Stats getAsyncStats() const;
+    
+    // Запрос без ожидания ответа: результат приходит в колбэк из потока
+    // исполнителя. Кэш результатов и подготовленные операторы не участвуют.
+    // Без исполнителя запрос выполняется сразу в вызывающем потоке.
+    void executeAsync(const std::string& query, const std::vector<std::string>& params,
+                      AsyncExecutor::Callback callback);
+    std::future<QueryResult> executeAsync(const std::string& query,
+                                          const std::vector<std::string>& params = {});
+    
+    // Кэш результатов SELECT по нормализованному тексту запроса.
+    // Работает только пока активен LISTEN: запись сбрасывается по NOTIFY
+    // от триггеров таблиц, от которых она зависит, или по истечении TTL.
+    // byteBudget == 0 отключает кэш. Вызывать до connect().
+    void configureResultCache(size_t byteBudget, size_t shardCount, int ttlSeconds);
+    void clearResultCache();
+    
+    struct ResultCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t byteBudget = 0;
+        bool listening = false;
+    };
+    ResultCacheStats getResultCacheStats() const;
+    
+    struct StatementStats {
+        uint64_t cached = 0;    // выполнено готовым оператором
+        uint64_t prepared = 0;  // подготовлено заново
+        uint64_t failed = 0;    // сервер не смог подготовить, выполнено текстом
+        uint64_t unparsed = 0;  // вне подмножества SqlParser, форма построена по тексту
+        uint64_t fallbacks = 0; // форма с параметрами отвергнута, выполнено исходным текстом
+    };
+    StatementStats getStatementStats() const;
+    
+    // Каталог схемы: загружается при connect() и обновляется по DDL-уведомлениям
+    // или раз в refreshInterval (0 - только по уведомлениям)
+    void configureSchemaCatalog(std::chrono::seconds refreshInterval);
+    // Актуальный снимок; при необходимости сначала сверяется с сервером
+    std::shared_ptr<const SchemaSnapshot> getSchemaSnapshot();
+    SchemaCatalog::Stats getSchemaStats() const;
+    
+    // Метаданные отдаются из каталога; запросы к information_schema -
+    // только если каталог загрузить не удалось
     std::vector<std::string> getTableNames();
     std::map<std::string, std::vector<std::string>> getTableSchema(const std::string& tableName);
+    // Схемы нескольких таблиц: запросы уходят одним конвейером
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>
+    getTableSchemas(const std::vector<std::string>& tableNames);
 
 private:
-    std::unique_ptr<pqxx::connection> connection_;
+    struct CachedResult {
+        std::shared_ptr<const QueryResult> result;
+        std::vector<std::string> tables;
+    };
+    
+    std::unique_ptr<ConnectionPool> pool_;
+    ConnectionPool::Options poolOptions_;
     std::string connectionString_;
     
+    std::vector<std::string> replicaHosts_;
+    ReplicaRouter::Options replicaOptions_;
+    std::unique_ptr<ReplicaRouter> replicaRouter_;
+    
+    // Соединение для запроса: читающий - с реплики, если есть исправная,
+    // иначе из основного пула. nullptr - соединение получить не удалось.
+    PgConnection* acquireConnection(bool readOnly, ReplicaRouter::Route& replica,
+                                    ConnectionPool::Lease& lease);
+    // Реплика отказала в записи (25006): освободить её и взять соединение основного
+    void releaseRejectingReplica(ReplicaRouter::Route& replica);
+    PgConnection* retryOnPrimary(ReplicaRouter::Route& replica, ConnectionPool::Lease& lease);
+    
+    AsyncExecutor::Options asyncOptions_;
+    bool asyncEnabled_ = false;
+    std::unique_ptr<AsyncExecutor> asyncExecutor_;
+    
+    std::unique_ptr<ShardedLruCache<CachedResult>> resultCache_;
+    std::unique_ptr<ChangeListener> changeListener_;
+    SchemaCatalog schemaCatalog_;
+    std::chrono::seconds resultCacheTtl_{0};
+    // Увеличивается при каждой инвалидации; результат, прочитанный до неё,
+    // в кэш не попадает
+    std::atomic<uint64_t> invalidationEpoch_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    
+    std::chrono::milliseconds statementTimeout_{0};
+    QueryWatchdog watchdog_;
+    std::atomic<uint64_t> statementTimeouts_{0};
+    std::atomic<uint64_t> streamCancels_{0};
+    
+    // Наблюдение за запросом со сроком timeout (с запасом на сеть)
+    QueryWatchdog::Guard watchQuery(PgConnection& conn, std::chrono::milliseconds timeout);
+    // Учесть ошибку выполнения: отмена по statement_timeout считается отдельно
+    void recordFailure(const PGresult* res);
+    
+    std::atomic<uint64_t> statementsCached_{0};
+    std::atomic<uint64_t> statementsPrepared_{0};
+    std::atomic<uint64_t> statementsFailed_{0};
+    std::atomic<uint64_t> statementsUnparsed_{0};
+    std::atomic<uint64_t> statementFallbacks_{0};
+    // Увеличивается при DDL: соединения освобождают подготовленные операторы
+    // перед следующей подготовкой (PgConnection::syncStatements)
+    std::atomic<uint64_t> schemaEpoch_{0};
+    
+    // Канонический текст, форма с параметрами и таблицы запроса
+    Utils::SqlShape analyzeQuery(const std::string& query);
+    // Ключ кэша (канонический текст) или пустая строка, если запрос нельзя кэшировать
+    std::string resultCacheKey(const Utils::SqlShape& shape) const;
+    void invalidateTable(const std::string& table);
+    void storeResult(const std::string& key, const std::vector<std::string>& tables,
+                     uint64_t epoch, const QueryResult& result);
+    
+    // Имя подготовленного оператора или пустая строка (выполнять текстом)
+    std::string prepareStatement(PgConnection& conn, const std::string& query, size_t paramCount);
+    
+    // fallback - исходный текст запроса, если query - его форма с параметрами:
+    // выполняется вместо неё, когда сервер отверг форму ошибкой типа.
+    // fromReplica - ответила реплика (такой результат не кэшируется)
+    QueryResult execute(const std::string& query, const std::vector<std::string>& params,
+                        const std::string& fallback = "", bool* fromReplica = nullptr);
+    // streamQuery; allowReplica == false - повтор на основном после 25006
+    StreamResult stream(const std::string& query, const RowConsumer& consumer,
+                        const StreamOptions& options, bool allowReplica);
+    // Выполнить запрос на арендованном соединении; не readOnly - в транзакции.
+    // readOnly - Utils::isReadOnlySelect: то же решение, что и для реплик
+    bool runQuery(PgConnection& conn, const std::string& query,
+                  const std::vector<std::string>& params, bool readOnly,
+                  QueryResult& result, const std::string& fallback = "");
+    // Вытеснить отвергнутый оператор формы и учесть повтор текстом
+    void fallBackToText(PgConnection& conn, const std::string& statement, const std::string& error);
+    // Оператор подготовлен до изменения таблицы (0A000): вытеснить, чтобы
+    // следующий prepare построил план заново
+    void replanStatement(PgConnection& conn, const std::string& statement, const std::string& error);
+    
     std::string buildConnectionString(const std::string& host, int port,
                                      const std::string& dbname,
                                      const std::string& user,
@@ -0,0 +1,264 @@
+#include "src/core/JsonWriter.h"
+#include "src/core/PgValue.h"
+#include "src/utils/SimdScan.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <map>
+
+namespace {
+    const char kHex[] = "0123456789abcdef";
+    const char kReplacement[] = "\xEF\xBF\xBD";  // U+FFFD
+
+    void writeEscaped(OutputSink& out, unsigned char c) {
+        switch (c) {
+            case '"':  out.write("\\\"", 2); break;
+            case '\\': out.write("\\\\", 2); break;
+            case '\b': out.write("\\b", 2); break;
+            case '\f': out.write("\\f", 2); break;
+            case '\n': out.write("\\n", 2); break;
+            case '\r': out.write("\\r", 2); break;
+            case '\t': out.write("\\t", 2); break;
+            default: {
+                const char escaped[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+                out.write(escaped, sizeof(escaped));
+            }
+        }
+    }
+
+    template <typename Integer>
+    void writeInteger(OutputSink& out, Integer value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.write(buffer, static_cast<size_t>(result.ptr - buffer));
+    }
+
+    // Формат чисел с плавающей точкой как у dump(): кратчайшая запись,
+    // NaN и бесконечности - null
+    void writeDouble(OutputSink& out, double value) {
+        if (!std::isfinite(value)) {
+            out.write("null", 4);
+            return;
+        }
+        char buffer[64];
+        char* end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.write(buffer, static_cast<size_t>(end - buffer));
+    }
+}
+
+JsonWriter::JsonWriter(OutputSink& out, Layout layout, int indent)
+    : out_(out), layout_(layout), indent_(indent) {}
+
+void JsonWriter::writeString(OutputSink& out, std::string_view text) {
+    const char* data = text.data();
+    size_t size = text.size();
+    out.put('"');
+
+    if (Utils::isValidUtf8(data, size)) {
+        // Участки без спецсимволов копируются целиком
+        while (size > 0) {
+            size_t plain = Utils::findJsonSpecial(data, size);
+            out.write(data, plain);
+            if (plain == size) break;
+            writeEscaped(out, static_cast<unsigned char>(data[plain]));
+            data += plain + 1;
+            size -= plain + 1;
+        }
+    } else {
+        size_t i = 0;
+        while (i < size) {
+            unsigned char c = static_cast<unsigned char>(data[i]);
+            if (c < 0x80) {
+                if (Utils::detail::isJsonSpecial(c)) {
+                    writeEscaped(out, c);
+                } else {
+                    out.put(static_cast<char>(c));
+                }
+                ++i;
+                continue;
+            }
+            size_t length = Utils::utf8SequenceLength(data + i, size - i);
+            if (length == 0) {
+                out.write(kReplacement, 3);
+                ++i;
+            } else {
+                out.write(data + i, length);
+                i += length;
+            }
+        }
+    }
+
+    out.put('"');
+}
+
+void JsonWriter::newline(int depth) {
+    if (indent_ < 0) return;
+    out_.put('\n');
+    out_.fill(' ', static_cast<size_t>(depth * indent_));
+}
+
+void JsonWriter::begin(const std::vector<std::string>& columns) {
+    started_ = true;
+    const char* keySeparator = indent_ < 0 ? ":" : ": ";
+
+    // Ключи строк: порядок std::map (как в объекте nlohmann::json), при
+    // повторе имени значение берётся из последней колонки
+    keys_.clear();
+    if (layout_ == Layout::Objects) {
+        std::map<std::string, size_t> order;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            order[columns[i]] = i;
+        }
+        for (const auto& [name, column] : order) {
+            StringSink key;
+            writeString(key, name);
+            key.write(keySeparator);
+            keys_.push_back(Key{column, key.take()});
+        }
+    }
+
+    out_.put('{');
+    newline(1);
+    out_.write("\"columns\"");
+    out_.write(keySeparator);
+    if (columns.empty()) {
+        out_.write("[]");
+    } else {
+        out_.put('[');
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) out_.put(',');
+            newline(2);
+            writeString(out_, columns[i]);
+        }
+        newline(1);
+        out_.put(']');
+    }
+    out_.put(',');
+    newline(1);
+    out_.write("\"data\"");
+    out_.write(keySeparator);
+    out_.put('[');
+}
+
+void JsonWriter::write(const DatabaseConnector::QueryResult& batch) {
+    if (!started_) begin(batch.columns);
+
+    const size_t rows = static_cast<size_t>(batch.rowCount);
+    const size_t columns = std::min(batch.columns.size(), batch.data.size());
+    for (size_t r = 0; r < rows; ++r) {
+        if (rowsWritten_++ > 0) out_.put(',');
+        newline(2);
+
+        if (layout_ == Layout::Objects) {
+            if (keys_.empty()) {
+                out_.write("null");  // объект без ключей так и остаётся null
+                continue;
+            }
+            out_.put('{');
+            for (size_t k = 0; k < keys_.size(); ++k) {
+                if (k > 0) out_.put(',');
+                newline(3);
+                out_.write(keys_[k].text);
+                writeValue(batch.data[keys_[k].column], r);
+            }
+            newline(2);
+            out_.put('}');
+        } else {
+            if (columns == 0) {
+                out_.write("[]");
+                continue;
+            }
+            out_.put('[');
+            for (size_t i = 0; i < columns; ++i) {
+                if (i > 0) out_.put(',');
+                newline(3);
+                writeValue(batch.data[i], r);
+            }
+            newline(2);
+            out_.put(']');
+        }
+    }
+}
+
+void JsonWriter::finish(size_t rowCount, bool truncated) {
+    if (!started_) begin({});
+    const char* keySeparator = indent_ < 0 ? ":" : ": ";
+
+    if (rowsWritten_ > 0) newline(1);
+    out_.put(']');
+
+    out_.put(',');
+    newline(1);
+    out_.write("\"rowCount\"");
+    out_.write(keySeparator);
+    writeInteger(out_, rowCount);
+
+    out_.put(',');
+    newline(1);
+    out_.write("\"success\"");
+    out_.write(keySeparator);
+    out_.write("true");
+
+    if (truncated) {
+        out_.put(',');
+        newline(1);
+        out_.write("\"truncated\"");
+        out_.write(keySeparator);
+        out_.write("true");
+    }
+
+    newline(0);
+    out_.put('}');
+}
+
+void JsonWriter::writeValue(const DatabaseConnector::QueryResult::Column& column, size_t row) {
+    if (column.isNull(row)) {
+        out_.write("\"NULL\"");
+        return;
+    }
+
+    std::string_view value = column.value(row);
+    if (column.type() == PgValue::kNumeric) {
+        // numeric хранится точным текстом: через double пропали бы разряды
+        if (PgValue::isJsonNumber(value)) {
+            out_.write(value);
+        } else {
+            writeString(out_, value);
+        }
+        return;
+    }
+    switch (PgValue::kindOf(column.type())) {
+        case PgValue::Kind::Integer: {
+            int64_t integer;
+            if (PgValue::toInt64(column.type(), column.native(), value, integer)) {
+                writeInteger(out_, integer);
+                return;
+            }
+            break;
+        }
+        case PgValue::Kind::Float: {
+            double number;
+            if (PgValue::toDouble(column.type(), column.native(), value, number)) {
+                writeDouble(out_, number);
+                return;
+            }
+            break;
+        }
+        case PgValue::Kind::Bool: {
+            bool flag;
+            if (PgValue::toBool(column.native(), value, flag)) {
+                out_.write(flag ? "true" : "false");
+                return;
+            }
+            break;
+        }
+        case PgValue::Kind::Text:
+            break;
+    }
+
+    if (column.native()) {
+        writeString(out_, column.text(row));
+    } else {
+        writeString(out_, value);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "src/core/ResponseParser.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Потоковый вывод результата в JSON без построения DOM. Ключи и отступы
+// экранируются и готовятся один раз на результат, строки экранируются
+// поблочно (Utils::findJsonSpecial), значения пишутся прямо в приёмник.
+//
+// Layout::Objects повторяет toJSON(result).dump(2) байт в байт: объект на
+// строку с ключами в порядке сортировки, NULL - строкой "NULL", числа и
+// логические значения - JSON-типами. Исключение - numeric: здесь его точный
+// текст пишется числом JSON (NaN и бесконечности - строкой), а toJSON
+// делает строкой значение, не представимое в int64/double тем же текстом.
+// Layout::Arrays - компактный вид:
+// columns и data массивами значений в порядке колонок.
+// Некорректный UTF-8 заменяется на U+FFFD (nlohmann::json бросал исключение).
+class JsonWriter : public ResultWriter {
+public:
+    enum class Layout { Objects, Arrays };
+
+    // indent < 0 - без переводов строк и пробелов, как dump(-1)
+    explicit JsonWriter(OutputSink& out, Layout layout = Layout::Objects, int indent = 2);
+
+    void write(const DatabaseConnector::QueryResult& batch) override;
+    void finish(size_t rowCount, bool truncated) override;
+
+    // Строка в кавычках с экранированием
+    static void writeString(OutputSink& out, std::string_view text);
+
+private:
+    struct Key {
+        size_t column;
+        std::string text;  // "имя": - уже экранировано
+    };
+
+    void begin(const std::vector<std::string>& columns);
+    void newline(int depth);
+    void writeValue(const DatabaseConnector::QueryResult::Column& column, size_t row);
+
+    OutputSink& out_;
+    Layout layout_;
+    int indent_;
+    bool started_ = false;
+    size_t rowsWritten_ = 0;
+    std::vector<Key> keys_;
+};
+
+#endif // JSON_WRITER_H
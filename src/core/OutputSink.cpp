@@ -0,0 +1,98 @@
+#include "src/core/OutputSink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// OutputSink
+
+OutputSink::OutputSink(size_t capacity)
+    : buffer_(new char[std::max<size_t>(capacity, 256)]), capacity_(std::max<size_t>(capacity, 256)) {}
+
+void OutputSink::write(const char* data, size_t size) {
+    if (size > capacity_ - used_) {
+        drainBuffer();
+        // Крупный кусок уходит напрямую, минуя буфер
+        if (size >= capacity_) {
+            if (!failed_ && !drain(data, size)) failed_ = true;
+            written_ += size;
+            return;
+        }
+    }
+    std::memcpy(buffer_.get() + used_, data, size);
+    used_ += size;
+}
+
+void OutputSink::fill(char c, size_t count) {
+    while (count > 0) {
+        if (used_ == capacity_) drainBuffer();
+        size_t chunk = std::min(count, capacity_ - used_);
+        std::memset(buffer_.get() + used_, c, chunk);
+        used_ += chunk;
+        count -= chunk;
+    }
+}
+
+char* OutputSink::reserve(size_t size) {
+    if (size > capacity_ - used_) drainBuffer();
+    return buffer_.get() + used_;
+}
+
+bool OutputSink::flush() {
+    drainBuffer();
+    return !failed_;
+}
+
+void OutputSink::drainBuffer() {
+    if (used_ > 0 && !failed_ && !drain(buffer_.get(), used_)) {
+        failed_ = true;
+    }
+    written_ += used_;
+    used_ = 0;
+}
+
+// ---------------------------------------------------------------------------
+// StringSink
+
+std::string StringSink::take() {
+    flush();
+    std::string out;
+    out.swap(text_);
+    return out;
+}
+
+bool StringSink::drain(const char* data, size_t size) {
+    text_.append(data, size);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// FdSink / SocketSink
+
+bool FdSink::drain(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool SocketSink::drain(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd_, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Приёмник вывода форматтеров. Данные копятся в собственном буфере и
+// уходят в назначение пачками по capacity байт, поэтому форматтер пишет
+// мелкими кусками без промежуточных строк, а вывод начинается до того,
+// как отформатирована последняя строка. Буфер переиспользуется между
+// результатами. Ошибка записи запоминается: дальнейший вывод
+// отбрасывается, good() возвращает false.
+class OutputSink {
+public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+    virtual ~OutputSink() = default;
+
+    void write(const char* data, size_t size);
+    void write(std::string_view text) { write(text.data(), text.size()); }
+    void put(char c) {
+        if (used_ == capacity_) drainBuffer();
+        buffer_[used_++] = c;
+    }
+    // count повторений символа (выравнивание, рамки таблиц)
+    void fill(char c, size_t count);
+
+    // Непрерывное место под запись size байт (size <= capacity()) прямо в
+    // буфер; записанное фиксируется commit
+    char* reserve(size_t size);
+    void commit(size_t size) { used_ += size; }
+
+    // Отдать накопленное в назначение
+    bool flush();
+    bool good() const { return !failed_; }
+    size_t capacity() const { return capacity_; }
+    uint64_t bytesWritten() const { return written_ + used_; }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+protected:
+    explicit OutputSink(size_t capacity = kDefaultCapacity);
+
+    // Записать данные целиком; false - назначение недоступно
+    virtual bool drain(const char* data, size_t size) = 0;
+
+private:
+    void drainBuffer();
+
+    std::unique_ptr<char[]> buffer_;
+    size_t capacity_;
+    size_t used_ = 0;
+    uint64_t written_ = 0;
+    bool failed_ = false;
+};
+
+// Вывод в строку (formatResponse и другие строковые обёртки)
+class StringSink : public OutputSink {
+public:
+    explicit StringSink(size_t capacity = 16 * 1024) : OutputSink(capacity) {}
+    ~StringSink() override = default;
+
+    // Весь вывод; приёмник после этого пуст
+    std::string take();
+
+protected:
+    bool drain(const char* data, size_t size) override;
+
+private:
+    std::string text_;
+};
+
+// Вывод в файловый дескриптор (stdout, файл, канал)
+class FdSink : public OutputSink {
+public:
+    explicit FdSink(int fd, size_t capacity = kDefaultCapacity) : OutputSink(capacity), fd_(fd) {}
+    ~FdSink() override { flush(); }
+
+protected:
+    bool drain(const char* data, size_t size) override;
+
+    int fd_;
+};
+
+// Вывод в сокет: send без SIGPIPE, закрытое соединение - ошибка записи
+class SocketSink : public FdSink {
+public:
+    explicit SocketSink(int fd, size_t capacity = kDefaultCapacity) : FdSink(fd, capacity) {}
+    ~SocketSink() override { flush(); }
+
+protected:
+    bool drain(const char* data, size_t size) override;
+};
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,158 @@
+#include "src/core/PgConnection.h"
+#include "src/core/PgValue.h"
+
+namespace {
+    std::vector<const char*> paramPointers(const std::vector<std::string>& params) {
+        std::vector<const char*> values;
+        values.reserve(params.size());
+        for (const auto& p : params) {
+            values.push_back(p.c_str());
+        }
+        return values;
+    }
+}
+
+PgConnection::PgConnection(const std::string& connectionString)
+    : conn_(PQconnectdb(connectionString.c_str())),
+      lastUsed_(Clock::now()) {}
+
+PgConnection::~PgConnection() {
+    if (conn_) {
+        PQfinish(conn_);
+    }
+}
+
+bool PgConnection::isOpen() const {
+    return conn_ && PQstatus(conn_) == CONNECTION_OK;
+}
+
+bool PgConnection::reset() {
+    if (!conn_) return false;
+    PQreset(conn_);
+    // Подготовленные операторы живут в серверной сессии и после сброса пропадают
+    forgetStatements();
+    return isOpen();
+}
+
+bool PgConnection::ping() {
+    if (!isOpen()) return false;
+    PgResult res(PQexec(conn_, ""));
+    return res && PQresultStatus(res.get()) == PGRES_EMPTY_QUERY;
+}
+
+bool PgConnection::cancel() {
+    PgCancel handle = cancelHandle();
+    if (!handle) return false;
+    char error[256];
+    return PQcancel(handle.get(), error, sizeof(error)) == 1;
+}
+
+PgCancel PgConnection::cancelHandle() const {
+    return PgCancel(conn_ ? PQgetCancel(conn_) : nullptr);
+}
+
+PgResult PgConnection::exec(const char* sql) {
+    touch();
+    return PgResult(PQexec(conn_, sql));
+}
+
+bool PgConnection::command(const char* sql) {
+    PgResult res = exec(sql);
+    return res && PQresultStatus(res.get()) == PGRES_COMMAND_OK;
+}
+
+std::string PgConnection::lastError() const {
+    return conn_ ? PQerrorMessage(conn_) : "connection is not allocated";
+}
+
+std::string PgConnection::prepare(const std::string& sql, int paramCount, PrepareOutcome& outcome) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        statementLru_.splice(statementLru_.begin(), statementLru_, it->second);
+        outcome = it->second->name.empty() ? PrepareOutcome::Failed : PrepareOutcome::Cached;
+        return it->second->name;
+    }
+    
+    if (statementCapacity_ == 0) {
+        outcome = PrepareOutcome::Failed;
+        return "";
+    }
+    
+    while (statements_.size() >= statementCapacity_ && !statementLru_.empty()) {
+        const Statement& victim = statementLru_.back();
+        if (!victim.name.empty()) {
+            command(("DEALLOCATE " + victim.name).c_str());
+            binaryStatements_.erase(victim.name);
+        }
+        statements_.erase(victim.sql);
+        statementLru_.pop_back();
+    }
+    
+    std::string name = "s" + std::to_string(nextStatementId_++);
+    touch();
+    PgResult res(PQprepare(conn_, name.c_str(), sql.c_str(), paramCount, nullptr));
+    if (!res || PQresultStatus(res.get()) != PGRES_COMMAND_OK) {
+        name.clear();
+    } else if (binaryResults_ && binaryOutput(name)) {
+        binaryStatements_.insert(name);
+    }
+    
+    statementLru_.push_front(Statement{sql, name});
+    statements_[sql] = statementLru_.begin();
+    outcome = name.empty() ? PrepareOutcome::Failed : PrepareOutcome::Prepared;
+    return name;
+}
+
+void PgConnection::evictStatement(const std::string& sql) {
+    auto it = statements_.find(sql);
+    if (it == statements_.end()) return;
+    const Statement& victim = *it->second;
+    if (!victim.name.empty()) {
+        command(("DEALLOCATE " + victim.name).c_str());
+        binaryStatements_.erase(victim.name);
+    }
+    statementLru_.erase(it->second);
+    statements_.erase(it);
+}
+
+void PgConnection::syncStatements(uint64_t schemaEpoch) {
+    if (schemaEpoch == schemaEpoch_) return;
+    schemaEpoch_ = schemaEpoch;
+    if (statements_.empty()) return;
+    command("DEALLOCATE ALL");
+    forgetStatements();
+}
+
+PgResult PgConnection::execPrepared(const std::string& name, const std::vector<std::string>& params) {
+    touch();
+    auto values = paramPointers(params);
+    return PgResult(PQexecPrepared(conn_, name.c_str(), static_cast<int>(values.size()),
+                                   values.data(), nullptr, nullptr, resultFormat(name)));
+}
+
+PgResult PgConnection::execParams(const std::string& sql, const std::vector<std::string>& params) {
+    touch();
+    auto values = paramPointers(params);
+    return PgResult(PQexecParams(conn_, sql.c_str(), static_cast<int>(values.size()),
+                                 nullptr, values.data(), nullptr, nullptr, 0));
+}
+
+bool PgConnection::binaryOutput(const std::string& name) {
+    PgResult description(PQdescribePrepared(conn_, name.c_str()));
+    if (!description || PQresultStatus(description.get()) != PGRES_COMMAND_OK) {
+        return false;
+    }
+    int columns = PQnfields(description.get());
+    for (int i = 0; i < columns; ++i) {
+        if (!PgValue::hasBinaryDecoder(PQftype(description.get(), i))) {
+            return false;
+        }
+    }
+    return columns > 0;
+}
+
+void PgConnection::forgetStatements() {
+    statements_.clear();
+    statementLru_.clear();
+    binaryStatements_.clear();
+}
@@ -0,0 +1,106 @@
+#ifndef PG_CONNECTION_H
+#define PG_CONNECTION_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <libpq-fe.h>
+
+struct PgResultDeleter {
+    void operator()(PGresult* res) const { PQclear(res); }
+};
+using PgResult = std::unique_ptr<PGresult, PgResultDeleter>;
+
+struct PgCancelDeleter {
+    void operator()(PGcancel* cancel) const { PQfreeCancel(cancel); }
+};
+using PgCancel = std::unique_ptr<PGcancel, PgCancelDeleter>;
+
+// Владеющая обёртка над PGconn. Исключений не бросает: состояние
+// проверяется через isOpen(), текст ошибки - через lastError().
+class PgConnection {
+public:
+    explicit PgConnection(const std::string& connectionString);
+    ~PgConnection();
+
+    bool isOpen() const;
+    // Переподключение с теми же параметрами (PQreset)
+    bool reset();
+    // Пустой запрос до сервера и обратно: соединение действительно живо
+    bool ping();
+    // Запросить отмену выполняющегося запроса (PQcancel) из потока-владельца
+    bool cancel();
+    // Данные для отмены из другого потока: создаются в потоке-владельце
+    // (PQgetCancel читает PGconn), PQcancel по ним не трогает соединение
+    PgCancel cancelHandle() const;
+
+    PgResult exec(const char* sql);
+    PgResult exec(const std::string& sql) { return exec(sql.c_str()); }
+    // Выполнить команду, не возвращающую строк; false при ошибке
+    bool command(const char* sql);
+    
+    // Кэш подготовленных операторов: LRU по тексту запроса с $n.
+    // capacity == 0 отключает подготовку.
+    void setStatementCacheCapacity(size_t capacity) { statementCapacity_ = capacity; }
+    // Запрашивать результат подготовленных операторов в бинарном формате,
+    // если у всех колонок есть декодер (PgValue::hasBinaryDecoder)
+    void setBinaryResults(bool enabled) { binaryResults_ = enabled; }
+    
+    enum class PrepareOutcome { Cached, Prepared, Failed };
+    // Имя серверного оператора для sql; при промахе выполняет PQprepare
+    // (вне транзакции: неудача не прерывает последующие команды) и при
+    // переполнении освобождает самый старый оператор. Пустая строка, если
+    // оператор подготовить нельзя - такой результат тоже запоминается.
+    std::string prepare(const std::string& sql, int paramCount, PrepareOutcome& outcome);
+    PgResult execPrepared(const std::string& name, const std::vector<std::string>& params);
+    // Забыть оператор для sql (DEALLOCATE на сервере): следующий prepare
+    // подготовит его заново
+    void evictStatement(const std::string& sql);
+    // Версия схемы, для которой подготовлены операторы. При расхождении все
+    // они освобождаются (DEALLOCATE ALL): после DDL сервер отвергает их план
+    // (0A000), а решение о бинарном формате могло устареть
+    void syncStatements(uint64_t schemaEpoch);
+    // Формат результата оператора для PQsendQueryPrepared: 1 - бинарный
+    int resultFormat(const std::string& name) const { return binaryStatements_.count(name) ? 1 : 0; }
+    // Выполнить запрос с параметрами $n без подготовки
+    PgResult execParams(const std::string& sql, const std::vector<std::string>& params);
+
+    std::string lastError() const;
+    PGconn* raw() const { return conn_; }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastUsed() const { return lastUsed_; }
+    void touch() { lastUsed_ = Clock::now(); }
+
+    PgConnection(const PgConnection&) = delete;
+    PgConnection& operator=(const PgConnection&) = delete;
+
+private:
+    struct Statement {
+        std::string sql;
+        std::string name;  // пустое - сервер отказался готовить
+    };
+    
+    void forgetStatements();
+    
+    PGconn* conn_;
+    Clock::time_point lastUsed_;
+    
+    // Бинарный результат, если все колонки оператора декодируемы
+    bool binaryOutput(const std::string& name);
+    
+    size_t statementCapacity_ = 0;
+    bool binaryResults_ = false;
+    std::unordered_set<std::string> binaryStatements_;
+    uint64_t nextStatementId_ = 0;
+    uint64_t schemaEpoch_ = 0;
+    std::list<Statement> statementLru_;
+    std::unordered_map<std::string, std::list<Statement>::iterator> statements_;
+};
+
+#endif // PG_CONNECTION_H
@@ -0,0 +1,385 @@
+#include "src/core/PgValue.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+    // Эпоха PostgreSQL 2000-01-01 как юлианский день
+    constexpr int kPostgresEpochJdate = 2451545;
+    constexpr int64_t kUsecsPerDay = INT64_C(86400000000);
+
+    constexpr uint16_t kNumericPos = 0x0000;
+    constexpr uint16_t kNumericNeg = 0x4000;
+    constexpr uint16_t kNumericNan = 0xC000;
+    constexpr uint16_t kNumericPinf = 0xD000;
+    constexpr uint16_t kNumericNinf = 0xF000;
+
+    uint16_t readUint16(const char* p) {
+        const auto* b = reinterpret_cast<const unsigned char*>(p);
+        return static_cast<uint16_t>((b[0] << 8) | b[1]);
+    }
+
+    uint32_t readUint32(const char* p) {
+        const auto* b = reinterpret_cast<const unsigned char*>(p);
+        return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+    }
+
+    uint64_t readUint64(const char* p) {
+        return (uint64_t(readUint32(p)) << 32) | readUint32(p + 4);
+    }
+
+    template <typename T>
+    void appendNative(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T loadNative(std::string_view native) {
+        T value{};
+        std::memcpy(&value, native.data(), std::min(sizeof(T), native.size()));
+        return value;
+    }
+
+    // numeric_send: ndigits, weight, sign, dscale и цифры по основанию 10000
+    bool decodeNumeric(const char* data, size_t length, std::string& out) {
+        if (length < 8) return false;
+        int ndigits = static_cast<int16_t>(readUint16(data));
+        int weight = static_cast<int16_t>(readUint16(data + 2));
+        uint16_t sign = readUint16(data + 4);
+        int dscale = static_cast<int16_t>(readUint16(data + 6));
+        if (ndigits < 0 || dscale < 0 || length < 8 + static_cast<size_t>(ndigits) * 2) return false;
+
+        if (sign == kNumericNan) { out = "NaN"; return true; }
+        if (sign == kNumericPinf) { out = "Infinity"; return true; }
+        if (sign == kNumericNinf) { out = "-Infinity"; return true; }
+        if (sign != kNumericPos && sign != kNumericNeg) return false;
+
+        std::vector<int> digits(ndigits);
+        for (int i = 0; i < ndigits; ++i) {
+            digits[i] = static_cast<int16_t>(readUint16(data + 8 + i * 2));
+        }
+        auto digitAt = [&](int index) { return index >= 0 && index < ndigits ? digits[index] : 0; };
+
+        out.clear();
+        if (sign == kNumericNeg) out += '-';
+
+        char group[8];
+        if (weight < 0) {
+            out += '0';
+        } else {
+            for (int d = 0; d <= weight; ++d) {
+                int value = digitAt(d);
+                if (d == 0) {
+                    out += std::to_string(value);
+                } else {
+                    std::snprintf(group, sizeof(group), "%04d", value);
+                    out += group;
+                }
+            }
+        }
+
+        if (dscale > 0) {
+            out += '.';
+            size_t fractionStart = out.size();
+            for (int d = weight + 1; static_cast<int>(out.size() - fractionStart) < dscale; ++d) {
+                std::snprintf(group, sizeof(group), "%04d", digitAt(d));
+                out += group;
+            }
+            out.resize(fractionStart + dscale);
+        }
+        return true;
+    }
+
+    // j2date из src/backend/utils/adt/datetime.c
+    void julianToDate(int jd, int& year, int& month, int& day) {
+        unsigned int julian = static_cast<unsigned int>(jd) + 32044;
+        unsigned int quad = julian / 146097;
+        unsigned int extra = (julian - quad * 146097) * 4 + 3;
+        julian += 60 + quad * 3 + extra / 146097;
+        quad = julian / 1461;
+        julian -= quad * 1461;
+        int y = static_cast<int>(julian * 4 / 1461);
+        julian = ((y != 0) ? ((julian + 305) % 365) : ((julian + 306) % 366)) + 123;
+        y += static_cast<int>(quad * 4);
+        year = y - 4800;
+        quad = julian * 2141 / 65536;
+        day = static_cast<int>(julian - 7834 * quad / 256);
+        month = static_cast<int>((quad + 10) % 12 + 1);
+    }
+
+    // Дата в стиле ISO; годы до нашей эры - с суффиксом BC
+    void appendDate(std::string& out, int days, bool& bc) {
+        int year, month, day;
+        julianToDate(days + kPostgresEpochJdate, year, month, day);
+        bc = year <= 0;
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", bc ? 1 - year : year, month, day);
+        out += buf;
+    }
+
+    std::string formatDate(int32_t days) {
+        if (days == std::numeric_limits<int32_t>::min()) return "-infinity";
+        if (days == std::numeric_limits<int32_t>::max()) return "infinity";
+        std::string out;
+        bool bc = false;
+        appendDate(out, days, bc);
+        if (bc) out += " BC";
+        return out;
+    }
+
+    std::string formatTimestamp(int64_t usecs) {
+        if (usecs == std::numeric_limits<int64_t>::min()) return "-infinity";
+        if (usecs == std::numeric_limits<int64_t>::max()) return "infinity";
+
+        int64_t days = usecs / kUsecsPerDay;
+        int64_t time = usecs % kUsecsPerDay;
+        if (time < 0) {
+            time += kUsecsPerDay;
+            days--;
+        }
+
+        std::string out;
+        bool bc = false;
+        appendDate(out, static_cast<int>(days), bc);
+
+        int64_t seconds = time / 1000000;
+        int fraction = static_cast<int>(time % 1000000);
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), " %02d:%02d:%02d", static_cast<int>(seconds / 3600),
+                      static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+        out += buf;
+        if (fraction != 0) {
+            std::snprintf(buf, sizeof(buf), ".%06d", fraction);
+            std::string digits(buf);
+            digits.erase(digits.find_last_not_of('0') + 1);
+            out += digits;
+        }
+        if (bc) out += " BC";
+        return out;
+    }
+
+    // Кратчайшая точная запись, как float8out/float4out: фиксированная точка
+    // при показателе в [-4, maxFixedExponent), иначе экспоненциальная
+    template <typename T>
+    std::string formatFloat(T value, int maxFixedExponent) {
+        if (std::isnan(value)) return "NaN";
+        if (std::isinf(value)) return value > 0 ? "Infinity" : "-Infinity";
+
+        char buf[64];
+        auto res = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::scientific);
+        std::string scientific(buf, res.ptr);
+
+        size_t e = scientific.find('e');
+        int exponent = std::atoi(scientific.c_str() + e + 1);
+        if (exponent < -4 || exponent >= maxFixedExponent) {
+            return scientific;
+        }
+
+        bool negative = scientific[0] == '-';
+        std::string digits;
+        for (size_t i = negative ? 1 : 0; i < e; ++i) {
+            if (scientific[i] != '.') digits += scientific[i];
+        }
+
+        std::string out = negative ? "-" : "";
+        if (exponent < 0) {
+            out += "0.";
+            out.append(static_cast<size_t>(-exponent - 1), '0');
+            out += digits;
+        } else {
+            size_t integerDigits = static_cast<size_t>(exponent) + 1;
+            if (digits.size() <= integerDigits) {
+                out += digits;
+                out.append(integerDigits - digits.size(), '0');
+            } else {
+                out += digits.substr(0, integerDigits);
+                out += '.';
+                out += digits.substr(integerDigits);
+            }
+        }
+        return out;
+    }
+
+    bool parseDouble(std::string_view text, double& out) {
+        auto res = std::from_chars(text.data(), text.data() + text.size(), out);
+        return res.ec == std::errc() && res.ptr == text.data() + text.size() && std::isfinite(out);
+    }
+}
+
+namespace PgValue {
+
+Kind kindOf(Oid type) {
+    switch (type) {
+        case kInt2:
+        case kInt4:
+        case kInt8:
+            return Kind::Integer;
+        case kFloat4:
+        case kFloat8:
+        case kNumeric:
+            return Kind::Float;
+        case kBool:
+            return Kind::Bool;
+        default:
+            return Kind::Text;
+    }
+}
+
+bool hasBinaryDecoder(Oid type) {
+    switch (type) {
+        case kBool:
+        case kInt2:
+        case kInt4:
+        case kInt8:
+        case kFloat4:
+        case kFloat8:
+        case kNumeric:
+        case kDate:
+        case kTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool decodeBinary(Oid type, const char* data, size_t length, std::string& out) {
+    out.clear();
+    switch (type) {
+        case kBool:
+            if (length != 1) return false;
+            out.push_back(data[0] ? 1 : 0);
+            return true;
+        case kInt2:
+            if (length != 2) return false;
+            appendNative(out, static_cast<int16_t>(readUint16(data)));
+            return true;
+        case kInt4:
+        case kDate:
+            if (length != 4) return false;
+            appendNative(out, static_cast<int32_t>(readUint32(data)));
+            return true;
+        case kInt8:
+        case kTimestamp:
+            if (length != 8) return false;
+            appendNative(out, static_cast<int64_t>(readUint64(data)));
+            return true;
+        case kFloat4: {
+            if (length != 4) return false;
+            uint32_t bits = readUint32(data);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            appendNative(out, value);
+            return true;
+        }
+        case kFloat8: {
+            if (length != 8) return false;
+            uint64_t bits = readUint64(data);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            appendNative(out, value);
+            return true;
+        }
+        case kNumeric:
+            return decodeNumeric(data, length, out);
+        default:
+            return false;
+    }
+}
+
+std::string formatNative(Oid type, std::string_view native) {
+    switch (type) {
+        case kBool:
+            return !native.empty() && native[0] ? "t" : "f";
+        case kInt2:
+            return std::to_string(loadNative<int16_t>(native));
+        case kInt4:
+            return std::to_string(loadNative<int32_t>(native));
+        case kInt8:
+            return std::to_string(loadNative<int64_t>(native));
+        case kFloat4:
+            return formatFloat(loadNative<float>(native), 6);
+        case kFloat8:
+            return formatFloat(loadNative<double>(native), 15);
+        case kDate:
+            return formatDate(loadNative<int32_t>(native));
+        case kTimestamp:
+            return formatTimestamp(loadNative<int64_t>(native));
+        default:
+            return std::string(native);
+    }
+}
+
+bool toInt64(Oid type, bool native, std::string_view value, int64_t& out) {
+    if (native) {
+        switch (type) {
+            case kInt2: out = loadNative<int16_t>(value); return true;
+            case kInt4: out = loadNative<int32_t>(value); return true;
+            case kInt8: out = loadNative<int64_t>(value); return true;
+            default: return false;
+        }
+    }
+    auto res = std::from_chars(value.data(), value.data() + value.size(), out);
+    return res.ec == std::errc() && res.ptr == value.data() + value.size();
+}
+
+bool toDouble(Oid type, bool native, std::string_view value, double& out) {
+    if (native) {
+        switch (type) {
+            case kFloat4: out = loadNative<float>(value); return std::isfinite(out);
+            case kFloat8: out = loadNative<double>(value); return std::isfinite(out);
+            case kNumeric: return parseDouble(value, out);  // numeric хранится текстом
+            default: {
+                int64_t integer;
+                if (!toInt64(type, native, value, integer)) return false;
+                out = static_cast<double>(integer);
+                return true;
+            }
+        }
+    }
+    return parseDouble(value, out);
+}
+
+bool isJsonNumber(std::string_view text) {
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+    size_t i = 0;
+    auto digits = [&]() {
+        size_t start = i;
+        while (i < text.size() && isDigit(text[i])) ++i;
+        return i > start;
+    };
+
+    if (i < text.size() && text[i] == '-') ++i;
+    // Целая часть без ведущих нулей
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (!digits()) return false;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) ++i;
+        if (!digits()) return false;
+    }
+    return i == text.size();
+}
+
+bool toBool(bool native, std::string_view value, bool& out) {
+    if (native) {
+        out = !value.empty() && value[0];
+        return true;
+    }
+    if (value == "t") { out = true; return true; }
+    if (value == "f") { out = false; return true; }
+    return false;
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef PG_VALUE_H
+#define PG_VALUE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <libpq-fe.h>
+
+// Декодирование значений PostgreSQL из бинарного формата результата.
+// Поддержанные типы хранятся в QueryResult в машинном виде (целые, float,
+// дни/микросекунды от 2000-01-01), numeric - сразу текстом. Текст для вывода
+// строится только по запросу и совпадает с тем, что вернул бы сервер
+// (DateStyle ISO, extra_float_digits по умолчанию).
+namespace PgValue {
+    // OID встроенных типов (pg_type.h)
+    constexpr Oid kBool = 16;
+    constexpr Oid kInt8 = 20;
+    constexpr Oid kInt2 = 21;
+    constexpr Oid kInt4 = 23;
+    constexpr Oid kFloat4 = 700;
+    constexpr Oid kFloat8 = 701;
+    constexpr Oid kDate = 1082;
+    constexpr Oid kTimestamp = 1114;
+    constexpr Oid kNumeric = 1700;
+
+    enum class Kind { Text, Integer, Float, Bool };
+
+    // Как значение типа выглядит в JSON
+    Kind kindOf(Oid type);
+    // Есть ли для типа декодер бинарного формата
+    bool hasBinaryDecoder(Oid type);
+
+    // Бинарное значение с сервера -> машинное представление в out;
+    // false, если данные повреждены
+    bool decodeBinary(Oid type, const char* data, size_t length, std::string& out);
+    // Машинное представление -> текст в формате сервера
+    std::string formatNative(Oid type, std::string_view native);
+
+    // Числовое значение ячейки (машинной или текстовой); false, если не число
+    bool toInt64(Oid type, bool native, std::string_view value, int64_t& out);
+    bool toDouble(Oid type, bool native, std::string_view value, double& out);
+    bool toBool(bool native, std::string_view value, bool& out);
+
+    // Текст numeric можно вывести числом JSON как есть, без перевода в double
+    // (и потери разрядов); NaN и бесконечности - нет
+    bool isJsonNumber(std::string_view text);
+}
+
+#endif // PG_VALUE_H
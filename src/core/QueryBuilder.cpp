@@ -1,9 +1,10 @@
 #include "src/core/QueryBuilder.h"
 #include "src/utils/Logger.h"
+#include "src/utils/PatternMatcher.h"
+#include "src/utils/SqlLexer.h"
 #include "src/utils/Utilities.h"
 #include <sstream>
 #include <algorithm>
-#include <regex>
 
 QueryBuilder::QueryBuilder() : limitCount_(-1) {}
 
@@ -48,7 +49,7 @@ std::string QueryBuilder::build() const {
     
     // FROM
     if (fromTable_.empty()) {
-        Logger::getInstance().error("Table name is required");
+        LOG_ERROR("Table name is required");
         return "";
     }
     sql << " FROM " << fromTable_;
@@ -79,47 +80,111 @@ void QueryBuilder::reset() {
     limitCount_ = -1;
 }
 
-bool QueryBuilder::validateSQL(const std::string& sql) const {
-    std::string lower = Utils::toLower(sql);
-    
-    // Проверка на опасные команды
-    std::vector<std::string> dangerousKeywords = {
-        "drop", "truncate", "alter", "create", "grant", "revoke"
+namespace {
+    // Команды, которые агент не выполняет: изменение схемы и прав,
+    // выполнение подготовленных операторов, анонимные блоки и процедуры
+    // (тело DO - строка, её содержимое лексемами не проверяется)
+    constexpr std::string_view kDangerousWords[] = {
+        "drop", "truncate", "alter", "create", "grant", "revoke", "exec", "execute", "do", "call"
     };
-    
-    for (const auto& keyword : dangerousKeywords) {
-        if (lower.find(keyword) != std::string::npos) {
-            Logger::getInstance().warning("Dangerous keyword detected: " + keyword);
-            return false;
+    constexpr Utils::KeywordSet kDangerous(kDangerousWords);
+    static_assert(kDangerous.perfect(), "keyword hash collision: adjust KeywordSet::hash");
+
+    // Функции, выполняющие SQL из строкового аргумента: query_to_xml*,
+    // dblink* (dblink_exec, dblink_open, ...)
+    constexpr std::string_view kDynamicSqlPrefixes[] = {"query_to_xml", "dblink"};
+
+    bool isDynamicSqlFunction(std::string_view word) {
+        for (std::string_view prefix : kDynamicSqlPrefixes) {
+            if (word.size() >= prefix.size() &&
+                std::equal(prefix.begin(), prefix.end(), word.begin(), [](char p, char w) {
+                    return p == std::tolower(static_cast<unsigned char>(w));
+                })) {
+                return true;
+            }
         }
-    }
-    
-    // Проверка на SQL injection паттерны
-    std::regex injectionPattern(R"((;|\-\-|\/\*|\*\/|xp_|sp_|exec|execute))");
-    if (std::regex_search(lower, injectionPattern)) {
-        Logger::getInstance().warning("Potential SQL injection detected");
         return false;
     }
-    
+}
+
+bool QueryBuilder::validateSQL(const std::string& sql) const {
+    // Проверяются лексемы, а не подстроки: created_at, executed и
+    // 'drop' в строковом литерале не считаются опасными. Литерал может
+    // выполниться только через DO или функции динамического SQL - они
+    // запрещены сами
+    Utils::SqlLexer lexer(sql);
+    for (Utils::SqlToken token = lexer.next(); token.kind != Utils::SqlTokenKind::End; token = lexer.next()) {
+        switch (token.kind) {
+            case Utils::SqlTokenKind::Word:
+                if (kDangerous.contains(lexer.text(token))) {
+                    LOG_WARNING("Dangerous keyword detected: ", lexer.text(token));
+                    return false;
+                }
+                if (isDynamicSqlFunction(lexer.text(token))) {
+                    LOG_WARNING("Dynamic SQL function detected: ", lexer.text(token));
+                    return false;
+                }
+                break;
+            case Utils::SqlTokenKind::Semicolon:
+                // Допускается только завершающая ';'
+                if (lexer.next().kind != Utils::SqlTokenKind::End) {
+                    LOG_WARNING("Potential SQL injection detected: multiple statements");
+                    return false;
+                }
+                return true;
+            case Utils::SqlTokenKind::Comment:
+                LOG_WARNING("Potential SQL injection detected: comment");
+                return false;
+            case Utils::SqlTokenKind::Error:
+                LOG_WARNING("SQL validation failed: unterminated literal or comment");
+                return false;
+            default:
+                break;
+        }
+    }
     return true;
 }
 
+namespace {
+    // Фрагменты, которые sanitize вырезает из имён таблиц и колонок
+    const PatternMatcher& injectionPatterns() {
+        static const PatternMatcher matcher({";", "'", "\"", "--", "/*", "*/"});
+        return matcher;
+    }
+
+    const PatternMatcher& dangerousKeywords() {
+        static const PatternMatcher matcher({
+            "drop", "delete", "truncate", "alter", "create", "insert", "update"
+        });
+        return matcher;
+    }
+}
+
 std::string QueryBuilder::sanitize(const std::string& input) const {
-    std::string result = input;
-    
-    // Удаление опасных символов
-    result.erase(std::remove(result.begin(), result.end(), ';'), result.end());
-    result.erase(std::remove(result.begin(), result.end(), '\''), result.end());
-    result.erase(std::remove(result.begin(), result.end(), '\"'), result.end());
+    // Все вхождения находятся за один проход; перекрывающиеся ("/*/")
+    // объединяются, промежутки между ними копируются как есть
+    std::string result;
+    result.reserve(input.size());
+    size_t copied = 0;
+    injectionPatterns().scan(input, [&](const PatternMatcher::Match& m) {
+        if (m.offset > copied) {
+            result.append(input, copied, m.offset - copied);
+        }
+        copied = std::max(copied, m.offset + m.length);
+        return true;
+    });
+    if (copied < input.size()) {
+        result.append(input, copied, std::string::npos);
+    }
     
     return Utils::trim(result);
 }
 
 bool QueryBuilder::isDangerousKeyword(const std::string& input) const {
-    std::string lower = Utils::toLower(input);
-    std::vector<std::string> dangerous = {
-        "drop", "delete", "truncate", "alter", "create", "insert", "update"
-    };
-    
-    return std::find(dangerous.begin(), dangerous.end(), lower) != dangerous.end();
+    bool whole = false;
+    dangerousKeywords().scan(input, [&](const PatternMatcher::Match& m) {
+        whole = m.offset == 0 && m.length == input.size();
+        return !whole;
+    });
+    return whole;
 }
\ No newline at end of file
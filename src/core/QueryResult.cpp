@@ -0,0 +1,189 @@
+#include "src/core/QueryResult.h"
+#include "src/core/PgValue.h"
+
+void QueryResult::Column::pushNullBit(bool isNull) {
+    size_t row = size();
+    if ((row & 63) == 0) {
+        nulls_.push_back(0);
+    }
+    if (isNull) {
+        nulls_.back() |= uint64_t(1) << (row & 63);
+        nullCount_++;
+    }
+}
+
+void QueryResult::Column::append(const char* data, size_t length) {
+    pushNullBit(false);
+    arena_.insert(arena_.end(), data, data + length);
+    offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+}
+
+void QueryResult::Column::appendNull() {
+    pushNullBit(true);
+    offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+}
+
+void QueryResult::Column::append(const Column& other) {
+    size_t rows = other.size();
+    if (rows == 0) return;
+
+    uint32_t base = static_cast<uint32_t>(arena_.size());
+    size_t start = size();
+    arena_.insert(arena_.end(), other.arena_.begin(), other.arena_.end());
+    offsets_.reserve(offsets_.size() + rows);
+    for (size_t i = 1; i <= rows; ++i) {
+        offsets_.push_back(base + other.offsets_[i]);
+    }
+
+    // Сдвиг маски NULL на start бит
+    nulls_.resize((start + rows + 63) / 64, 0);
+    if (other.nullCount_ > 0) {
+        for (size_t i = 0; i < rows; ++i) {
+            if (other.isNull(i)) {
+                size_t row = start + i;
+                nulls_[row >> 6] |= uint64_t(1) << (row & 63);
+            }
+        }
+        nullCount_ += other.nullCount_;
+    }
+}
+
+std::string QueryResult::Column::text(size_t row) const {
+    return native_ ? PgValue::formatNative(type_, value(row)) : std::string(value(row));
+}
+
+void QueryResult::Column::clear() {
+    arena_.clear();
+    offsets_.resize(1);
+    nulls_.clear();
+    nullCount_ = 0;
+}
+
+void QueryResult::Column::truncate(size_t rows) {
+    if (rows >= size()) return;
+    arena_.resize(offsets_[rows]);
+    offsets_.resize(rows + 1);
+    nulls_.resize((rows + 63) / 64);
+    if (!nulls_.empty() && (rows & 63) != 0) {
+        nulls_.back() &= (uint64_t(1) << (rows & 63)) - 1;
+    }
+    nullCount_ = 0;
+    for (uint64_t word : nulls_) {
+        nullCount_ += static_cast<size_t>(__builtin_popcountll(word));
+    }
+}
+
+void QueryResult::Column::reserve(size_t rows, size_t bytes) {
+    arena_.reserve(arena_.size() + bytes);
+    offsets_.reserve(offsets_.size() + rows);
+    nulls_.reserve((size() + rows + 63) / 64);
+}
+
+size_t QueryResult::Column::byteSize() const {
+    return arena_.capacity() + offsets_.capacity() * sizeof(uint32_t) +
+           nulls_.capacity() * sizeof(uint64_t);
+}
+
+void QueryResult::setColumns(const PGresult* res) {
+    int count = PQnfields(res);
+    columns.clear();
+    columnTypes.clear();
+    columns.reserve(count);
+    columnTypes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        columns.emplace_back(PQfname(res, i));
+        columnTypes.push_back(PQftype(res, i));
+    }
+    data.clear();
+    data.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // Бинарный формат запрашивается только для типов с декодером
+        bool native = PQfformat(res, i) == 1 && PgValue::hasBinaryDecoder(columnTypes[i]);
+        data.emplace_back(columnTypes[i], native);
+    }
+}
+
+void QueryResult::addColumn(const std::string& name, Oid type) {
+    columns.push_back(name);
+    columnTypes.push_back(type);
+    data.emplace_back(type, false);
+}
+
+void QueryResult::appendRows(const PGresult* res) {
+    int rows = PQntuples(res);
+    int count = static_cast<int>(data.size());
+
+    std::string decoded;
+    for (int c = 0; c < count; ++c) {
+        Column& column = data[c];
+        if (column.native()) {
+            for (int r = 0; r < rows; ++r) {
+                if (!PQgetisnull(res, r, c) &&
+                    PgValue::decodeBinary(column.type(), PQgetvalue(res, r, c),
+                                          static_cast<size_t>(PQgetlength(res, r, c)), decoded)) {
+                    column.append(decoded.data(), decoded.size());
+                } else {
+                    column.appendNull();
+                }
+            }
+            continue;
+        }
+        if (rows > 1) {
+            size_t bytes = 0;
+            for (int r = 0; r < rows; ++r) {
+                bytes += PQgetlength(res, r, c);
+            }
+            column.reserve(rows, bytes);
+        }
+        for (int r = 0; r < rows; ++r) {
+            if (PQgetisnull(res, r, c)) {
+                column.appendNull();
+            } else {
+                column.append(PQgetvalue(res, r, c), PQgetlength(res, r, c));
+            }
+        }
+    }
+
+    rowCount += rows;
+}
+
+void QueryResult::append(const QueryResult& other) {
+    if (columns.empty()) {
+        columns = other.columns;
+        columnTypes = other.columnTypes;
+        data.clear();
+        for (const auto& column : other.data) {
+            data.emplace_back(column.type(), column.native());
+        }
+    }
+    for (size_t c = 0; c < data.size() && c < other.data.size(); ++c) {
+        data[c].append(other.data[c]);
+    }
+    rowCount += other.rowCount;
+}
+
+void QueryResult::clearRows() {
+    for (auto& column : data) {
+        column.clear();
+    }
+    rowCount = 0;
+}
+
+void QueryResult::truncateRows(size_t rows) {
+    if (rows >= static_cast<size_t>(rowCount)) return;
+    for (auto& column : data) {
+        column.truncate(rows);
+    }
+    rowCount = static_cast<int>(rows);
+}
+
+size_t QueryResult::byteSize() const {
+    size_t bytes = sizeof(QueryResult);
+    for (const auto& name : columns) {
+        bytes += sizeof(std::string) + name.size();
+    }
+    for (const auto& column : data) {
+        bytes += sizeof(Column) + column.byteSize();
+    }
+    return bytes;
+}
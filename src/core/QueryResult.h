@@ -0,0 +1,119 @@
+#ifndef QUERY_RESULT_H
+#define QUERY_RESULT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <libpq-fe.h>
+
+// Результат запроса в колоночном виде: у каждой колонки один непрерывный
+// буфер значений, массив смещений (rows + 1) и битовая маска NULL.
+// Заполняется напрямую из буферов libpq - без строки на каждую ячейку.
+// Смещения 32-битные, как в Arrow: не больше 4 ГБ данных на колонку.
+// Колонки, пришедшие в бинарном формате, хранят значения в машинном виде
+// (см. PgValue) и превращаются в текст только при выводе.
+class QueryResult {
+public:
+    class Column {
+    public:
+        Column() : offsets_(1, 0) {}
+        Column(Oid type, bool native) : offsets_(1, 0), type_(type), native_(native) {}
+
+        size_t size() const { return offsets_.size() - 1; }
+        bool isNull(size_t row) const { return (nulls_[row >> 6] >> (row & 63)) & 1u; }
+        // Сырые байты: текст сервера или машинное значение для native()
+        std::string_view value(size_t row) const {
+            return std::string_view(arena_.data() + offsets_[row], offsets_[row + 1] - offsets_[row]);
+        }
+        // Значение в текстовом виде сервера
+        std::string text(size_t row) const;
+        Oid type() const { return type_; }
+        bool native() const { return native_; }
+
+        void append(const char* data, size_t length);
+        void appendNull();
+        void append(const Column& other);
+        void clear();
+        void truncate(size_t rows);
+        void reserve(size_t rows, size_t bytes);
+
+        size_t byteSize() const;
+        const std::vector<char>& arena() const { return arena_; }
+        const std::vector<uint32_t>& offsets() const { return offsets_; }
+        const std::vector<uint64_t>& nullBitmap() const { return nulls_; }
+        bool hasNulls() const { return nullCount_ > 0; }
+
+    private:
+        void pushNullBit(bool isNull);
+
+        std::vector<char> arena_;
+        std::vector<uint32_t> offsets_;
+        std::vector<uint64_t> nulls_;
+        size_t nullCount_ = 0;
+        Oid type_ = 0;
+        bool native_ = false;
+    };
+
+    // Лёгкое представление строки для форматтеров
+    class RowView {
+    public:
+        RowView(const QueryResult* result, size_t row) : result_(result), row_(row) {}
+
+        size_t size() const { return result_->data.size(); }
+        bool isNull(size_t column) const { return result_->data[column].isNull(row_); }
+        std::string_view value(size_t column) const { return result_->data[column].value(row_); }
+        // Текст ячейки; NULL показывается как "NULL"
+        std::string operator[](size_t column) const {
+            return isNull(column) ? std::string("NULL") : result_->data[column].text(row_);
+        }
+
+    private:
+        const QueryResult* result_;
+        size_t row_;
+    };
+
+    class RowIterator {
+    public:
+        RowIterator(const QueryResult* result, size_t row) : result_(result), row_(row) {}
+        RowView operator*() const { return RowView(result_, row_); }
+        RowIterator& operator++() { ++row_; return *this; }
+        bool operator!=(const RowIterator& other) const { return row_ != other.row_; }
+
+    private:
+        const QueryResult* result_;
+        size_t row_;
+    };
+
+    std::vector<std::string> columns;
+    std::vector<Oid> columnTypes;
+    std::vector<Column> data;
+    int rowCount = 0;
+    bool success = false;
+    std::string errorMessage;
+    std::string sqlState;    // SQLSTATE ошибки сервера
+    bool truncated = false;  // строки обрезаны по лимиту потокового чтения
+
+    // Имена, типы и формат колонок из описания результата libpq
+    void setColumns(const PGresult* res);
+    // Текстовая колонка для результата, собранного на клиенте
+    void addColumn(const std::string& name, Oid type);
+    // Добавить все строки res (в single-row mode - одну); бинарные значения
+    // декодируются, нераспознанные сохраняются как NULL
+    void appendRows(const PGresult* res);
+    // Добавить строки другого результата с теми же колонками
+    void append(const QueryResult& other);
+    // Убрать строки, сохранив колонки и выделенную память
+    void clearRows();
+    // Оставить первые rows строк
+    void truncateRows(size_t rows);
+
+    RowView row(size_t index) const { return RowView(this, index); }
+    RowIterator begin() const { return RowIterator(this, 0); }
+    RowIterator end() const { return RowIterator(this, static_cast<size_t>(rowCount)); }
+    bool empty() const { return rowCount == 0; }
+
+    size_t byteSize() const;
+};
+
+#endif // QUERY_RESULT_H
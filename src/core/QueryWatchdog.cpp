@@ -0,0 +1,133 @@
+#include "src/core/QueryWatchdog.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Guard
+
+QueryWatchdog::Guard::Guard(Guard&& other) noexcept : owner_(other.owner_), id_(other.id_) {
+    other.owner_ = nullptr;
+}
+
+QueryWatchdog::Guard& QueryWatchdog::Guard::operator=(Guard&& other) noexcept {
+    if (this != &other) {
+        if (owner_) owner_->unwatch(id_);
+        owner_ = other.owner_;
+        id_ = other.id_;
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+QueryWatchdog::Guard::~Guard() {
+    if (owner_) owner_->unwatch(id_);
+}
+
+// ---------------------------------------------------------------------------
+// QueryWatchdog
+
+QueryWatchdog::~QueryWatchdog() {
+    stop();
+}
+
+void QueryWatchdog::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&QueryWatchdog::run, this);
+}
+
+void QueryWatchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+QueryWatchdog::Guard QueryWatchdog::watch(PgConnection& conn, std::chrono::milliseconds timeout) {
+    if (timeout.count() <= 0) {
+        return Guard();
+    }
+    PgCancel cancel = conn.cancelHandle();
+    if (!cancel) {
+        return Guard();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return Guard();
+    }
+    uint64_t id = nextId_++;
+    auto deadline = Clock::now() + timeout;
+    bool earliest = entries_.empty() ||
+                    std::all_of(entries_.begin(), entries_.end(),
+                                [deadline](const auto& e) { return e.second.deadline > deadline; });
+    entries_.emplace(id, Entry{std::move(cancel), deadline});
+    if (earliest) {
+        cv_.notify_one();
+    }
+    return Guard(this, id);
+}
+
+void QueryWatchdog::unwatch(uint64_t id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Отмена уже отправляется: дождаться, иначе она может прийти следующему
+    // запросу на этом соединении. Запись удалит фоновый поток
+    cancelled_.wait(lock, [this, id]() {
+        auto it = entries_.find(id);
+        return it == entries_.end() || !it->second.cancelling;
+    });
+    entries_.erase(id);
+}
+
+void QueryWatchdog::run() {
+    std::vector<std::pair<uint64_t, PGcancel*>> expired;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        if (entries_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+
+        auto next = entries_.begin()->second.deadline;
+        for (const auto& [id, entry] : entries_) {
+            next = std::min(next, entry.deadline);
+        }
+        if (cv_.wait_until(lock, next) != std::cv_status::timeout) {
+            continue;  // новый запрос с более ранним сроком или остановка
+        }
+
+        auto now = Clock::now();
+        expired.clear();
+        for (auto& [id, entry] : entries_) {
+            if (entry.deadline <= now) {
+                entry.cancelling = true;
+                expired.emplace_back(id, entry.cancel.get());
+            }
+        }
+        if (expired.empty()) continue;
+
+        // PQcancel открывает новое соединение с сервером и при зависшей сети
+        // ждёт долго: вне блокировки watch() и снятие других запросов не стоят.
+        // Записи с cancelling живы, пока их не удалит этот поток
+        lock.unlock();
+        for (const auto& [id, cancel] : expired) {
+            char error[256];
+            PQcancel(cancel, error, sizeof(error));
+            cancellations_.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARNING("Query exceeded its deadline, cancel sent");
+        }
+        lock.lock();
+        for (const auto& [id, cancel] : expired) {
+            entries_.erase(id);
+        }
+        cancelled_.notify_all();
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef QUERY_WATCHDOG_H
+#define QUERY_WATCHDOG_H
+
+#include "src/core/PgConnection.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Клиентская страховка поверх statement_timeout: фоновый поток отменяет
+// (PQcancel) запросы, не завершившиеся к сроку, - например, если сервер
+// не получил таймаут или ответ застрял в сети.
+class QueryWatchdog {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Снимает наблюдение при разрушении. Если отмена этого запроса уже
+    // отправляется, деструктор дожидается её: после него запрос на
+    // соединении (возможно, уже следующий) не будет отменён.
+    class Guard {
+    public:
+        Guard() = default;
+        Guard(Guard&& other) noexcept;
+        Guard& operator=(Guard&& other) noexcept;
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        friend class QueryWatchdog;
+        Guard(QueryWatchdog* owner, uint64_t id) : owner_(owner), id_(id) {}
+
+        QueryWatchdog* owner_ = nullptr;
+        uint64_t id_ = 0;
+    };
+
+    QueryWatchdog() = default;
+    ~QueryWatchdog();
+
+    void start();
+    void stop();
+
+    // timeout == 0 - без наблюдения. Вызывать из потока-владельца conn:
+    // данные для отмены (PQgetCancel) берутся здесь, а не в фоновом потоке
+    Guard watch(PgConnection& conn, std::chrono::milliseconds timeout);
+
+    uint64_t cancellations() const { return cancellations_.load(std::memory_order_relaxed); }
+
+    QueryWatchdog(const QueryWatchdog&) = delete;
+    QueryWatchdog& operator=(const QueryWatchdog&) = delete;
+
+private:
+    struct Entry {
+        PgCancel cancel;
+        Clock::time_point deadline;
+        bool cancelling = false;  // PQcancel выполняется вне блокировки
+    };
+
+    void run();
+    void unwatch(uint64_t id);
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable cancelled_;
+    std::map<uint64_t, Entry> entries_;
+    uint64_t nextId_ = 1;
+    bool running_ = false;
+    std::thread thread_;
+    std::atomic<uint64_t> cancellations_{0};
+};
+
+#endif // QUERY_WATCHDOG_H
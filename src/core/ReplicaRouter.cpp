@@ -0,0 +1,248 @@
+#include "src/core/ReplicaRouter.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    // Отставание в миллисекундах. Если всё принятое WAL уже применено,
+    // реплика догнала основной сервер, даже если записей давно не было и
+    // pg_last_xact_replay_timestamp() старый; не реплика (например, после
+    // promote) отставания не имеет.
+    const char* kLagQuery =
+        "SELECT CASE WHEN NOT pg_is_in_recovery() THEN 0 "
+        "WHEN pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 "
+        "ELSE coalesce(extract(epoch FROM now() - pg_last_xact_replay_timestamp()) * 1000, 0) END";
+
+    double toMs(ReplicaRouter::Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    }
+}
+
+struct ReplicaRouter::Node {
+    std::string name;
+    std::unique_ptr<ConnectionPool> pool;
+    bool started = false;  // только в потоке проверки
+    std::atomic<bool> healthy{false};
+    std::atomic<size_t> outstanding{0};
+
+    // Под mutex_ маршрутизатора
+    double lagMs = 0.0;
+    uint64_t routed = 0;
+    uint64_t completed = 0;
+    uint64_t failures = 0;
+    Clock::duration totalLatency{0};
+    Clock::duration maxLatency{0};
+};
+
+// ---------------------------------------------------------------------------
+// Route
+
+ReplicaRouter::Route::Route(ReplicaRouter* router, Node* node, ConnectionPool::Lease lease)
+    : router_(router), node_(node), lease_(std::move(lease)), startedAt_(Clock::now()) {}
+
+ReplicaRouter::Route::Route(Route&& other) noexcept
+    : router_(other.router_), node_(other.node_), lease_(std::move(other.lease_)),
+      startedAt_(other.startedAt_) {
+    other.router_ = nullptr;
+    other.node_ = nullptr;
+}
+
+ReplicaRouter::Route& ReplicaRouter::Route::operator=(Route&& other) noexcept {
+    if (this != &other) {
+        finish();
+        router_ = other.router_;
+        node_ = other.node_;
+        lease_ = std::move(other.lease_);
+        startedAt_ = other.startedAt_;
+        other.router_ = nullptr;
+        other.node_ = nullptr;
+    }
+    return *this;
+}
+
+ReplicaRouter::Route::~Route() {
+    finish();
+}
+
+void ReplicaRouter::Route::finish() {
+    if (router_ && node_ && lease_) {
+        bool broken = PQstatus(lease_->raw()) != CONNECTION_OK;
+        router_->finish(*node_, Clock::now() - startedAt_, broken);
+    }
+    lease_.release();
+    router_ = nullptr;
+    node_ = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// ReplicaRouter
+
+ReplicaRouter::ReplicaRouter(Options options) : options_(options) {}
+
+ReplicaRouter::~ReplicaRouter() {
+    stop();
+}
+
+void ReplicaRouter::addReplica(std::string name, std::string connectionString,
+                               ConnectionPool::Options poolOptions) {
+    auto node = std::make_unique<Node>();
+    node->name = std::move(name);
+    node->pool = std::make_unique<ConnectionPool>(std::move(connectionString), poolOptions);
+    nodes_.push_back(std::move(node));
+}
+
+void ReplicaRouter::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ || nodes_.empty()) return;
+    }
+
+    for (auto& node : nodes_) {
+        check(*node);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+    thread_ = std::thread(&ReplicaRouter::run, this);
+}
+
+void ReplicaRouter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    stopCv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (auto& node : nodes_) {
+        node->healthy.store(false, std::memory_order_release);
+        node->pool->shutdown();
+        node->started = false;
+    }
+}
+
+ReplicaRouter::Route ReplicaRouter::route() {
+    const size_t count = nodes_.size();
+    if (count == 0) {
+        return Route();
+    }
+
+    // Обход с очередного узла: при равной загрузке реплики чередуются
+    const size_t first = nextNode_.fetch_add(1, std::memory_order_relaxed);
+    Node* best = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        Node& node = *nodes_[(first + i) % count];
+        if (!node.healthy.load(std::memory_order_acquire)) continue;
+        if (!best || node.outstanding.load(std::memory_order_relaxed) <
+                     best->outstanding.load(std::memory_order_relaxed)) {
+            best = &node;
+        }
+    }
+
+    if (best) {
+        // Без ожидания: занятая реплика медленнее основного сервера
+        auto lease = best->pool->acquire(std::chrono::milliseconds(0));
+        if (lease) {
+            best->outstanding.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex_);
+            replicaReads_++;
+            best->routed++;
+            return Route(this, best, std::move(lease));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    primaryFallbacks_++;
+    return Route();
+}
+
+void ReplicaRouter::recordWriteRetry() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writeRetries_++;
+}
+
+void ReplicaRouter::finish(Node& node, Clock::duration elapsed, bool broken) {
+    node.outstanding.fetch_sub(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        node.completed++;
+        node.totalLatency += elapsed;
+        node.maxLatency = std::max(node.maxLatency, elapsed);
+        if (broken) node.failures++;
+    }
+    if (broken && node.healthy.exchange(false, std::memory_order_acq_rel)) {
+        LOG_WARNING("Replica ", node.name, " lost connection, reads go elsewhere");
+    }
+}
+
+void ReplicaRouter::check(Node& node) {
+    bool healthy = false;
+    double lagMs = 0.0;
+    std::string error;
+
+    if (!node.started) {
+        node.started = node.pool->start();
+    }
+    if (node.started) {
+        auto lease = node.pool->acquire();
+        PgResult res = lease ? lease->exec(kLagQuery) : PgResult();
+        if (res && PQresultStatus(res.get()) == PGRES_TUPLES_OK && PQntuples(res.get()) == 1) {
+            lagMs = std::atof(PQgetvalue(res.get(), 0, 0));
+            healthy = lagMs <= static_cast<double>(options_.maxLag.count());
+            if (!healthy) error = "replication lag " + std::to_string(static_cast<long long>(lagMs)) + " ms";
+        } else {
+            error = res ? PQresultErrorMessage(res.get()) : node.pool->lastError();
+        }
+    } else {
+        error = node.pool->lastError();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        node.lagMs = lagMs;
+        if (!healthy) node.failures++;
+    }
+
+    bool was = node.healthy.exchange(healthy, std::memory_order_acq_rel);
+    if (was && !healthy) {
+        LOG_WARNING("Replica ", node.name, " excluded from routing: ", error);
+    } else if (!was && healthy) {
+        LOG_INFO("Replica ", node.name, " available for reads");
+    }
+}
+
+void ReplicaRouter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        stopCv_.wait_for(lock, options_.checkInterval, [this] { return !running_; });
+        if (!running_) break;
+
+        lock.unlock();
+        for (auto& node : nodes_) {
+            check(*node);
+        }
+        lock.lock();
+    }
+}
+
+ReplicaRouter::Stats ReplicaRouter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.replicaReads = replicaReads_;
+    stats.primaryFallbacks = primaryFallbacks_;
+    stats.writeRetries = writeRetries_;
+    for (const auto& node : nodes_) {
+        NodeStats n;
+        n.name = node->name;
+        n.healthy = node->healthy.load(std::memory_order_relaxed);
+        n.lagMs = node->lagMs;
+        n.outstanding = node->outstanding.load(std::memory_order_relaxed);
+        n.routed = node->routed;
+        n.failures = node->failures;
+        n.avgLatencyMs = node->completed > 0 ? toMs(node->totalLatency) / node->completed : 0.0;
+        n.maxLatencyMs = toMs(node->maxLatency);
+        stats.nodes.push_back(std::move(n));
+    }
+    return stats;
+}
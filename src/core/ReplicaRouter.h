@@ -0,0 +1,116 @@
+#ifndef REPLICA_ROUTER_H
+#define REPLICA_ROUTER_H
+
+#include "src/core/ConnectionPool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Маршрутизация чтений на реплики. У каждой реплики свой пул; запрос уходит
+// на исправную реплику с наименьшим числом выполняющихся запросов (при
+// равенстве - по кругу). Фоновый поток раз в checkInterval проверяет
+// доступность и отставание (pg_last_xact_replay_timestamp); реплика с
+// отставанием больше maxLag или с разорванным соединением исключается до
+// следующей успешной проверки.
+class ReplicaRouter {
+    struct Node;
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::chrono::milliseconds maxLag{5000};
+        std::chrono::milliseconds checkInterval{5000};
+    };
+
+    struct NodeStats {
+        std::string name;
+        bool healthy = false;
+        double lagMs = 0.0;
+        size_t outstanding = 0;
+        uint64_t routed = 0;
+        uint64_t failures = 0;    // разорвано во время запроса или не прошло проверку
+        double avgLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+    };
+
+    struct Stats {
+        uint64_t replicaReads = 0;
+        uint64_t primaryFallbacks = 0;  // чтение ушло на основной сервер: нет исправной реплики
+        uint64_t writeRetries = 0;      // реплика отказала в записи (25006), запрос повторён на основном
+        std::vector<NodeStats> nodes;
+    };
+
+    // Соединение реплики на время одного запроса. При разрушении
+    // возвращается в пул, а задержка учитывается в статистике узла.
+    class Route {
+    public:
+        Route() = default;
+        Route(Route&& other) noexcept;
+        Route& operator=(Route&& other) noexcept;
+        ~Route();
+
+        explicit operator bool() const { return static_cast<bool>(lease_); }
+        PgConnection* operator->() const { return lease_.operator->(); }
+        PgConnection& operator*() const { return *lease_; }
+
+        Route(const Route&) = delete;
+        Route& operator=(const Route&) = delete;
+
+    private:
+        friend class ReplicaRouter;
+        Route(ReplicaRouter* router, Node* node, ConnectionPool::Lease lease);
+        void finish();
+
+        ReplicaRouter* router_ = nullptr;
+        Node* node_ = nullptr;
+        ConnectionPool::Lease lease_;
+        Clock::time_point startedAt_;
+    };
+
+    explicit ReplicaRouter(Options options);
+    ~ReplicaRouter();
+
+    // Вызывать до start()
+    void addReplica(std::string name, std::string connectionString, ConnectionPool::Options poolOptions);
+
+    // Первая проверка выполняется сразу, чтобы чтения пошли на реплики
+    void start();
+    void stop();
+
+    // Пустой маршрут - исправной реплики со свободным соединением нет,
+    // запрос выполняется на основном сервере
+    Route route();
+    void recordWriteRetry();
+
+    Stats stats() const;
+
+    ReplicaRouter(const ReplicaRouter&) = delete;
+    ReplicaRouter& operator=(const ReplicaRouter&) = delete;
+
+private:
+    void check(Node& node);
+    void run();
+    void finish(Node& node, Clock::duration elapsed, bool broken);
+
+    Options options_;
+    std::vector<std::unique_ptr<Node>> nodes_;
+    std::atomic<size_t> nextNode_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable stopCv_;
+    bool running_ = false;
+    std::thread thread_;
+
+    uint64_t replicaReads_ = 0;
+    uint64_t primaryFallbacks_ = 0;
+    uint64_t writeRetries_ = 0;
+};
+
+#endif // REPLICA_ROUTER_H
@@ -1,34 +1,114 @@
 #include "src/core/ResponseParser.h"
-#include <sstream>
-#include <iomanip>
+#include "src/core/ArrowWriter.h"
+#include "src/core/CsvWriter.h"
+#include "src/core/JsonWriter.h"
+#include "src/core/TableWriter.h"
+#include "src/core/PgValue.h"
 #include <algorithm>
 
-ResponseParser::ResponseParser() {}
-
-std::string ResponseParser::formatResponse(const DatabaseConnector::QueryResult& result,
-                                          OutputFormat format) {
-    if (!result.success) {
-        return "Error: " + result.errorMessage;
+namespace {
+    using Result = DatabaseConnector::QueryResult;
+    
+    // Текст ячейки прямо в приёмник; NULL показывается как "NULL"
+    void writeCell(OutputSink& out, const Result::Column& column, size_t row) {
+        if (column.isNull(row)) {
+            out.write("NULL");
+        } else if (column.native()) {
+            out.write(column.text(row));
+        } else {
+            out.write(column.value(row));
+        }
     }
     
+    class PlainWriter : public ResultWriter {
+    public:
+        explicit PlainWriter(OutputSink& out) : out_(out) {}
+        
+        void write(const Result& batch) override {
+            const size_t rows = static_cast<size_t>(batch.rowCount);
+            const size_t columns = std::min(batch.columns.size(), batch.data.size());
+            for (size_t r = 0; r < rows; ++r) {
+                for (size_t i = 0; i < columns; ++i) {
+                    out_.write(batch.columns[i]);
+                    out_.write(": ");
+                    writeCell(out_, batch.data[i], r);
+                    out_.put('\n');
+                }
+                out_.put('\n');
+            }
+        }
+        
+        void finish(size_t rowCount, bool truncated) override {
+            out_.write("Total rows: " + std::to_string(rowCount));
+            if (truncated) out_.write(" (truncated)");
+            out_.put('\n');
+        }
+        
+    private:
+        OutputSink& out_;
+    };
+}
+
+ResponseParser::ResponseParser() {}
+
+void ResponseParser::setCsvOptions(char delimiter, std::string nullText) {
+    csvDelimiter_ = delimiter;
+    csvNull_ = std::move(nullText);
+}
+
+void ResponseParser::setTableOptions(size_t maxColumnWidth, size_t sampleRows) {
+    tableMaxColumnWidth_ = maxColumnWidth;
+    tableSampleRows_ = sampleRows;
+}
+
+std::string ResponseParser::csvCopyOptions() const {
+    return CsvWriter::copyOptions(CsvWriter::Options{csvDelimiter_, csvNull_});
+}
+
+std::unique_ptr<ResultWriter> ResponseParser::makeWriter(OutputFormat format, OutputSink& out) {
     switch (format) {
-        case OutputFormat::JSON:
-            return toJSON(result).dump(2);
-        case OutputFormat::TABLE:
-            return toTable(result);
         case OutputFormat::CSV:
-            return toCSV(result);
+            return std::make_unique<CsvWriter>(out, CsvWriter::Options{csvDelimiter_, csvNull_});
         case OutputFormat::PLAIN:
-            return toPlainText(result);
+            return std::make_unique<PlainWriter>(out);
+        case OutputFormat::JSON:
+            return std::make_unique<JsonWriter>(out);
+        case OutputFormat::JSON_COMPACT:
+            return std::make_unique<JsonWriter>(out, JsonWriter::Layout::Arrays, -1);
+        case OutputFormat::ARROW:
+            return std::make_unique<ArrowWriter>(out);
+        case OutputFormat::TABLE:
         default:
-            return toTable(result);
+            return std::make_unique<TableWriter>(out, TableWriter::Options{tableMaxColumnWidth_, tableSampleRows_});
     }
 }
 
+void ResponseParser::writeResponse(const DatabaseConnector::QueryResult& result, OutputFormat format,
+                                   OutputSink& out) {
+    if (!result.success) {
+        out.write("Error: " + result.errorMessage);
+        return;
+    }
+    
+    auto writer = makeWriter(format, out);
+    writer->write(result);
+    writer->finish(static_cast<size_t>(result.rowCount), result.truncated);
+}
+
+std::string ResponseParser::formatResponse(const DatabaseConnector::QueryResult& result,
+                                          OutputFormat format) {
+    StringSink out;
+    writeResponse(result, format, out);
+    return out.take();
+}
+
 json ResponseParser::toJSON(const DatabaseConnector::QueryResult& result) {
     json output;
     output["success"] = result.success;
     output["rowCount"] = result.rowCount;
+    if (result.truncated) {
+        output["truncated"] = true;
+    }
     
     if (!result.success) {
         output["error"] = result.errorMessage;
@@ -37,10 +117,10 @@ json ResponseParser::toJSON(const DatabaseConnector::QueryResult& result) {
     
     json rows = json::array();
     
-    for (const auto& row : result.rows) {
+    for (size_t r = 0; r < static_cast<size_t>(result.rowCount); ++r) {
         json rowObj;
-        for (size_t i = 0; i < result.columns.size() && i < row.size(); ++i) {
-            rowObj[result.columns[i]] = row[i];
+        for (size_t i = 0; i < result.columns.size() && i < result.data.size(); ++i) {
+            rowObj[result.columns[i]] = cellToJSON(result.data[i], r);
         }
         rows.push_back(rowObj);
     }
@@ -51,114 +131,66 @@ json ResponseParser::toJSON(const DatabaseConnector::QueryResult& result) {
     return output;
 }
 
-std::vector<size_t> ResponseParser::calculateColumnWidths(
-    const DatabaseConnector::QueryResult& result) {
-    
-    std::vector<size_t> widths(result.columns.size(), 0);
-    
-    // Ширина заголовков
-    for (size_t i = 0; i < result.columns.size(); ++i) {
-        widths[i] = result.columns[i].length();
+json ResponseParser::cellToJSON(const DatabaseConnector::QueryResult::Column& column, size_t row) {
+    if (column.isNull(row)) {
+        return "NULL";
     }
     
-    // Ширина данных
-    for (const auto& row : result.rows) {
-        for (size_t i = 0; i < row.size() && i < widths.size(); ++i) {
-            widths[i] = std::max(widths[i], row[i].length());
+    std::string_view value = column.value(row);
+    if (column.type() == PgValue::kNumeric) {
+        // В json нет числа произвольной точности: numeric становится числом,
+        // только если целое или double записывается тем же текстом,
+        // иначе - строкой с точным значением
+        int64_t integer;
+        double number;
+        if (PgValue::isJsonNumber(value)) {
+            if (PgValue::toInt64(column.type(), false, value, integer)) return integer;
+            if (PgValue::toDouble(column.type(), false, value, number) && json(number).dump() == value) {
+                return number;
+            }
         }
+        return std::string(value);
     }
-    
-    return widths;
+    switch (PgValue::kindOf(column.type())) {
+        case PgValue::Kind::Integer: {
+            int64_t integer;
+            if (PgValue::toInt64(column.type(), column.native(), value, integer)) return integer;
+            break;
+        }
+        case PgValue::Kind::Float: {
+            double number;
+            if (PgValue::toDouble(column.type(), column.native(), value, number)) return number;
+            break;
+        }
+        case PgValue::Kind::Bool: {
+            bool flag;
+            if (PgValue::toBool(column.native(), value, flag)) return flag;
+            break;
+        }
+        case PgValue::Kind::Text:
+            break;
+    }
+    return column.text(row);
 }
 
-std::string ResponseParser::padString(const std::string& str, size_t width) {
-    if (str.length() >= width) return str;
-    return str + std::string(width - str.length(), ' ');
+std::string ResponseParser::toTable(const DatabaseConnector::QueryResult& result) {
+    StringSink out;
+    writeTable(result, out);
+    return out.take();
 }
 
-std::string ResponseParser::toTable(const DatabaseConnector::QueryResult& result) {
-    if (result.rows.empty()) {
-        return "No results found.\n";
-    }
-    
-    std::ostringstream oss;
-    auto widths = calculateColumnWidths(result);
-    
-    // Верхняя граница
-    oss << "+";
-    for (auto width : widths) {
-        oss << std::string(width + 2, '-') << "+";
-    }
-    oss << "\n";
-    
-    // Заголовки
-    oss << "|";
-    for (size_t i = 0; i < result.columns.size(); ++i) {
-        oss << " " << padString(result.columns[i], widths[i]) << " |";
-    }
-    oss << "\n";
-    
-    // Разделитель
-    oss << "+";
-    for (auto width : widths) {
-        oss << std::string(width + 2, '=') << "+";
-    }
-    oss << "\n";
-    
-    // Данные
-    for (const auto& row : result.rows) {
-        oss << "|";
-        for (size_t i = 0; i < row.size() && i < widths.size(); ++i) {
-            oss << " " << padString(row[i], widths[i]) << " |";
-        }
-        oss << "\n";
-    }
-    
-    // Нижняя граница
-    oss << "+";
-    for (auto width : widths) {
-        oss << std::string(width + 2, '-') << "+";
-    }
-    oss << "\n";
-    
-    oss << "\nTotal rows: " << result.rowCount << "\n";
-    
-    return oss.str();
+void ResponseParser::writeTable(const DatabaseConnector::QueryResult& result, OutputSink& out) {
+    writeResponse(result, OutputFormat::TABLE, out);
 }
 
 std::string ResponseParser::toCSV(const DatabaseConnector::QueryResult& result) {
-    std::ostringstream oss;
-    
-    // Заголовки
-    for (size_t i = 0; i < result.columns.size(); ++i) {
-        if (i > 0) oss << ",";
-        oss << "\"" << result.columns[i] << "\"";
-    }
-    oss << "\n";
-    
-    // Данные
-    for (const auto& row : result.rows) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            if (i > 0) oss << ",";
-            oss << "\"" << row[i] << "\"";
-        }
-        oss << "\n";
-    }
-    
-    return oss.str();
+    StringSink out;
+    writeResponse(result, OutputFormat::CSV, out);
+    return out.take();
 }
 
 std::string ResponseParser::toPlainText(const DatabaseConnector::QueryResult& result) {
-    std::ostringstream oss;
-    
-    for (const auto& row : result.rows) {
-        for (size_t i = 0; i < result.columns.size() && i < row.size(); ++i) {
-            oss << result.columns[i] << ": " << row[i] << "\n";
-        }
-        oss << "\n";
-    }
-    
-    oss << "Total rows: " << result.rowCount << "\n";
-    
-    return oss.str();
-}
\ No newline at end of file
+    StringSink out;
+    writeResponse(result, OutputFormat::PLAIN, out);
+    return out.take();
+}
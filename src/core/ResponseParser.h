@@ -2,22 +2,51 @@
 #define RESPONSE_PARSER_H
 
 #include "src/core/DatabaseConnector.h"
+#include "src/core/OutputSink.h"
+#include <memory>
 #include <string>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// Форматирование результата по мере поступления пачек (потоковое чтение):
+// вывод начинается до того, как прочитана последняя строка. Все пачки
+// одного результата имеют одинаковые columns.
+class ResultWriter {
+public:
+    virtual ~ResultWriter() = default;
+    
+    virtual void write(const DatabaseConnector::QueryResult& batch) = 0;
+    // После последней пачки: всего строк и признак усечения по лимиту
+    virtual void finish(size_t rowCount, bool truncated) = 0;
+};
+
 class ResponseParser {
 public:
     enum class OutputFormat {
         JSON,
+        JSON_COMPACT,  // columns и data массивами, без отступов
         TABLE,
         CSV,
-        PLAIN
+        PLAIN,
+        ARROW          // Arrow IPC stream, двоичный
     };
     
     ResponseParser();
     
+    // Разделитель и представление NULL для CSV (см. CsvWriter::Options)
+    void setCsvOptions(char delimiter, std::string nullText);
+    // Предел ширины колонки таблицы и объём выборки для оценки ширин (см. TableWriter::Options)
+    void setTableOptions(size_t maxColumnWidth, size_t sampleRows);
+    // Настройки CSV для COPY ... TO STDOUT WITH (...)
+    std::string csvCopyOptions() const;
+    
+    // Форматтер, пишущий в out; приёмник должен пережить форматтер
+    std::unique_ptr<ResultWriter> makeWriter(OutputFormat format, OutputSink& out);
+    // Готовый результат целиком (или текст ошибки) в out
+    void writeResponse(const DatabaseConnector::QueryResult& result, OutputFormat format, OutputSink& out);
+    
     std::string formatResponse(const DatabaseConnector::QueryResult& result,
                                OutputFormat format = OutputFormat::TABLE);
     
@@ -25,10 +54,17 @@ public:
     std::string toTable(const DatabaseConnector::QueryResult& result);
     std::string toCSV(const DatabaseConnector::QueryResult& result);
     std::string toPlainText(const DatabaseConnector::QueryResult& result);
+    
+    void writeTable(const DatabaseConnector::QueryResult& result, OutputSink& out);
 
 private:
-    std::vector<size_t> calculateColumnWidths(const DatabaseConnector::QueryResult& result);
-    std::string padString(const std::string& str, size_t width);
+    // Числа и логические значения - как JSON-типы, остальное строкой
+    json cellToJSON(const DatabaseConnector::QueryResult::Column& column, size_t row);
+    
+    char csvDelimiter_ = ',';
+    std::string csvNull_;
+    size_t tableMaxColumnWidth_ = 40;
+    size_t tableSampleRows_ = 1000;
 };
 
-#endif // RESPONSE_PARSER_H
\ No newline at end of file
+#endif // RESPONSE_PARSER_H
@@ -0,0 +1,273 @@
+#include "src/core/SchemaCatalog.h"
+#include "src/utils/Logger.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    // Сигнатура структуры таблицы c: колонки, индексы и внешние ключи
+    const std::string kSignature =
+        "md5("
+        "coalesce((SELECT string_agg(a.attname || ':' || a.atttypid || ':' || a.atttypmod || ':' || a.attnotnull, "
+        "',' ORDER BY a.attnum) FROM pg_attribute a "
+        "WHERE a.attrelid = c.oid AND a.attnum > 0 AND NOT a.attisdropped), '') || '|' || "
+        "coalesce((SELECT string_agg(i.indexrelid || ':' || i.indisunique || ':' || i.indisprimary, "
+        "',' ORDER BY i.indexrelid) FROM pg_index i WHERE i.indrelid = c.oid), '') || '|' || "
+        "coalesce((SELECT string_agg(con.oid::text, ',' ORDER BY con.oid) FROM pg_constraint con "
+        "WHERE con.conrelid = c.oid AND con.contype = 'f'), ''))";
+
+    const std::string kRelationFilter =
+        "FROM pg_class c JOIN pg_namespace n ON n.oid = c.relnamespace "
+        "WHERE n.nspname = 'public' AND c.relkind IN ('r', 'p', 'v', 'm', 'f')";
+
+    // Имена колонок по массиву номеров атрибутов, через запятую
+    std::string attributeList(const std::string& numbers, const std::string& relation) {
+        return "(SELECT string_agg(a.attname::text, ',' ORDER BY k.ord) "
+               "FROM unnest(" + numbers + ") WITH ORDINALITY AS k(attnum, ord) "
+               "JOIN pg_attribute a ON a.attrelid = " + relation + " AND a.attnum = k.attnum)";
+    }
+
+    // Дешёвая сверка: имя и сигнатура каждой таблицы
+    const std::string kSignatureQuery = "SELECT c.relname::text, " + kSignature + " " + kRelationFilter;
+
+    // Всё о таблицах из $1 (пустой массив - обо всех) одним запросом:
+    // строка 't' на таблицу, 'c' на колонку, 'i' на индекс, 'f' на внешний ключ
+    const std::string kCatalogQuery =
+        "WITH rels AS (SELECT c.oid, c.relname::text AS relname, " + kSignature + " AS signature " +
+        kRelationFilter + " AND (cardinality($1::text[]) = 0 OR c.relname = ANY ($1::text[]))) "
+        "SELECT 't', r.relname, '', r.signature, '', '', '', 0 FROM rels r "
+        "UNION ALL "
+        "SELECT 'c', r.relname, a.attname::text, format_type(a.atttypid, a.atttypmod), "
+        "CASE WHEN a.attnotnull THEN 'n' ELSE '' END, '', '', a.attnum "
+        "FROM rels r JOIN pg_attribute a ON a.attrelid = r.oid "
+        "WHERE a.attnum > 0 AND NOT a.attisdropped "
+        "UNION ALL "
+        "SELECT 'i', r.relname, ic.relname::text, " + attributeList("i.indkey::int2[]", "i.indrelid") + ", "
+        "CASE WHEN i.indisprimary THEN 'p' WHEN i.indisunique THEN 'u' ELSE '' END, '', '', 0 "
+        "FROM rels r JOIN pg_index i ON i.indrelid = r.oid JOIN pg_class ic ON ic.oid = i.indexrelid "
+        "UNION ALL "
+        "SELECT 'f', r.relname, con.conname::text, " + attributeList("con.conkey", "con.conrelid") + ", '', "
+        "ref.relname::text, " + attributeList("con.confkey", "con.confrelid") + ", 0 "
+        "FROM rels r JOIN pg_constraint con ON con.conrelid = r.oid AND con.contype = 'f' "
+        "JOIN pg_class ref ON ref.oid = con.confrelid "
+        "ORDER BY 2, 8";
+
+    std::vector<std::string> splitList(const char* text) {
+        std::vector<std::string> items;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    // Литерал text[] для параметра $1
+    std::string arrayLiteral(const std::vector<std::string>& items) {
+        std::string out = "{";
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0) out += ',';
+            out += '"';
+            for (char c : items[i]) {
+                if (c == '"' || c == '\\') out += '\\';
+                out += c;
+            }
+            out += '"';
+        }
+        out += '}';
+        return out;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SchemaSnapshot
+
+const CatalogTable* SchemaSnapshot::find(const std::string& name) const {
+    auto it = tables.find(name);
+    return it != tables.end() ? it->second.get() : nullptr;
+}
+
+std::vector<std::string> SchemaSnapshot::tableNames() const {
+    std::vector<std::string> names;
+    names.reserve(tables.size());
+    for (const auto& [name, table] : tables) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+// ---------------------------------------------------------------------------
+// SchemaCatalog
+
+SchemaCatalog::SchemaCatalog() : snapshot_(std::make_shared<const SchemaSnapshot>()) {}
+
+std::shared_ptr<const SchemaSnapshot> SchemaCatalog::snapshot() const {
+    return std::atomic_load(&snapshot_);
+}
+
+bool SchemaCatalog::isDue() const {
+    if (stale_.load(std::memory_order_acquire)) return true;
+    if (refreshInterval_.count() <= 0) return false;
+    auto last = Clock::time_point(Clock::duration(lastCheck_.load(std::memory_order_relaxed)));
+    return Clock::now() - last >= refreshInterval_;
+}
+
+void SchemaCatalog::reset() {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    std::atomic_store(&snapshot_, std::make_shared<const SchemaSnapshot>());
+    stale_.store(true, std::memory_order_release);
+}
+
+bool SchemaCatalog::load(PgConnection& conn) {
+    std::lock_guard<std::mutex> lock(refreshMutex_);
+    stale_.store(false, std::memory_order_release);
+    lastCheck_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+    auto start = Clock::now();
+    TableMap tables;
+    if (!fetchTables(conn, {}, tables)) {
+        return false;
+    }
+    size_t count = tables.size();
+    publish(std::move(tables), Clock::now() - start, count, true);
+    LOG_INFO("Schema catalog loaded: ", count, " tables");
+    return true;
+}
+
+bool SchemaCatalog::refresh(PgConnection& conn) {
+    std::unique_lock<std::mutex> lock(refreshMutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return true;
+    }
+
+    // Сброс флага до запроса: уведомление во время сверки снова его поднимет
+    stale_.store(false, std::memory_order_release);
+    lastCheck_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+    auto current = snapshot();
+    auto start = Clock::now();
+
+    PgResult res = conn.exec(kSignatureQuery);
+    if (!res || PQresultStatus(res.get()) != PGRES_TUPLES_OK) {
+        setError(res ? PQresultErrorMessage(res.get()) : conn.lastError());
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> statsLock(statsMutex_);
+        stats_.checks++;
+    }
+
+    std::map<std::string, std::string> signatures;
+    for (int r = 0; r < PQntuples(res.get()); ++r) {
+        signatures[PQgetvalue(res.get(), r, 0)] = PQgetvalue(res.get(), r, 1);
+    }
+
+    std::vector<std::string> changed;
+    for (const auto& [name, signature] : signatures) {
+        const CatalogTable* table = current->find(name);
+        if (!table || table->signature != signature) {
+            changed.push_back(name);
+        }
+    }
+    bool removed = std::any_of(current->tables.begin(), current->tables.end(),
+                               [&signatures](const auto& entry) { return !signatures.count(entry.first); });
+    if (changed.empty() && !removed && current->version > 0) {
+        return true;
+    }
+
+    TableMap tables;
+    for (const auto& [name, table] : current->tables) {
+        if (signatures.count(name)) tables[name] = table;
+    }
+    if (!changed.empty()) {
+        TableMap fresh;
+        if (!fetchTables(conn, changed, fresh)) {
+            return false;
+        }
+        for (auto& [name, table] : fresh) {
+            tables[name] = std::move(table);
+        }
+    }
+
+    publish(std::move(tables), Clock::now() - start, changed.size(), false);
+    LOG_INFO("Schema catalog refreshed: ", changed.size(),
+             " tables reloaded", (removed ? ", dropped tables removed" : ""));
+    return true;
+}
+
+bool SchemaCatalog::fetchTables(PgConnection& conn, const std::vector<std::string>& names, TableMap& out) {
+    PgResult res = conn.execParams(kCatalogQuery, {arrayLiteral(names)});
+    if (!res || PQresultStatus(res.get()) != PGRES_TUPLES_OK) {
+        setError(res ? PQresultErrorMessage(res.get()) : conn.lastError());
+        return false;
+    }
+
+    std::map<std::string, std::shared_ptr<CatalogTable>> building;
+    for (int r = 0; r < PQntuples(res.get()); ++r) {
+        const char kind = PQgetvalue(res.get(), r, 0)[0];
+        std::string relation = PQgetvalue(res.get(), r, 1);
+        const char* name = PQgetvalue(res.get(), r, 2);
+        const char* detail = PQgetvalue(res.get(), r, 3);
+        const char* flag = PQgetvalue(res.get(), r, 4);
+
+        auto& table = building[relation];
+        if (!table) {
+            table = std::make_shared<CatalogTable>();
+            table->name = relation;
+        }
+
+        switch (kind) {
+            case 't':
+                table->signature = detail;
+                break;
+            case 'c':
+                table->columns.push_back(CatalogColumn{name, detail, flag[0] != 'n'});
+                break;
+            case 'i':
+                table->indexes.push_back(CatalogIndex{name, splitList(detail), flag[0] == 'u' || flag[0] == 'p',
+                                                      flag[0] == 'p'});
+                break;
+            case 'f':
+                table->foreignKeys.push_back(CatalogForeignKey{name, splitList(detail),
+                                                               PQgetvalue(res.get(), r, 5),
+                                                               splitList(PQgetvalue(res.get(), r, 6))});
+                break;
+        }
+    }
+
+    for (auto& [relation, table] : building) {
+        out[relation] = std::move(table);
+    }
+    return true;
+}
+
+void SchemaCatalog::publish(TableMap tables, Clock::duration elapsed, size_t reloaded, bool full) {
+    auto next = std::make_shared<SchemaSnapshot>();
+    next->version = snapshot()->version + 1;
+    next->tables = std::move(tables);
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.version = next->version;
+        stats_.tables = next->tables.size();
+        stats_.tablesReloaded += reloaded;
+        if (full) stats_.fullLoads++;
+        stats_.lastLoadMs = std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+    std::atomic_store(&snapshot_, std::shared_ptr<const SchemaSnapshot>(std::move(next)));
+}
+
+void SchemaCatalog::setError(const std::string& error) {
+    LOG_WARNING("Schema catalog query failed: ", error);
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    lastError_ = error;
+}
+
+SchemaCatalog::Stats SchemaCatalog::stats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+std::string SchemaCatalog::lastError() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return lastError_;
+}
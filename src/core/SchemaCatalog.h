@@ -0,0 +1,110 @@
+#ifndef SCHEMA_CATALOG_H
+#define SCHEMA_CATALOG_H
+
+#include "src/core/PgConnection.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct CatalogColumn {
+    std::string name;
+    std::string type;       // format_type: "character varying(100)", "integer", ...
+    bool nullable = true;
+};
+
+struct CatalogIndex {
+    std::string name;
+    std::vector<std::string> columns;
+    bool unique = false;
+    bool primary = false;
+};
+
+struct CatalogForeignKey {
+    std::string name;
+    std::vector<std::string> columns;
+    std::string refTable;
+    std::vector<std::string> refColumns;
+};
+
+struct CatalogTable {
+    std::string name;
+    std::string signature;  // md5 структуры: меняется при DDL таблицы
+    std::vector<CatalogColumn> columns;  // в порядке attnum
+    std::vector<CatalogIndex> indexes;
+    std::vector<CatalogForeignKey> foreignKeys;
+};
+
+// Неизменяемый снимок схемы public. Таблицы разделяются между снимками:
+// обновление перечитывает только изменившиеся.
+struct SchemaSnapshot {
+    uint64_t version = 0;  // 0 - схема ещё не загружена
+    std::map<std::string, std::shared_ptr<const CatalogTable>> tables;
+
+    const CatalogTable* find(const std::string& name) const;
+    std::vector<std::string> tableNames() const;
+};
+
+// Каталог схемы в памяти. Читатели получают снимок атомарной загрузкой
+// указателя и не ждут обновления. Полная загрузка - один запрос к pg_catalog;
+// обновление сверяет сигнатуры таблиц дешёвым запросом и перечитывает только
+// новые и изменённые. Обновление запускается по markStale() (событийный
+// триггер DDL через LISTEN/NOTIFY) или по истечении refreshInterval.
+class SchemaCatalog {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        uint64_t version = 0;
+        size_t tables = 0;
+        uint64_t fullLoads = 0;
+        uint64_t checks = 0;          // запросов сверки сигнатур
+        uint64_t tablesReloaded = 0;  // перечитано при обновлениях
+        double lastLoadMs = 0.0;
+    };
+
+    SchemaCatalog();
+
+    std::shared_ptr<const SchemaSnapshot> snapshot() const;
+
+    bool load(PgConnection& conn);
+    // Перечитать изменившиеся таблицы. Если обновление уже идёт в другом
+    // потоке, сразу возвращает true - читатели пользуются текущим снимком.
+    bool refresh(PgConnection& conn);
+
+    void setRefreshInterval(std::chrono::seconds interval) { refreshInterval_ = interval; }
+    void markStale() { stale_.store(true, std::memory_order_release); }
+    // Пора сверить схему с сервером
+    bool isDue() const;
+    void reset();
+
+    Stats stats() const;
+    std::string lastError() const;
+
+    SchemaCatalog(const SchemaCatalog&) = delete;
+    SchemaCatalog& operator=(const SchemaCatalog&) = delete;
+
+private:
+    using TableMap = std::map<std::string, std::shared_ptr<const CatalogTable>>;
+
+    // Прочитать таблицы (пустой список - все) одним запросом
+    bool fetchTables(PgConnection& conn, const std::vector<std::string>& names, TableMap& out);
+    void publish(TableMap tables, Clock::duration elapsed, size_t reloaded, bool full);
+    void setError(const std::string& error);
+
+    std::shared_ptr<const SchemaSnapshot> snapshot_;
+    std::mutex refreshMutex_;
+    std::atomic<bool> stale_{true};
+    std::chrono::seconds refreshInterval_{60};
+    std::atomic<Clock::rep> lastCheck_{0};
+
+    mutable std::mutex statsMutex_;
+    Stats stats_;
+    std::string lastError_;
+};
+
+#endif // SCHEMA_CATALOG_H
@@ -0,0 +1,114 @@
+#include "src/core/TableWriter.h"
+#include "src/utils/TextWidth.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace {
+    using Result = DatabaseConnector::QueryResult;
+
+    // Отметка обрезанной ячейки: один символ ширины 1
+    constexpr std::string_view kEllipsis = "\xE2\x80\xA6";
+
+    // Текст ячейки без копирования; NULL показывается как "NULL".
+    // Машинные значения (native) переводятся в текст в holder
+    std::string_view cellText(const Result::Column& column, size_t row, std::string& holder) {
+        if (column.isNull(row)) return "NULL";
+        if (column.native()) {
+            holder = column.text(row);
+            return holder;
+        }
+        return column.value(row);
+    }
+}
+
+TableWriter::TableWriter(OutputSink& out) : TableWriter(out, Options()) {}
+
+TableWriter::TableWriter(OutputSink& out, Options options) : out_(out), options_(options) {
+    if (options_.maxColumnWidth == 0) options_.maxColumnWidth = SIZE_MAX;
+    options_.maxColumnWidth = std::max<size_t>(options_.maxColumnWidth, 1);
+}
+
+void TableWriter::begin(const Result& batch) {
+    const size_t columns = std::min(batch.columns.size(), batch.data.size());
+    widths_.assign(columns, 0);
+    for (size_t i = 0; i < columns; ++i) {
+        widths_[i] = std::min(Utils::displayWidth(batch.columns[i]), options_.maxColumnWidth);
+    }
+
+    // Оценка по выборке: колонка, упёршаяся в предел, дальше не просматривается
+    size_t sample = static_cast<size_t>(batch.rowCount);
+    if (options_.sampleRows > 0) sample = std::min(sample, options_.sampleRows);
+    std::string holder;
+    for (size_t i = 0; i < columns; ++i) {
+        for (size_t r = 0; r < sample && widths_[i] < options_.maxColumnWidth; ++r) {
+            size_t width = Utils::displayWidth(cellText(batch.data[i], r, holder));
+            widths_[i] = std::min(std::max(widths_[i], width), options_.maxColumnWidth);
+        }
+    }
+
+    border('-');
+    out_.put('|');
+    for (size_t i = 0; i < columns; ++i) {
+        writeCell(batch.columns[i], widths_[i]);
+    }
+    out_.put('\n');
+    border('=');
+    started_ = true;
+}
+
+void TableWriter::border(char line) {
+    out_.put('+');
+    for (auto width : widths_) {
+        out_.fill(line, width + 2);
+        out_.put('+');
+    }
+    out_.put('\n');
+}
+
+void TableWriter::writeCell(std::string_view text, size_t width) {
+    out_.put(' ');
+    size_t shown;
+    if (text.size() <= width && Utils::isAscii(text.data(), text.size())) {
+        shown = text.size();
+        out_.write(text);
+    } else if ((shown = Utils::displayWidth(text)) <= options_.maxColumnWidth) {
+        out_.write(text);
+    } else {
+        // Шире предела: начало шириной maxColumnWidth - 1 и отметка обрезки
+        size_t bytes = Utils::fitWidth(text, options_.maxColumnWidth - 1, shown);
+        out_.write(text.data(), bytes);
+        out_.write(kEllipsis);
+        shown++;
+    }
+    if (shown < width) out_.fill(' ', width - shown);
+    out_.write(" |");
+}
+
+void TableWriter::write(const Result& batch) {
+    if (batch.rowCount == 0) return;
+    if (!started_) begin(batch);
+
+    const size_t rows = static_cast<size_t>(batch.rowCount);
+    const size_t columns = std::min(widths_.size(), batch.data.size());
+    std::string holder;
+    for (size_t r = 0; r < rows; ++r) {
+        out_.put('|');
+        for (size_t i = 0; i < columns; ++i) {
+            writeCell(cellText(batch.data[i], r, holder), widths_[i]);
+        }
+        out_.put('\n');
+    }
+}
+
+void TableWriter::finish(size_t rowCount, bool truncated) {
+    if (!started_) {
+        out_.write("No results found.\n");
+        return;
+    }
+
+    border('-');
+    out_.write("\nTotal rows: " + std::to_string(rowCount));
+    if (truncated) out_.write(" (truncated)");
+    out_.put('\n');
+}
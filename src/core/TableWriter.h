@@ -0,0 +1,41 @@
+#ifndef TABLE_WRITER_H
+#define TABLE_WRITER_H
+
+#include "src/core/ResponseParser.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Вывод результата таблицей за один проход. Ширины колонок оцениваются по
+// заголовкам и первым sampleRows строкам первой пачки (ширина в колонках
+// терминала, Utils::displayWidth) и ограничены maxColumnWidth; после этого
+// таблица выводится по мере поступления пачек, без сбора результата.
+// Ячейка шире maxColumnWidth обрезается по границе символа и помечается "…";
+// более поздняя ячейка шире оценки, но в пределах maxColumnWidth выводится
+// целиком и сдвигает свою строку - данные не теряются.
+// Выравнивание дописывается в буфер приёмника (fill) без временных строк.
+class TableWriter : public ResultWriter {
+public:
+    struct Options {
+        size_t maxColumnWidth = 40;  // 0 - без ограничения
+        size_t sampleRows = 1000;    // 0 - все строки первой пачки
+    };
+
+    explicit TableWriter(OutputSink& out);
+    TableWriter(OutputSink& out, Options options);
+
+    void write(const DatabaseConnector::QueryResult& batch) override;
+    void finish(size_t rowCount, bool truncated) override;
+
+private:
+    void begin(const DatabaseConnector::QueryResult& batch);
+    void border(char line);
+    void writeCell(std::string_view text, size_t width);
+
+    OutputSink& out_;
+    Options options_;
+    bool started_ = false;
+    std::vector<size_t> widths_;
+};
+
+#endif // TABLE_WRITER_H
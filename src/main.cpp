@@ -1,8 +1,10 @@
 #include "src/core/Agent.h"
+#include "src/core/OutputSink.h"
 #include "src/config/Config.h"
 #include "src/utils/Logger.h"
 #include <iostream>
 #include <string>
+#include <unistd.h>
 
 void printHelp() {
     std::cout << "\n=== AI SQL Query Agent ===\n\n";
@@ -11,12 +13,24 @@ void printHelp() {
     std::cout << "  sql <query>   - Execute SQL directly\n";
     std::cout << "  train <file>  - Train model with JSON file\n";
     std::cout << "  offline <on|off> - Toggle offline SQL generation (no DB required)\n";
-    std::cout << "  format <type> - Set output format (table/json/csv/plain)\n";
+    std::cout << "  format <type> - Set output format (table/json/json-compact/csv/plain/arrow)\n";
+    std::cout << "  output <file|off> - Write results to a file instead of the screen\n";
     std::cout << "  tables        - Show all tables\n";
+    std::cout << "  stats         - Show cache and runtime statistics\n";
     std::cout << "  help          - Show this help\n";
     std::cout << "  exit          - Exit program\n\n";
 }
 
+// Arrow - двоичный формат: пишется только в файл, в stdout он смешался бы
+// с приглашениями и заголовками
+bool needsOutputFile(const Agent& agent) {
+    if (agent.getOutputFormat() == ResponseParser::OutputFormat::ARROW && agent.getOutputFile().empty()) {
+        std::cout << "Arrow output is binary. Set a file first: output <file>\n";
+        return true;
+    }
+    return false;
+}
+
 int main(int argc, char* argv[]) {
     std::cout << "=== AI SQL Query Agent ===\n";
     std::cout << "Version 1.0.0\n\n";
@@ -47,10 +61,16 @@ int main(int argc, char* argv[]) {
     }
     printHelp();
     
+    // Результаты запросов пишутся в stdout по мере чтения, минуя std::cout;
+    // перед выводом в него std::cout сбрасывается
+    FdSink out(STDOUT_FILENO);
+    
     // Основной цикл
     std::string line;
     
     while (true) {
+        // Журнал пишется фоновым потоком: дописать сообщения прошлой команды до приглашения
+        Logger::getInstance().flush();
         std::cout << "\n> ";
         std::getline(std::cin, line);
         
@@ -65,22 +85,28 @@ int main(int argc, char* argv[]) {
             continue;
         }
         
+        if (line == "stats") {
+            std::cout << agent.getStatistics();
+            continue;
+        }
+        
         if (line == "tables") {
-            std::string result = agent.executeSQL(
-                "SELECT table_name FROM information_schema.tables "
-                "WHERE table_schema = 'public'");
-            std::cout << result << "\n";
+            std::cout << agent.listTables() << "\n";
             continue;
         }
         
         if (line.substr(0, 6) == "query ") {
             std::string query = line.substr(6);
-            auto response = agent.processQueryDetailed(query);
+            auto response = agent.generateSQL(query);
             
             if (response.success) {
                 std::cout << "\nGenerated SQL: " << response.sqlQuery << "\n";
-                std::cout << "Confidence: " << (response.confidence * 100) << "%\n\n";
-                std::cout << response.result << "\n";
+                std::cout << "Confidence: " << (response.confidence * 100) << "%\n\n" << std::flush;
+                if (agent.isConnected() && !needsOutputFile(agent)) {
+                    agent.writeResult(response.sqlQuery, out);
+                }
+                out.put('\n');
+                out.flush();
             } else {
                 std::cout << "Error: " << response.errorMessage << "\n";
             }
@@ -89,8 +115,11 @@ int main(int argc, char* argv[]) {
         
         if (line.substr(0, 4) == "sql ") {
             std::string sql = line.substr(4);
-            std::string result = agent.executeSQL(sql);
-            std::cout << result << "\n";
+            if (needsOutputFile(agent)) continue;
+            std::cout.flush();
+            agent.executeSQL(sql, out);
+            out.put('\n');
+            out.flush();
             continue;
         }
         
@@ -126,14 +155,32 @@ int main(int argc, char* argv[]) {
             } else if (format == "json") {
                 agent.setOutputFormat(ResponseParser::OutputFormat::JSON);
                 std::cout << "Output format set to JSON\n";
+            } else if (format == "json-compact") {
+                agent.setOutputFormat(ResponseParser::OutputFormat::JSON_COMPACT);
+                std::cout << "Output format set to JSON (compact)\n";
             } else if (format == "csv") {
                 agent.setOutputFormat(ResponseParser::OutputFormat::CSV);
                 std::cout << "Output format set to CSV\n";
             } else if (format == "plain") {
                 agent.setOutputFormat(ResponseParser::OutputFormat::PLAIN);
                 std::cout << "Output format set to PLAIN\n";
+            } else if (format == "arrow") {
+                agent.setOutputFormat(ResponseParser::OutputFormat::ARROW);
+                std::cout << "Output format set to ARROW (IPC stream)\n";
+            } else {
+                std::cout << "Unknown format. Use: table, json, json-compact, csv, plain, or arrow\n";
+            }
+            continue;
+        }
+        
+        if (line.substr(0, 7) == "output ") {
+            std::string path = line.substr(7);
+            if (path == "off") {
+                agent.setOutputFile("");
+                std::cout << "Results are written to the screen\n";
             } else {
-                std::cout << "Unknown format. Use: table, json, csv, or plain\n";
+                agent.setOutputFile(path);
+                std::cout << "Results are written to " << path << " (overwritten by each query)\n";
             }
             continue;
         }
@@ -1,4 +1,5 @@
 #include "ModelTrainer.h"
+#include "SemanticCache.h"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -28,6 +29,7 @@ bool MLModelTrainer::loadDataset(const std::string& path) {
     std::cout << "Loaded " << dataset_.size() << " examples" << std::endl;
     
     buildVocabularies();
+    buildPrefixTrie();
     
     model_ = std::make_unique<Seq2SeqModel>(
         nl_vocab_.size(), 
@@ -35,6 +37,7 @@ bool MLModelTrainer::loadDataset(const std::string& path) {
         256,  // embedding_dim
         512   // hidden_dim
     );
+    buildGrammar();
     
     return true;
 }
@@ -50,6 +53,27 @@ void MLModelTrainer::buildVocabularies() {
     std::cout << "SQL Vocabulary size: " << sql_vocab_.size() << std::endl;
 }
 
+void MLModelTrainer::buildPrefixTrie() {
+    sql_prefixes_.clear();
+    for (const auto& example : dataset_) {
+        auto tokens = sql_vocab_.encode(example.sql_query);
+        // Drop SOS: drafts are matched against the tokens generated so far
+        tokens.erase(tokens.begin());
+        sql_prefixes_.insert(tokens);
+    }
+}
+
+void MLModelTrainer::buildGrammar() {
+    if (model_) {
+        sql_grammar_.build(sql_vocab_, schema_, model_->device_);
+    }
+}
+
+void MLModelTrainer::setSchema(const SqlTokenAutomaton::Schema& schema) {
+    schema_ = schema;
+    buildGrammar();
+}
+
 std::tuple<torch::Tensor, torch::Tensor> MLModelTrainer::prepareData(
     const TrainingExample& example) {
     
@@ -167,6 +191,9 @@ bool MLModelTrainer::save(const std::string& model_path) {
     nl_vocab_.save(model_path + "_nl_vocab.txt");
     sql_vocab_.save(model_path + "_sql_vocab.txt");
     
+    buildPrefixTrie();
+    sql_prefixes_.save(model_path + "_sql_prefixes.txt");
+    
     return true;
 }
 
@@ -181,7 +208,57 @@ bool MLModelTrainer::load(const std::string& model_path) {
         sql_vocab_.size()
     );
     
-    return model_->load(model_path);
+    // Prefix trie is optional: without it predict() falls back to plain greedy
+    if (!sql_prefixes_.load(model_path + "_sql_prefixes.txt")) {
+        buildPrefixTrie();
+    }
+    
+    if (!model_->load(model_path)) {
+        return false;
+    }
+    buildGrammar();
+    return true;
+}
+
+std::vector<int> MLModelTrainer::encodeQuery(const std::string& nl_query) const {
+    return nl_vocab_.encode(nl_query);
+}
+
+std::vector<float> MLModelTrainer::embed(const std::string& nl_query) {
+    if (!model_) {
+        return {};
+    }
+    return model_->embed(nl_vocab_.encode(nl_query));
+}
+
+SemanticCacheReport MLModelTrainer::evaluateSemanticCache(float threshold, size_t capacity) {
+    SemanticCacheReport report;
+    if (!model_ || dataset_.empty()) {
+        return report;
+    }
+    
+    std::unique_ptr<SemanticCache> cache;
+    for (const auto& example : dataset_) {
+        auto embedding = embed(example.nl_query);
+        if (!cache) {
+            cache = std::make_unique<SemanticCache>(embedding.size(), capacity, threshold);
+        }
+        
+        // Compare in the model's output form so formatting differences don't count
+        std::string reference = sql_vocab_.decode(sql_vocab_.encode(example.sql_query));
+        
+        report.lookups++;
+        if (auto match = cache->lookup(embedding)) {
+            report.hits++;
+            if (match->sql != reference) {
+                report.false_hits++;
+            }
+        } else {
+            cache->insert(embedding, reference, 1.0);
+        }
+    }
+    
+    return report;
 }
 
 std::string MLModelTrainer::predict(const std::string& nl_query) {
@@ -192,7 +269,11 @@ std::string MLModelTrainer::predict(const std::string& nl_query) {
     model_->eval();
     
     auto nl_indices = nl_vocab_.encode(nl_query);
-    auto sql_indices = model_->predict(nl_indices);
+    const SqlTokenAutomaton* grammar =
+        (constrained_decoding_ && sql_grammar_.ready()) ? &sql_grammar_ : nullptr;
+    auto sql_indices = (speculative_decoding_ && !sql_prefixes_.empty())
+        ? model_->predictSpeculative(nl_indices, sql_prefixes_, 50, 8, grammar)
+        : model_->predict(nl_indices, 50, grammar);
     
     return sql_vocab_.decode(sql_indices);
 }
@@ -13,6 +13,12 @@ struct TrainingExample {
     std::string sql_query;
 };
 
+struct SemanticCacheReport {
+    size_t lookups = 0;
+    size_t hits = 0;
+    size_t false_hits = 0;  // hit returned SQL different from the reference
+};
+
 class MLModelTrainer {
 public:
     MLModelTrainer();
@@ -23,14 +29,36 @@ public:
     bool load(const std::string& model_path);
     
     std::string predict(const std::string& nl_query);
+    // Token ids the model actually sees for `nl_query`
+    std::vector<int> encodeQuery(const std::string& nl_query) const;
+    // Encoder embedding of `nl_query` (see Seq2SeqModel::embed)
+    std::vector<float> embed(const std::string& nl_query);
+    
+    // Replay the loaded dataset through a SemanticCache filled with reference
+    // SQL: measures how often paraphrases hit and how often a hit is wrong
+    SemanticCacheReport evaluateSemanticCache(float threshold, size_t capacity);
+    
+    // Draft decoder steps from frequent SQL prefixes (see SqlPrefixTrie)
+    void setSpeculativeDecoding(bool enabled) { speculative_decoding_ = enabled; }
+    // Mask decoder logits with the SELECT grammar (see SqlTokenAutomaton)
+    void setConstrainedDecoding(bool enabled) { constrained_decoding_ = enabled; }
+    // Restrict table/column tokens to the live database schema
+    void setSchema(const SqlTokenAutomaton::Schema& schema);
     
 private:
     std::vector<TrainingExample> dataset_;
     Vocabulary nl_vocab_;
     Vocabulary sql_vocab_;
     std::unique_ptr<Seq2SeqModel> model_;
+    SqlPrefixTrie sql_prefixes_;
+    bool speculative_decoding_ = true;
+    SqlTokenAutomaton sql_grammar_;
+    SqlTokenAutomaton::Schema schema_;
+    bool constrained_decoding_ = true;
     
     void buildVocabularies();
+    void buildPrefixTrie();
+    void buildGrammar();
     std::tuple<torch::Tensor, torch::Tensor> prepareData(const TrainingExample& example);
 };
 
@@ -0,0 +1,135 @@
+#include "SemanticCache.h"
+#include "src/utils/SimdDistance.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+SemanticCache::SemanticCache(size_t dim, size_t capacity, float threshold)
+    : dim_(dim),
+      capacity_(std::max<size_t>(capacity, 1)),
+      threshold_(threshold),
+      vectors_(capacity_ * dim),
+      slots_(capacity_) {
+    // ~sqrt(N) lists and 1/8 of them probed keeps recall high at a fraction of a flat scan
+    maxLists_ = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(capacity_))));
+    nprobe_ = std::max<size_t>(2, maxLists_ / 8);
+    centroids_.reserve(maxLists_ * dim_);
+}
+
+size_t SemanticCache::nearestList(const float* v, float& similarity) const {
+    size_t best = 0;
+    similarity = -2.0f;
+    for (size_t l = 0; l < lists_.size(); ++l) {
+        float s = Utils::dotProduct(v, centroidAt(l), dim_);
+        if (s > similarity) {
+            similarity = s;
+            best = l;
+        }
+    }
+    return best;
+}
+
+std::optional<SemanticCache::Match> SemanticCache::lookup(const std::vector<float>& embedding) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (embedding.size() != dim_ || size_ == 0) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    const float* query = embedding.data();
+
+    std::vector<std::pair<float, uint32_t>> ranked;
+    ranked.reserve(lists_.size());
+    for (size_t l = 0; l < lists_.size(); ++l) {
+        ranked.emplace_back(Utils::dotProduct(query, centroidAt(l), dim_), static_cast<uint32_t>(l));
+    }
+    size_t probes = std::min(nprobe_, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + probes, ranked.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    float bestSimilarity = -2.0f;
+    size_t bestSlot = 0;
+    for (size_t p = 0; p < probes; ++p) {
+        for (uint32_t slot : lists_[ranked[p].second]) {
+            float s = Utils::dotProduct(query, vectorAt(slot), dim_);
+            if (s > bestSimilarity) {
+                bestSimilarity = s;
+                bestSlot = slot;
+            }
+        }
+    }
+
+    if (bestSimilarity < threshold_) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return Match{slots_[bestSlot].sql, slots_[bestSlot].confidence, bestSimilarity};
+}
+
+void SemanticCache::removeFromList(size_t slot) {
+    auto& list = lists_[slots_[slot].list];
+    uint32_t pos = slots_[slot].pos;
+    uint32_t moved = list.back();
+    list[pos] = moved;
+    slots_[moved].pos = pos;
+    list.pop_back();
+    slots_[slot].used = false;
+}
+
+void SemanticCache::insert(const std::vector<float>& embedding, const std::string& sql, double confidence) {
+    if (embedding.size() != dim_) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    size_t slot = next_;
+    next_ = (next_ + 1) % capacity_;
+    if (slots_[slot].used) {
+        removeFromList(slot);
+    } else {
+        size_++;
+    }
+
+    std::copy(embedding.begin(), embedding.end(), vectors_.begin() + slot * dim_);
+
+    // A vector that no existing leader would answer for starts a new list
+    float similarity = -2.0f;
+    size_t list = lists_.empty() ? 0 : nearestList(embedding.data(), similarity);
+    if (lists_.empty() || (similarity < threshold_ && lists_.size() < maxLists_)) {
+        list = lists_.size();
+        lists_.emplace_back();
+        centroids_.insert(centroids_.end(), embedding.begin(), embedding.end());
+    }
+
+    slots_[slot].sql = sql;
+    slots_[slot].confidence = confidence;
+    slots_[slot].list = static_cast<uint32_t>(list);
+    slots_[slot].pos = static_cast<uint32_t>(lists_[list].size());
+    slots_[slot].used = true;
+    lists_[list].push_back(static_cast<uint32_t>(slot));
+}
+
+void SemanticCache::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    centroids_.clear();
+    lists_.clear();
+    for (auto& slot : slots_) {
+        slot = Slot{};
+    }
+    next_ = 0;
+    size_ = 0;
+}
+
+SemanticCache::Stats SemanticCache::stats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    Stats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.entries = size_;
+    s.lists = lists_.size();
+    return s;
+}
@@ -0,0 +1,72 @@
+#ifndef SEMANTIC_CACHE_H
+#define SEMANTIC_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Approximate cache from encoder embeddings to generated SQL.
+// Entries are grouped into inverted lists around leader vectors (online IVF):
+// a lookup ranks the leaders, scans the closest `nprobe` lists with SIMD dot
+// products and returns the best entry whose cosine similarity reaches the
+// threshold. Embeddings must be L2-normalised. Eviction is FIFO.
+class SemanticCache {
+public:
+    struct Match {
+        std::string sql;
+        double confidence;
+        float similarity;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+        size_t lists = 0;
+    };
+
+    SemanticCache(size_t dim, size_t capacity, float threshold);
+
+    std::optional<Match> lookup(const std::vector<float>& embedding) const;
+    void insert(const std::vector<float>& embedding, const std::string& sql, double confidence);
+    void clear();
+
+    Stats stats() const;
+    float threshold() const { return threshold_; }
+
+private:
+    struct Slot {
+        std::string sql;
+        double confidence = 0.0;
+        uint32_t list = 0;
+        uint32_t pos = 0;
+        bool used = false;
+    };
+
+    const float* vectorAt(size_t slot) const { return vectors_.data() + slot * dim_; }
+    const float* centroidAt(size_t list) const { return centroids_.data() + list * dim_; }
+    size_t nearestList(const float* v, float& similarity) const;
+    void removeFromList(size_t slot);
+
+    size_t dim_;
+    size_t capacity_;
+    float threshold_;
+    size_t maxLists_;
+    size_t nprobe_;
+
+    std::vector<float> centroids_;                // lists_.size() x dim_
+    std::vector<std::vector<uint32_t>> lists_;    // slot ids per list
+    std::vector<float> vectors_;                  // capacity_ x dim_
+    std::vector<Slot> slots_;
+    size_t next_ = 0;                             // FIFO write position
+    size_t size_ = 0;
+
+    mutable std::shared_mutex mutex_;
+    mutable std::atomic<uint64_t> hits_{0};
+    mutable std::atomic<uint64_t> misses_{0};
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Seq2SeqModel.h"
+#include "src/utils/SimdDistance.h"
 
 EncoderImpl::EncoderImpl(int vocab_size, int embedding_dim, int hidden_dim)
     : hidden_dim_(hidden_dim) {
@@ -49,6 +50,21 @@ std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> DecoderImpl::forward(
                           std::get<1>(hidden_tuple));
 }
 
+std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> DecoderImpl::forwardSequence(
+    torch::Tensor inputs, torch::Tensor hidden, torch::Tensor cell) {
+    
+    auto embedded = embedding_->forward(inputs);
+    auto lstm_out = lstm_->forward(embedded, std::make_tuple(hidden, cell));
+    
+    // fc_ is applied position-wise: (seq_len, batch, hidden) -> (seq_len, batch, vocab)
+    auto predictions = fc_->forward(std::get<0>(lstm_out));
+    
+    auto hidden_tuple = std::get<1>(lstm_out);
+    return std::make_tuple(predictions, 
+                          std::get<0>(hidden_tuple), 
+                          std::get<1>(hidden_tuple));
+}
+
 Seq2SeqModel::Seq2SeqModel(int input_vocab_size, int output_vocab_size, 
                            int embedding_dim, int hidden_dim)
     : encoder_(Encoder(input_vocab_size, embedding_dim, hidden_dim)),
@@ -88,7 +104,8 @@ torch::Tensor Seq2SeqModel::forward(torch::Tensor src, torch::Tensor trg) {
     return outputs;
 }
 
-std::vector<int> Seq2SeqModel::predict(const std::vector<int>& input, int max_length) {
+std::vector<int> Seq2SeqModel::predict(const std::vector<int>& input, int max_length,
+                                      const SqlTokenAutomaton* grammar) {
     encoder_->eval();
     decoder_->eval();
     
@@ -99,6 +116,7 @@ std::vector<int> Seq2SeqModel::predict(const std::vector<int>& input, int max_le
     
     std::vector<int> result;
     int current_token = 1; // SOS_TOKEN
+    SqlTokenAutomaton::State state;
     
     for (int i = 0; i < max_length; i++) {
         auto input_tensor = torch::tensor({current_token}).to(device_);
@@ -107,18 +125,140 @@ std::vector<int> Seq2SeqModel::predict(const std::vector<int>& input, int max_le
         hidden = hidden_new;
         cell = cell_new;
         
+        if (grammar) {
+            if (!grammar->canContinue(state)) {
+                return {};
+            }
+            output = output + grammar->mask(state);
+        }
+        
         current_token = output.argmax(1).item<int>();
         
         if (current_token == 2) { // EOS_TOKEN
-            break;
+            return result;
         }
         
+        if (grammar) {
+            grammar->advance(state, current_token);
+        }
         result.push_back(current_token);
     }
     
+    // Under a grammar a statement cut off by max_length is not valid SQL
+    if (grammar && !grammar->accepts(state)) {
+        return {};
+    }
     return result;
 }
 
+std::vector<int> Seq2SeqModel::predictSpeculative(const std::vector<int>& input,
+                                                  const SqlPrefixTrie& prefixes,
+                                                  int max_length, int max_draft,
+                                                  const SqlTokenAutomaton* grammar) {
+    encoder_->eval();
+    decoder_->eval();
+    
+    torch::NoGradGuard no_grad;
+    
+    auto src = torch::tensor(input).unsqueeze(1).to(device_);
+    auto [hidden, cell] = encoder_->forward(src);
+    
+    std::vector<int> result;
+    int current_token = 1; // SOS_TOKEN
+    SqlTokenAutomaton::State state;
+    
+    while (static_cast<int>(result.size()) < max_length) {
+        // A pass over k+1 tokens yields k+1 greedy predictions, so never draft
+        // more than the remaining length budget can use
+        int budget = max_length - static_cast<int>(result.size());
+        auto draft = prefixes.propose(result, std::min(max_draft, budget - 1));
+        
+        // Grammar state before each position; the draft stops at the first
+        // token the grammar rejects since greedy could never produce it
+        std::vector<SqlTokenAutomaton::State> states{state};
+        if (grammar) {
+            for (size_t j = 0; j < draft.size(); ++j) {
+                auto next = states.back();
+                if (!grammar->advance(next, draft[j])) {
+                    draft.resize(j);
+                    break;
+                }
+                states.push_back(next);
+            }
+        }
+        
+        std::vector<int64_t> steps;
+        steps.reserve(draft.size() + 1);
+        steps.push_back(current_token);
+        steps.insert(steps.end(), draft.begin(), draft.end());
+        
+        auto steps_tensor = torch::tensor(steps, torch::kLong).unsqueeze(1).to(device_);
+        auto [output, hidden_new, cell_new] = decoder_->forwardSequence(steps_tensor, hidden, cell);
+        
+        if (grammar) {
+            output = output + grammar->masks(states).unsqueeze(1);
+        }
+        
+        // greedy[j] is the greedy token after consuming steps[0..j]
+        auto greedy = output.argmax(2).squeeze(1).to(torch::kCPU);
+        auto greedy_acc = greedy.accessor<int64_t, 1>();
+        
+        size_t consumed = 0;
+        while (true) {
+            if (grammar && !grammar->canContinue(state)) {
+                return {};
+            }
+            int token = static_cast<int>(greedy_acc[consumed]);
+            if (token == 2) { // EOS_TOKEN
+                return result;
+            }
+            if (grammar) {
+                grammar->advance(state, token);
+            }
+            result.push_back(token);
+            if (static_cast<int>(result.size()) >= max_length) {
+                return (grammar && !grammar->accepts(state)) ? std::vector<int>{} : result;
+            }
+            if (consumed < draft.size() && token == draft[consumed]) {
+                // Draft token confirmed, the next prediction is valid as well
+                consumed++;
+                continue;
+            }
+            current_token = token;
+            break;
+        }
+        
+        if (consumed == draft.size()) {
+            hidden = hidden_new;
+            cell = cell_new;
+        } else {
+            // The LSTM only exposes the state after the whole draft, so replay
+            // the accepted part to get the state greedy decoding would have
+            auto accepted = steps_tensor.slice(0, 0, static_cast<int64_t>(consumed) + 1);
+            auto [unused, hidden_acc, cell_acc] = decoder_->forwardSequence(accepted, hidden, cell);
+            hidden = hidden_acc;
+            cell = cell_acc;
+        }
+    }
+    
+    return result;
+}
+
+std::vector<float> Seq2SeqModel::embed(const std::vector<int>& input) {
+    encoder_->eval();
+    
+    torch::NoGradGuard no_grad;
+    
+    auto src = torch::tensor(input).unsqueeze(1).to(device_);
+    auto [hidden, cell] = encoder_->forward(src);
+    
+    auto flat = hidden.reshape({-1}).to(torch::kCPU).contiguous();
+    const float* data = flat.data_ptr<float>();
+    std::vector<float> embedding(data, data + flat.numel());
+    Utils::normalize(embedding.data(), embedding.size());
+    return embedding;
+}
+
 void Seq2SeqModel::train() {
     encoder_->train();
     decoder_->train();
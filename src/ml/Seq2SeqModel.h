@@ -1,6 +1,8 @@
 #ifndef SEQ2SEQ_MODEL_H
 #define SEQ2SEQ_MODEL_H
 
+#include "SqlPrefixTrie.h"
+#include "SqlTokenAutomaton.h"
 #include <torch/torch.h>
 #include <string>
 #include <vector>
@@ -27,6 +29,13 @@ public:
         torch::Tensor hidden, 
         torch::Tensor cell
     );
+    // Run a whole token sequence (seq_len, batch) through the decoder in one
+    // pass; returns logits of shape (seq_len, batch, vocab) and the final state
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> forwardSequence(
+        torch::Tensor inputs,
+        torch::Tensor hidden,
+        torch::Tensor cell
+    );
     // Expose output vocabulary size (number of classes)
     int output_vocab_size() const { return static_cast<int>(fc_->options.out_features()); }
     
@@ -44,7 +53,21 @@ public:
                  int embedding_dim = 256, int hidden_dim = 512);
     
     torch::Tensor forward(torch::Tensor src, torch::Tensor trg);
-    std::vector<int> predict(const std::vector<int>& input, int max_length = 50);
+    // With `grammar` set, logits are masked every step so only statements the
+    // automaton accepts can be produced; returns empty if none fits max_length
+    std::vector<int> predict(const std::vector<int>& input, int max_length = 50,
+                             const SqlTokenAutomaton* grammar = nullptr);
+    // Greedy decoding with drafts from `prefixes`: every decoder pass verifies
+    // the drafted tokens at once and keeps the longest prefix greedy decoding
+    // agrees with. Produces the same tokens as predict() in fewer steps.
+    std::vector<int> predictSpeculative(const std::vector<int>& input,
+                                        const SqlPrefixTrie& prefixes,
+                                        int max_length = 50,
+                                        int max_draft = 8,
+                                        const SqlTokenAutomaton* grammar = nullptr);
+    
+    // L2-normalised encoder final hidden state, used as a semantic key
+    std::vector<float> embed(const std::vector<int>& input);
     
     void train();
     void eval();
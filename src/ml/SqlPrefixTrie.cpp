@@ -0,0 +1,119 @@
+#include "SqlPrefixTrie.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+SqlPrefixTrie::SqlPrefixTrie(int max_depth, int min_count)
+    : max_depth_(max_depth), min_count_(min_count) {
+    nodes_.emplace_back();
+}
+
+void SqlPrefixTrie::clear() {
+    nodes_.clear();
+    nodes_.emplace_back();
+    sequences_.clear();
+}
+
+void SqlPrefixTrie::insert(const std::vector<int>& tokens, int count) {
+    if (tokens.empty() || count <= 0) {
+        return;
+    }
+
+    size_t depth = std::min(tokens.size(), static_cast<size_t>(max_depth_));
+    std::vector<int> truncated(tokens.begin(), tokens.begin() + depth);
+    sequences_[truncated] += count;
+
+    int node = 0;
+    nodes_[node].count += count;
+    for (int token : truncated) {
+        auto it = nodes_[node].children.find(token);
+        int child;
+        if (it == nodes_[node].children.end()) {
+            child = static_cast<int>(nodes_.size());
+            nodes_[node].children[token] = child;
+            nodes_.emplace_back();
+        } else {
+            child = it->second;
+        }
+        nodes_[child].count += count;
+
+        // Keep the most frequent continuation up to date for propose()
+        int best = nodes_[node].best_token;
+        if (best < 0 || nodes_[child].count > nodes_[nodes_[node].children[best]].count) {
+            nodes_[node].best_token = token;
+        }
+        node = child;
+    }
+}
+
+std::vector<int> SqlPrefixTrie::propose(const std::vector<int>& prefix, int max_tokens) const {
+    std::vector<int> draft;
+    if (max_tokens <= 0 || static_cast<int>(prefix.size()) >= max_depth_) {
+        return draft;
+    }
+
+    int node = 0;
+    for (int token : prefix) {
+        auto it = nodes_[node].children.find(token);
+        if (it == nodes_[node].children.end()) {
+            return draft;
+        }
+        node = it->second;
+    }
+
+    while (static_cast<int>(draft.size()) < max_tokens) {
+        int best = nodes_[node].best_token;
+        if (best < 0) {
+            break;
+        }
+        int child = nodes_[node].children.at(best);
+        if (nodes_[child].count < min_count_) {
+            break;
+        }
+        draft.push_back(best);
+        node = child;
+    }
+
+    return draft;
+}
+
+bool SqlPrefixTrie::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    for (const auto& [tokens, count] : sequences_) {
+        file << count << "\t";
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (i > 0) file << " ";
+            file << tokens[i];
+        }
+        file << "\n";
+    }
+
+    return true;
+}
+
+bool SqlPrefixTrie::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    clear();
+
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            continue;
+        }
+        int count = std::stoi(line.substr(0, tab));
+        std::istringstream ids(line.substr(tab + 1));
+        std::vector<int> tokens;
+        int id;
+        while (ids >> id) {
+            tokens.push_back(id);
+        }
+        insert(tokens, count);
+    }
+
+    return true;
+}
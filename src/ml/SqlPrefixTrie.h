@@ -0,0 +1,43 @@
+#ifndef SQL_PREFIX_TRIE_H
+#define SQL_PREFIX_TRIE_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Trie of frequent SQL token prefixes mined from the training targets.
+// Used by Seq2SeqModel::predictSpeculative to draft multi-token continuations
+// that are then verified against greedy decoding in a single decoder pass.
+class SqlPrefixTrie {
+public:
+    explicit SqlPrefixTrie(int max_depth = 16, int min_count = 2);
+
+    // Add an encoded SQL target (without SOS, EOS included) `count` times.
+    void insert(const std::vector<int>& tokens, int count = 1);
+
+    // Follow `prefix` from the root and return up to `max_tokens` of the most
+    // frequent continuation. Empty if the prefix is not in the trie.
+    std::vector<int> propose(const std::vector<int>& prefix, int max_tokens) const;
+
+    bool empty() const { return sequences_.empty(); }
+    void clear();
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    struct Node {
+        int count = 0;
+        int best_token = -1;  // most frequent child
+        std::unordered_map<int, int> children;  // token id -> node index
+    };
+
+    std::vector<Node> nodes_;
+    // Truncated sequences with their frequencies, kept for save()
+    std::map<std::vector<int>, int> sequences_;
+    int max_depth_;
+    int min_count_;
+};
+
+#endif
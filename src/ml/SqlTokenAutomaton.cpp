@@ -0,0 +1,398 @@
+#include "SqlTokenAutomaton.h"
+#include <cctype>
+#include <initializer_list>
+#include <limits>
+#include <set>
+#include <unordered_map>
+
+namespace {
+
+enum TokenClass : uint8_t {
+    kOther,        // unknown word: only valid inside a string literal
+    kSpecial,      // <PAD>, <SOS>, <UNK>
+    kEos,
+    kSelect, kDistinct, kFrom, kWhere, kAndOr, kNot,
+    kGroup, kOrder, kBy, kHaving, kLimit, kOffset, kDirection,
+    kJoin, kJoinModifier, kOn,
+    kLike, kIs, kIn, kNull,
+    kFunction,
+    kStar, kComma, kLParen, kRParen, kEq, kLt, kGt, kBang,
+    kNumber, kString, kStringOpen, kStringClose,
+    kTable, kColumn,
+    kIdentifier,   // table or column when no schema is known
+    kClassCount
+};
+
+enum Node : int8_t {
+    kStart, kSelectHead, kSelectItem, kAfterItem,
+    kFuncOpenSel, kFuncArgSel, kFuncDistinctSel, kFuncCloseSel,
+    kTableName, kAfterTable, kJoinKw, kJoinTable, kJoinOn,
+    kCondLhs, kFuncOpenCond, kFuncArgCond, kFuncCloseCond,
+    kCondOp, kCondOpNot, kAfterLt, kAfterGt, kAfterBang, kCondRhs,
+    kAfterIs, kAfterIsNot, kInOpen, kInValue, kInAfterValue,
+    kStringCond, kStringIn,
+    kAfterCond,    // placeholder: resolved to State::afterCond on entry
+    kAfterJoinCond, kAfterWhereCond, kAfterHavingCond,
+    kGroupBy, kGroupCol, kAfterGroupCol,
+    kOrderBy, kOrderCol, kAfterOrderCol, kAfterOrderDir,
+    kLimitValue, kAfterLimit, kOffsetValue, kEnd,
+    kNodeCount
+};
+
+constexpr int kReject = -1;
+constexpr int kMaxDepth = 8;
+constexpr int kDepthVariants = 3;  // depth == 0, inside parentheses, at kMaxDepth
+
+const std::initializer_list<uint8_t> kColumnLike = {kColumn, kIdentifier};
+const std::initializer_list<uint8_t> kTableLike = {kTable, kIdentifier};
+const std::initializer_list<uint8_t> kValues = {kNumber, kString, kColumn, kIdentifier};
+
+bool isTerminal(int node) {
+    switch (node) {
+        case kAfterTable: case kAfterJoinCond: case kAfterWhereCond: case kAfterHavingCond:
+        case kAfterGroupCol:
+        case kAfterOrderCol: case kAfterOrderDir: case kAfterLimit: case kEnd:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isStringNode(int node) {
+    return node == kStringCond || node == kStringIn;
+}
+
+// Clause keywords are only valid outside parentheses
+bool isClause(uint8_t cls) {
+    switch (cls) {
+        case kFrom: case kWhere: case kGroup: case kOrder: case kHaving:
+        case kLimit: case kOffset: case kJoin: case kJoinModifier:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool isNumber(const std::string& word) {
+    size_t i = (word.size() > 1 && word[0] == '-') ? 1 : 0;
+    bool digit = false;
+    for (; i < word.size(); ++i) {
+        if (std::isdigit(static_cast<unsigned char>(word[i]))) {
+            digit = true;
+        } else if (word[i] != '.') {
+            return false;
+        }
+    }
+    return digit;
+}
+
+bool isIdentifier(const std::string& word) {
+    if (word.empty() || !(std::isalpha(static_cast<unsigned char>(word[0])) || word[0] == '_')) {
+        return false;
+    }
+    int dots = 0;
+    for (char c : word) {
+        if (c == '.') {
+            dots++;
+        } else if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return dots <= 1 && word.back() != '.';
+}
+
+uint8_t classify(const std::string& word,
+                 const SqlTokenAutomaton::Schema& schema,
+                 const std::set<std::string>& columns) {
+    static const std::unordered_map<std::string, uint8_t> keywords = {
+        {"select", kSelect}, {"distinct", kDistinct}, {"from", kFrom},
+        {"where", kWhere}, {"and", kAndOr}, {"or", kAndOr}, {"not", kNot},
+        {"group", kGroup}, {"order", kOrder}, {"by", kBy}, {"having", kHaving},
+        {"limit", kLimit}, {"offset", kOffset}, {"asc", kDirection}, {"desc", kDirection},
+        {"join", kJoin}, {"left", kJoinModifier}, {"right", kJoinModifier},
+        {"inner", kJoinModifier}, {"outer", kJoinModifier}, {"full", kJoinModifier},
+        {"on", kOn}, {"like", kLike}, {"ilike", kLike}, {"is", kIs}, {"in", kIn},
+        {"null", kNull}, {"true", kNull}, {"false", kNull},
+        {"count", kFunction}, {"sum", kFunction}, {"avg", kFunction},
+        {"min", kFunction}, {"max", kFunction},
+        {"*", kStar}, {",", kComma}, {"(", kLParen}, {")", kRParen},
+        {"=", kEq}, {"<", kLt}, {">", kGt}, {"!", kBang},
+        {"<EOS>", kEos}, {"<PAD>", kSpecial}, {"<SOS>", kSpecial}, {"<UNK>", kSpecial}
+    };
+
+    auto it = keywords.find(word);
+    if (it != keywords.end()) {
+        return it->second;
+    }
+
+    if (isNumber(word)) {
+        return kNumber;
+    }
+
+    // Vocabulary splits multi-word literals on spaces: 'new york' -> 'new, york'
+    if (word.empty()) {
+        return kOther;
+    }
+    bool opens = word.front() == '\'';
+    bool closes = word.back() == '\'';
+    if (opens && closes && word.size() >= 2) return kString;
+    if (opens) return kStringOpen;
+    if (closes) return kStringClose;
+
+    if (!isIdentifier(word)) {
+        return kOther;
+    }
+    if (schema.empty()) {
+        return kIdentifier;
+    }
+    if (schema.count(word)) {
+        return kTable;
+    }
+
+    size_t dot = word.find('.');
+    if (dot == std::string::npos) {
+        return columns.count(word) ? kColumn : kOther;
+    }
+    auto table = schema.find(word.substr(0, dot));
+    if (table == schema.end()) {
+        return kOther;
+    }
+    std::string column = word.substr(dot + 1);
+    for (const auto& name : table->second) {
+        if (name == column) {
+            return kColumn;
+        }
+    }
+    return kOther;
+}
+
+} // namespace
+
+SqlTokenAutomaton::SqlTokenAutomaton()
+    : next_(kNodeCount, std::vector<int8_t>(kClassCount, kReject)) {
+
+    auto on = [this](int node, std::initializer_list<uint8_t> classes, int target) {
+        for (auto cls : classes) {
+            next_[node][cls] = static_cast<int8_t>(target);
+        }
+    };
+
+    on(kStart, {kSelect}, kSelectHead);
+
+    on(kSelectHead, {kDistinct}, kSelectItem);
+    on(kSelectHead, {kStar}, kAfterItem);
+    on(kSelectHead, kColumnLike, kAfterItem);
+    on(kSelectHead, {kFunction}, kFuncOpenSel);
+    on(kSelectItem, {kStar}, kAfterItem);
+    on(kSelectItem, kColumnLike, kAfterItem);
+    on(kSelectItem, {kFunction}, kFuncOpenSel);
+    on(kAfterItem, {kComma}, kSelectItem);
+    on(kAfterItem, {kFrom}, kTableName);
+
+    on(kFuncOpenSel, {kLParen}, kFuncArgSel);
+    on(kFuncArgSel, {kStar}, kFuncCloseSel);
+    on(kFuncArgSel, kColumnLike, kFuncCloseSel);
+    on(kFuncArgSel, {kDistinct}, kFuncDistinctSel);
+    on(kFuncDistinctSel, kColumnLike, kFuncCloseSel);
+    on(kFuncCloseSel, {kRParen}, kAfterItem);
+
+    on(kTableName, kTableLike, kAfterTable);
+
+    // Clauses that may follow a table or a finished condition: only those
+    // that come later in a SELECT than the clause the condition belongs to
+    for (int node : {kAfterTable, kAfterJoinCond}) {
+        on(node, {kWhere}, kCondLhs);
+        on(node, {kJoin}, kJoinTable);
+        on(node, {kJoinModifier}, kJoinKw);
+    }
+    for (int node : {kAfterTable, kAfterJoinCond, kAfterWhereCond}) {
+        on(node, {kGroup}, kGroupBy);
+    }
+    for (int node : {kAfterTable, kAfterJoinCond, kAfterWhereCond, kAfterHavingCond}) {
+        on(node, {kOrder}, kOrderBy);
+        on(node, {kLimit}, kLimitValue);
+    }
+    on(kJoinKw, {kJoin}, kJoinTable);
+    on(kJoinKw, {kJoinModifier}, kJoinKw);
+    on(kJoinTable, kTableLike, kJoinOn);
+    on(kJoinOn, {kOn}, kCondLhs);
+
+    on(kCondLhs, kColumnLike, kCondOp);
+    on(kCondLhs, {kLParen, kNot}, kCondLhs);
+    on(kCondLhs, {kFunction}, kFuncOpenCond);
+    on(kFuncOpenCond, {kLParen}, kFuncArgCond);
+    on(kFuncArgCond, {kStar}, kFuncCloseCond);
+    on(kFuncArgCond, kColumnLike, kFuncCloseCond);
+    on(kFuncCloseCond, {kRParen}, kCondOp);
+
+    on(kCondOp, {kEq, kLike}, kCondRhs);
+    on(kCondOp, {kLt}, kAfterLt);
+    on(kCondOp, {kGt}, kAfterGt);
+    on(kCondOp, {kBang}, kAfterBang);
+    on(kCondOp, {kIs}, kAfterIs);
+    on(kCondOp, {kIn}, kInOpen);
+    on(kCondOp, {kNot}, kCondOpNot);
+    on(kCondOpNot, {kLike}, kCondRhs);
+    on(kCondOpNot, {kIn}, kInOpen);
+
+    // "<=", "<>" and ">=" arrive as two tokens
+    on(kAfterLt, {kEq, kGt}, kCondRhs);
+    on(kAfterLt, kValues, kAfterCond);
+    on(kAfterLt, {kStringOpen}, kStringCond);
+    on(kAfterGt, {kEq}, kCondRhs);
+    on(kAfterGt, kValues, kAfterCond);
+    on(kAfterGt, {kStringOpen}, kStringCond);
+    on(kAfterBang, {kEq}, kCondRhs);
+    on(kCondRhs, kValues, kAfterCond);
+    on(kCondRhs, {kNull}, kAfterCond);
+    on(kCondRhs, {kStringOpen}, kStringCond);
+
+    on(kAfterIs, {kNull}, kAfterCond);
+    on(kAfterIs, {kNot}, kAfterIsNot);
+    on(kAfterIsNot, {kNull}, kAfterCond);
+
+    on(kInOpen, {kLParen}, kInValue);
+    on(kInValue, {kNumber, kString}, kInAfterValue);
+    on(kInValue, {kStringOpen}, kStringIn);
+    on(kInAfterValue, {kComma}, kInValue);
+    on(kInAfterValue, {kRParen}, kAfterCond);
+
+    // Anything but control tokens and new literals may appear inside a string
+    for (int node : {kStringCond, kStringIn}) {
+        for (int cls = 0; cls < kClassCount; ++cls) {
+            if (cls != kSpecial && cls != kEos && cls != kString && cls != kStringOpen) {
+                next_[node][cls] = static_cast<int8_t>(node);
+            }
+        }
+    }
+    on(kStringCond, {kStringClose}, kAfterCond);
+    on(kStringIn, {kStringClose}, kInAfterValue);
+
+    for (int node : {kAfterJoinCond, kAfterWhereCond, kAfterHavingCond}) {
+        on(node, {kAndOr}, kCondLhs);
+        on(node, {kRParen}, kAfterCond);
+    }
+
+    on(kGroupBy, {kBy}, kGroupCol);
+    on(kGroupCol, kColumnLike, kAfterGroupCol);
+    on(kAfterGroupCol, {kComma}, kGroupCol);
+    on(kAfterGroupCol, {kHaving}, kCondLhs);
+    on(kAfterGroupCol, {kOrder}, kOrderBy);
+    on(kAfterGroupCol, {kLimit}, kLimitValue);
+
+    on(kOrderBy, {kBy}, kOrderCol);
+    on(kOrderCol, kColumnLike, kAfterOrderCol);
+    on(kAfterOrderCol, {kDirection}, kAfterOrderDir);
+    on(kAfterOrderCol, {kComma}, kOrderCol);
+    on(kAfterOrderCol, {kLimit}, kLimitValue);
+    on(kAfterOrderDir, {kComma}, kOrderCol);
+    on(kAfterOrderDir, {kLimit}, kLimitValue);
+
+    on(kLimitValue, {kNumber}, kAfterLimit);
+    on(kAfterLimit, {kOffset}, kOffsetValue);
+    on(kOffsetValue, {kNumber}, kEnd);
+}
+
+void SqlTokenAutomaton::build(const Vocabulary& vocab, const Schema& schema, torch::Device device) {
+    std::set<std::string> columns;
+    for (const auto& [table, tableColumns] : schema) {
+        columns.insert(tableColumns.begin(), tableColumns.end());
+    }
+
+    vocabSize_ = vocab.size();
+    classes_.assign(vocabSize_, kOther);
+    for (int id = 0; id < vocabSize_; ++id) {
+        classes_[id] = classify(vocab.getWord(id), schema, columns);
+    }
+
+    const int rows = kNodeCount * kDepthVariants;
+    const int depthForVariant[kDepthVariants] = {0, 1, kMaxDepth};
+
+    allowedCount_.assign(rows, 0);
+    std::vector<float> masks(static_cast<size_t>(rows) * vocabSize_,
+                             -std::numeric_limits<float>::infinity());
+
+    for (int node = 0; node < kNodeCount; ++node) {
+        for (int variant = 0; variant < kDepthVariants; ++variant) {
+            State state{node, depthForVariant[variant]};
+            int r = row(state);
+            for (int id = 0; id < vocabSize_; ++id) {
+                if (allows(state, id)) {
+                    masks[static_cast<size_t>(r) * vocabSize_ + id] = 0.0f;
+                    allowedCount_[r]++;
+                }
+            }
+        }
+    }
+
+    masks_ = torch::tensor(masks).reshape({rows, vocabSize_}).to(device);
+}
+
+int SqlTokenAutomaton::row(const State& state) const {
+    int variant = state.depth == 0 ? 0 : (state.depth < kMaxDepth ? 1 : 2);
+    return state.node * kDepthVariants + variant;
+}
+
+bool SqlTokenAutomaton::allows(const State& state, int token) const {
+    if (token < 0 || token >= vocabSize_) {
+        return false;
+    }
+    uint8_t cls = classes_[token];
+
+    if (cls == kEos) {
+        return accepts(state);
+    }
+    if (next_[state.node][cls] == kReject) {
+        return false;
+    }
+    if (isStringNode(state.node)) {
+        return true;
+    }
+    if (cls == kRParen && state.depth == 0) return false;
+    if (cls == kLParen && state.depth >= kMaxDepth) return false;
+    if (state.depth > 0 && isClause(cls)) return false;
+    return true;
+}
+
+bool SqlTokenAutomaton::advance(State& state, int token) const {
+    if (!allows(state, token)) {
+        return false;
+    }
+    uint8_t cls = classes_[token];
+    if (cls == kEos) {
+        state.node = kEnd;
+        return true;
+    }
+    if (!isStringNode(state.node)) {
+        if (cls == kLParen) state.depth++;
+        if (cls == kRParen) state.depth--;
+        if (cls == kOn) state.afterCond = kAfterJoinCond;
+        if (cls == kWhere) state.afterCond = kAfterWhereCond;
+        if (cls == kHaving) state.afterCond = kAfterHavingCond;
+    }
+    int target = next_[state.node][cls];
+    state.node = target == kAfterCond ? state.afterCond : target;
+    return true;
+}
+
+bool SqlTokenAutomaton::accepts(const State& state) const {
+    return isTerminal(state.node) && state.depth == 0;
+}
+
+bool SqlTokenAutomaton::canContinue(const State& state) const {
+    return ready() && allowedCount_[row(state)] > 0;
+}
+
+torch::Tensor SqlTokenAutomaton::mask(const State& state) const {
+    return masks_[row(state)];
+}
+
+torch::Tensor SqlTokenAutomaton::masks(const std::vector<State>& states) const {
+    std::vector<int64_t> rows;
+    rows.reserve(states.size());
+    for (const auto& state : states) {
+        rows.push_back(row(state));
+    }
+    auto index = torch::tensor(rows, torch::kLong).to(masks_.device());
+    return masks_.index_select(0, index);
+}
@@ -0,0 +1,59 @@
+#ifndef SQL_TOKEN_AUTOMATON_H
+#define SQL_TOKEN_AUTOMATON_H
+
+#include "Vocabulary.h"
+#include <torch/torch.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Deterministic automaton over SQL vocabulary ids that accepts the read-only
+// SELECT subset the model is trained on. Every vocab id is mapped to a token
+// class once, transitions are a (node x class) table, and for every automaton
+// state an additive logits mask (0 / -inf) is precomputed, so constrained
+// decoding costs one tensor add per step.
+class SqlTokenAutomaton {
+public:
+    struct State {
+        int node = 0;
+        int depth = 0;  // open parentheses
+        int afterCond = 0;  // node reached when the current ON/WHERE/HAVING condition is complete
+    };
+
+    // Table name -> column names of the live schema. Empty: any identifier.
+    using Schema = std::map<std::string, std::vector<std::string>>;
+
+    SqlTokenAutomaton();
+
+    // Classify the vocabulary and precompute masks. Call on model load and
+    // whenever the schema changes. Masks are placed on `device`.
+    void build(const Vocabulary& vocab, const Schema& schema = {},
+               torch::Device device = torch::kCPU);
+    bool ready() const { return !classes_.empty(); }
+
+    State initial() const { return State{}; }
+    // Apply `token` to `state`; false if the grammar does not allow it
+    bool advance(State& state, int token) const;
+    bool allows(const State& state, int token) const;
+    // EOS is allowed, i.e. the tokens so far form a complete statement
+    bool accepts(const State& state) const;
+    // At least one token is allowed in this state
+    bool canContinue(const State& state) const;
+
+    // Additive mask of shape (vocab) for logits produced in `state`
+    torch::Tensor mask(const State& state) const;
+    // Masks stacked for several states: (states.size(), vocab)
+    torch::Tensor masks(const std::vector<State>& states) const;
+
+private:
+    int row(const State& state) const;
+
+    std::vector<uint8_t> classes_;            // vocab id -> token class
+    std::vector<std::vector<int8_t>> next_;   // node -> class -> next node (-1 rejects)
+    std::vector<int> allowedCount_;           // row -> number of allowed ids
+    torch::Tensor masks_;                     // (rows, vocab)
+    int vocabSize_ = 0;
+};
+
+#endif
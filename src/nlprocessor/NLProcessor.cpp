@@ -1,6 +1,7 @@
 #include "src/nlprocessor/NLProcessor.h"
 #include "src/utils/Logger.h"
 #include "src/ml/ModelTrainer.h"
+#include "src/ml/SemanticCache.h"
 #include <sstream>
 
 NLProcessor::~NLProcessor() {}
@@ -11,37 +12,122 @@ NLProcessor::NLProcessor() {
 }
 
 bool NLProcessor::initialize(const std::string& modelPath) {
-    Logger::getInstance().info("Initializing NLProcessor with model: " + modelPath);
+    LOG_INFO("Initializing NLProcessor with model: ", modelPath);
     modelPath_ = modelPath;
+    clearCache();
     modelLoaded_ = trainer_->load(modelPath);
     if (modelLoaded_) {
-        Logger::getInstance().info("Model loaded successfully");
+        LOG_INFO("Model loaded successfully");
         return true;
     }
-    Logger::getInstance().warning("Failed to load model from: " + modelPath);
+    LOG_WARNING("Failed to load model from: ", modelPath);
     return false;
 }
 
 bool NLProcessor::trainModel(const std::string& trainingDataPath, const std::string& modelOutputPath) {
-    Logger::getInstance().info("Training model from: " + trainingDataPath);
+    LOG_INFO("Training model from: ", trainingDataPath);
     if (!trainer_->loadDataset(trainingDataPath)) {
-        Logger::getInstance().error("Failed to load training data");
+        LOG_ERROR("Failed to load training data");
         return false;
     }
     if (!trainer_->train()) {
-        Logger::getInstance().error("Model training failed");
+        LOG_ERROR("Model training failed");
         return false;
     }
     if (!trainer_->save(modelOutputPath)) {
-        Logger::getInstance().error("Failed to save model");
+        LOG_ERROR("Failed to save model");
         return false;
     }
     modelPath_ = modelOutputPath;
     modelLoaded_ = true;
-    Logger::getInstance().info("Model trained and saved successfully");
+    clearCache();
+    LOG_INFO("Model trained and saved successfully");
     return true;
 }
 
+void NLProcessor::setSpeculativeDecoding(bool enabled) {
+    trainer_->setSpeculativeDecoding(enabled);
+}
+
+void NLProcessor::setConstrainedDecoding(bool enabled) {
+    trainer_->setConstrainedDecoding(enabled);
+    clearCache();
+}
+
+void NLProcessor::setSchema(const std::map<std::string, std::vector<std::string>>& schema) {
+    LOG_INFO("Decoding restricted to ", schema.size(), " tables");
+    trainer_->setSchema(schema);
+    clearCache();
+}
+
+void NLProcessor::configureCache(size_t byteBudget, size_t shardCount) {
+    if (byteBudget == 0) {
+        cache_.reset();
+        LOG_INFO("NL query cache disabled");
+        return;
+    }
+    cache_ = std::make_unique<ShardedLruCache<ProcessingResult>>(byteBudget, shardCount);
+    LOG_INFO("NL query cache: ", byteBudget, " bytes, ",
+             shardCount, " shards");
+}
+
+void NLProcessor::configureSemanticCache(size_t capacity, double threshold) {
+    std::lock_guard<std::mutex> lock(semanticMutex_);
+    semanticCapacity_ = capacity;
+    semanticThreshold_ = threshold;
+    semanticCache_.reset();
+    if (capacity == 0) {
+        LOG_INFO("Semantic query cache disabled");
+    } else {
+        LOG_INFO("Semantic query cache: ", capacity,
+                 " entries, threshold ", threshold);
+    }
+}
+
+void NLProcessor::clearCache() {
+    if (cache_) {
+        cache_->clear();
+    }
+    // Эмбеддинги зависят от модели, поэтому индекс строится заново
+    std::lock_guard<std::mutex> lock(semanticMutex_);
+    semanticCache_.reset();
+}
+
+NLProcessor::CacheStats NLProcessor::getCacheStats() const {
+    return cache_ ? cache_->stats() : CacheStats{};
+}
+
+NLProcessor::SemanticCacheStats NLProcessor::getSemanticCacheStats() const {
+    SemanticCacheStats stats;
+    std::shared_ptr<SemanticCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(semanticMutex_);
+        cache = semanticCache_;
+    }
+    if (cache) {
+        auto s = cache->stats();
+        stats.hits = s.hits;
+        stats.misses = s.misses;
+        stats.entries = s.entries;
+        stats.lists = s.lists;
+    }
+    return stats;
+}
+
+std::shared_ptr<SemanticCache> NLProcessor::semanticCache(size_t dim) {
+    std::lock_guard<std::mutex> lock(semanticMutex_);
+    if (!semanticCache_ && semanticCapacity_ > 0 && dim > 0) {
+        semanticCache_ = std::make_shared<SemanticCache>(
+            dim, semanticCapacity_, static_cast<float>(semanticThreshold_));
+    }
+    return semanticCache_;
+}
+
+std::string NLProcessor::cacheKey(const std::string& naturalLanguageQuery) const {
+    auto ids = trainer_->encodeQuery(naturalLanguageQuery);
+    return std::string(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(int));
+}
+
 NLProcessor::ProcessingResult NLProcessor::processQueryDetailed(const std::string& naturalLanguageQuery) {
     ProcessingResult result;
     result.success = false;
@@ -51,7 +137,34 @@ NLProcessor::ProcessingResult NLProcessor::processQueryDetailed(const std::strin
         initialize(modelPath_);
     }
 
-    Logger::getInstance().info("Processing query: " + naturalLanguageQuery);
+    LOG_INFO("Processing query: ", naturalLanguageQuery);
+
+    std::string key;
+    if (cache_ && modelLoaded_) {
+        key = cacheKey(naturalLanguageQuery);
+        if (auto cached = cache_->get(key)) {
+            LOG_INFO("Cached SQL: ", cached->sqlQuery);
+            return *cached;
+        }
+    }
+
+    std::vector<float> embedding;
+    std::shared_ptr<SemanticCache> semantic;
+    if (semanticCapacity_ > 0 && modelLoaded_) {
+        embedding = trainer_->embed(naturalLanguageQuery);
+        semantic = semanticCache(embedding.size());
+        if (semantic) {
+            if (auto match = semantic->lookup(embedding)) {
+                // Декодер не запускается: берём SQL ближайшего перефразированного запроса
+                result.sqlQuery = match->sql;
+                result.confidence = match->confidence * match->similarity;
+                result.success = true;
+                LOG_INFO("Semantic cache hit (similarity ",
+                         match->similarity, "): ", match->sql);
+                return result;
+            }
+        }
+    }
 
     try {
         std::string sql = trainer_->predict(naturalLanguageQuery);
@@ -59,7 +172,13 @@ NLProcessor::ProcessingResult NLProcessor::processQueryDetailed(const std::strin
             result.sqlQuery = sql;
             result.confidence = 0.85;
             result.success = true;
-            Logger::getInstance().info("Predicted SQL: " + sql);
+            LOG_INFO("Predicted SQL: ", sql);
+            if (!key.empty()) {
+                cache_->put(key, result, sizeof(ProcessingResult) + sql.size());
+            }
+            if (semantic) {
+                semantic->insert(embedding, sql, result.confidence);
+            }
         } else {
             result.success = false;
             result.errorMessage = "Empty prediction";
@@ -67,7 +186,7 @@ NLProcessor::ProcessingResult NLProcessor::processQueryDetailed(const std::strin
     } catch (const std::exception& e) {
         result.success = false;
         result.errorMessage = e.what();
-        Logger::getInstance().error("Query processing failed: " + result.errorMessage);
+        LOG_ERROR("Query processing failed: ", result.errorMessage);
     }
 
     return result;
@@ -1,11 +1,16 @@
 #ifndef NL_PROCESSOR_H
 #define NL_PROCESSOR_H
 
+#include "src/utils/ShardedLruCache.h"
+#include <atomic>
 #include <string>
 #include <vector>
+#include <map>
 #include <memory>
+#include <mutex>
 
 class MLModelTrainer; // forward declaration
+class SemanticCache;
 
 class NLProcessor {
 public:
@@ -17,6 +22,19 @@ public:
     
     std::string processQuery(const std::string& naturalLanguageQuery);
     
+    // Спекулятивное декодирование по частым SQL-префиксам
+    void setSpeculativeDecoding(bool enabled);
+    // Ограничение генерации грамматикой SELECT и схемой БД
+    void setConstrainedDecoding(bool enabled);
+    void setSchema(const std::map<std::string, std::vector<std::string>>& schema);
+    
+    // Кэш NL -> SQL; byteBudget == 0 отключает кэширование
+    void configureCache(size_t byteBudget, size_t shardCount);
+    // Второй уровень: поиск перефразировок по эмбеддингу энкодера;
+    // capacity == 0 отключает
+    void configureSemanticCache(size_t capacity, double threshold);
+    void clearCache();
+    
     struct ProcessingResult {
         std::string sqlQuery;
         double confidence;
@@ -27,9 +45,33 @@ public:
     };
     
     ProcessingResult processQueryDetailed(const std::string& naturalLanguageQuery);
+    
+    using CacheStats = ShardedLruCache<ProcessingResult>::Stats;
+    CacheStats getCacheStats() const;
+    
+    struct SemanticCacheStats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t entries = 0;
+        size_t lists = 0;
+    };
+    SemanticCacheStats getSemanticCacheStats() const;
 
 private:
     std::unique_ptr<MLModelTrainer> trainer_;
+    // Ключ - результат Vocabulary::encode, поэтому запросы, отличающиеся
+    // регистром или пробелами, попадают в одну запись
+    std::unique_ptr<ShardedLruCache<ProcessingResult>> cache_;
+    // Создаётся при первом запросе, когда известна размерность эмбеддинга.
+    // Указатель меняется под semanticMutex_; сам индекс потокобезопасен,
+    // поэтому поиск и вставка идут по копии указателя без блокировки
+    std::shared_ptr<SemanticCache> semanticCache_;
+    mutable std::mutex semanticMutex_;
+    std::shared_ptr<SemanticCache> semanticCache(size_t dim);
+    std::atomic<size_t> semanticCapacity_{0};
+    double semanticThreshold_ = 0.95;
+    
+    std::string cacheKey(const std::string& naturalLanguageQuery) const;
     bool modelLoaded_;
     std::string modelPath_;
 };
@@ -1,9 +1,32 @@
 #include "src/utils/Logger.h"
+#include <algorithm>
+#include <ctime>
+#include <strings.h>
+#include <utility>
 #include <iostream>
 
-Logger::Logger() : currentLevel_(LogLevel::INFO) {}
+namespace {
+    // Буфер слота сверх этого размера освобождается после вывода, чтобы одно
+    // длинное сообщение не держало память в очереди
+    constexpr size_t kMaxRetainedText = 64 * 1024;
+}
+
+Logger::Logger() : slots_(new Slot[kQueueSize]) {
+    for (size_t i = 0; i < kQueueSize; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread(&Logger::run, this);
+}
 
 Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
     if (logFile_.is_open()) {
         logFile_.close();
     }
@@ -15,7 +38,7 @@ Logger& Logger::getInstance() {
 }
 
 void Logger::setLogFile(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(fileMutex_);
     if (logFile_.is_open()) {
         logFile_.close();
     }
@@ -23,54 +46,187 @@ void Logger::setLogFile(const std::string& filename) {
 }
 
 void Logger::setLogLevel(LogLevel level) {
-    currentLevel_ = level;
+    currentLevel_.store(level, std::memory_order_relaxed);
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy) {
+    policy_.store(policy, std::memory_order_relaxed);
+}
+
+void Logger::setFlushInterval(std::chrono::milliseconds interval) {
+    flushIntervalMs_.store(std::max<int64_t>(interval.count(), 1), std::memory_order_relaxed);
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    static const std::pair<const char*, LogLevel> kLevels[] = {
+        {"DEBUG", LogLevel::DEBUG}, {"INFO", LogLevel::INFO}, {"WARNING", LogLevel::WARNING},
+        {"ERROR", LogLevel::ERROR}, {"CRITICAL", LogLevel::CRITICAL}
+    };
+    for (const auto& [text, value] : kLevels) {
+        if (strcasecmp(name.c_str(), text) == 0) {
+            level = value;
+            return true;
+        }
+    }
+    return false;
 }
 
 void Logger::debug(const std::string& message) {
-    log(LogLevel::DEBUG, message);
+    if (enabled(LogLevel::DEBUG)) write(LogLevel::DEBUG, message);
 }
 
 void Logger::info(const std::string& message) {
-    log(LogLevel::INFO, message);
+    if (enabled(LogLevel::INFO)) write(LogLevel::INFO, message);
 }
 
 void Logger::warning(const std::string& message) {
-    log(LogLevel::WARNING, message);
+    if (enabled(LogLevel::WARNING)) write(LogLevel::WARNING, message);
 }
 
 void Logger::error(const std::string& message) {
-    log(LogLevel::ERROR, message);
+    if (enabled(LogLevel::ERROR)) write(LogLevel::ERROR, message);
 }
 
 void Logger::critical(const std::string& message) {
-    log(LogLevel::CRITICAL, message);
-}
-
-void Logger::log(LogLevel level, const std::string& message) {
-    if (level < currentLevel_) return;
-    
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::string logMessage = "[" + getCurrentTime() + "] [" + 
-                            levelToString(level) + "] " + message;
-    
-    std::cout << logMessage << std::endl;
-    
+    if (enabled(LogLevel::CRITICAL)) write(LogLevel::CRITICAL, message);
+}
+
+Logger::Slot* Logger::reserve(size_t& pos) {
+    pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot* slot = &slots_[pos & (kQueueSize - 1)];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return slot;
+        } else if (diff < 0) {
+            // Очередь заполнена: фоновый поток ещё не забрал этот слот
+            if (policy_.load(std::memory_order_relaxed) == OverflowPolicy::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            wake_.notify_one();
+            std::this_thread::yield();
+            pos = tail_.load(std::memory_order_relaxed);
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(Slot* slot, size_t pos, LogLevel level) {
+    slot->level = level;
+    slot->time = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // ERROR и выше, а также наполовину заполненная очередь - не ждать интервала
+    if (level >= LogLevel::ERROR || pos - head_.load(std::memory_order_relaxed) == kQueueSize / 2) {
+        wake_.notify_one();
+    }
+    // После CRITICAL процесс может завершиться - сообщение должно дойти
+    if (level == LogLevel::CRITICAL) {
+        flush();
+    }
+}
+
+void Logger::flush() {
+    const size_t target = tail_.load(std::memory_order_acquire);
+    wake_.notify_one();
+    std::unique_lock<std::mutex> lock(flushMutex_);
+    while (head_.load(std::memory_order_acquire) < target) {
+        // Таймаут страхует от пропущенного уведомления
+        flushed_.wait_for(lock, std::chrono::milliseconds(10));
+        wake_.notify_one();
+    }
+}
+
+Logger::Stats Logger::getStats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.queued = tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Logger::run() {
+    std::string batch;
+    while (true) {
+        size_t count = drain(batch);
+        if (count > 0) {
+            write(batch);
+            batch.clear();
+            written_.fetch_add(count, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(flushMutex_);
+            }
+            flushed_.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        if (stopping_) {
+            // Слот мог быть занят, но ещё не опубликован - добрать его
+            if (tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_relaxed)) break;
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        wake_.wait_for(lock, std::chrono::milliseconds(flushIntervalMs_.load(std::memory_order_relaxed)));
+    }
+}
+
+size_t Logger::drain(std::string& batch) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    while (count < kBatchMessages) {
+        Slot& slot = slots_[head & (kQueueSize - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+
+        batch += '[';
+        appendTime(batch, slot.time);
+        batch += "] [";
+        batch += levelToString(slot.level);
+        batch += "] ";
+        batch += slot.text;
+        batch += '\n';
+        if (slot.text.capacity() > kMaxRetainedText) {
+            std::string().swap(slot.text);
+        }
+
+        slot.sequence.store(head + kQueueSize, std::memory_order_release);
+        ++head;
+        ++count;
+    }
+    head_.store(head, std::memory_order_release);
+    return count;
+}
+
+void Logger::write(const std::string& batch) {
+    // stderr, не stdout: в stdout потоком пишутся результаты запросов (CSV,
+    // JSON), и строка журнала посреди них испортила бы вывод
+    std::cerr.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+    std::cerr.flush();
+
+    std::lock_guard<std::mutex> lock(fileMutex_);
     if (logFile_.is_open()) {
-        logFile_ << logMessage << std::endl;
+        logFile_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
         logFile_.flush();
     }
 }
 
-std::string Logger::getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+void Logger::appendTime(std::string& out, int64_t time) {
+    if (time != cachedTime_) {
+        std::time_t seconds = static_cast<std::time_t>(time);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::strftime(cachedStamp_, sizeof(cachedStamp_), "%Y-%m-%d %H:%M:%S", &local);
+        cachedTime_ = time;
+    }
+    out += cachedStamp_;
 }
 
-std::string Logger::levelToString(LogLevel level) {
+const char* Logger::levelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
         case LogLevel::INFO: return "INFO";
@@ -1,13 +1,19 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <string>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
-#include <mutex>
 #include <memory>
-#include <sstream>
-#include <chrono>
-#include <iomanip>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
 
 enum class LogLevel {
     DEBUG,
@@ -17,33 +23,152 @@ enum class LogLevel {
     CRITICAL
 };
 
+// Асинхронный журнал. Вызывающий поток только кладёт сообщение в кольцевую
+// очередь (MPSC без блокировок: место занимается одним CAS, слот
+// публикуется номером последовательности) и не ждёт вывода. Фоновый поток
+// забирает сообщения пачками, форматирует время (раз в секунду, дальше из
+// кэша) и пишет пачку в stderr и файл одной операцией с одним flush.
+// Сообщения уровня ERROR и выше будят его сразу, остальные - не позже
+// flush-интервала. При заполненной очереди поведение задаёт OverflowPolicy.
 class Logger {
 public:
+    enum class OverflowPolicy {
+        Block,  // ждать места в очереди - сообщения не теряются
+        Drop    // отбросить сообщение и учесть в статистике
+    };
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0;
+        size_t queued = 0;
+    };
+
     static Logger& getInstance();
-    
+
     void setLogFile(const std::string& filename);
     void setLogLevel(LogLevel level);
-    
+    // DEBUG, INFO, WARNING, ERROR, CRITICAL (без учёта регистра)
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    void setOverflowPolicy(OverflowPolicy policy);
+    void setFlushInterval(std::chrono::milliseconds interval);
+
     void debug(const std::string& message);
     void info(const std::string& message);
     void warning(const std::string& message);
     void error(const std::string& message);
     void critical(const std::string& message);
-    
+
+    bool enabled(LogLevel level) const {
+        return level >= currentLevel_.load(std::memory_order_relaxed);
+    }
+
+    // Сообщение из частей (строки, числа, bool): части дописываются прямо в
+    // слот очереди, без промежуточных строк. Уровень не проверяется - это
+    // делают макросы LOG_* до вычисления аргументов
+    template <typename... Args>
+    void write(LogLevel level, const Args&... args) {
+        size_t pos = 0;
+        Slot* slot = reserve(pos);
+        if (!slot) return;
+        slot->text.clear();
+        (appendPart(slot->text, args), ...);
+        publish(slot, pos, level);
+    }
+
+    // Дождаться вывода всех сообщений, поставленных до вызова
+    void flush();
+    Stats getStats() const;
+
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
 private:
+    static constexpr size_t kQueueSize = 8192;  // степень двойки
+    static constexpr size_t kBatchMessages = 1024;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        int64_t time = 0;  // секунды от эпохи
+        std::string text;  // ёмкость переиспользуется следующими сообщениями
+    };
+
     Logger();
     ~Logger();
-    
-    void log(LogLevel level, const std::string& message);
-    std::string getCurrentTime();
-    std::string levelToString(LogLevel level);
-    
+
+    // Занять слот (nullptr - очередь полна и политика Drop) и опубликовать его
+    Slot* reserve(size_t& pos);
+    void publish(Slot* slot, size_t pos, LogLevel level);
+
+    static void appendPart(std::string& out, const std::string& part) { out += part; }
+    static void appendPart(std::string& out, std::string_view part) { out += part; }
+    static void appendPart(std::string& out, const char* part) { out += part ? part : "(null)"; }
+    static void appendPart(std::string& out, char part) { out += part; }
+    static void appendPart(std::string& out, bool part) { out += part ? "true" : "false"; }
+    template <typename T>
+    static std::enable_if_t<std::is_integral<T>::value> appendPart(std::string& out, T part) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), part);
+        out.append(buffer, result.ptr);
+    }
+    template <typename T>
+    static std::enable_if_t<std::is_floating_point<T>::value> appendPart(std::string& out, T part) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(part));
+        out.append(buffer, static_cast<size_t>(length));
+    }
+    void run();
+    size_t drain(std::string& batch);
+    void write(const std::string& batch);
+    void appendTime(std::string& out, int64_t time);
+    static const char* levelToString(LogLevel level);
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> tail_{0};  // следующая позиция записи
+    alignas(64) std::atomic<size_t> head_{0};  // следующая позиция чтения (только фоновый поток)
+
+    std::atomic<LogLevel> currentLevel_{LogLevel::INFO};
+    std::atomic<OverflowPolicy> policy_{OverflowPolicy::Block};
+    std::atomic<int64_t> flushIntervalMs_{100};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::mutex flushMutex_;
+    std::condition_variable flushed_;
+
+    std::mutex fileMutex_;
     std::ofstream logFile_;
-    LogLevel currentLevel_;
-    std::mutex mutex_;
+
+    // Кэш отформатированного времени (только фоновый поток)
+    int64_t cachedTime_ = -1;
+    char cachedStamp_[32] = {};
+
+    std::thread writer_;
 };
 
+// Порог уровня при компиляции (0 - DEBUG ... 4 - CRITICAL, задаётся опцией
+// CMake LOG_COMPILE_LEVEL): вызовы ниже порога удаляются компилятором
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+// Уровень проверяется до вычисления аргументов: отфильтрованный вызов не
+// строит строк и не выделяет память
+#define LOG_AT(level, ...)                                                              \
+    do {                                                                                \
+        if (static_cast<int>(level) >= LOG_COMPILE_LEVEL &&                             \
+            Logger::getInstance().enabled(level)) {                                     \
+            Logger::getInstance().write(level, __VA_ARGS__);                            \
+        }                                                                               \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+#define LOG_CRITICAL(...) LOG_AT(LogLevel::CRITICAL, __VA_ARGS__)
+
 #endif // LOGGER_H
\ No newline at end of file
@@ -0,0 +1,150 @@
+#ifndef PATTERN_MATCHER_H
+#define PATTERN_MATCHER_H
+
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Поиск набора образцов за один проход по тексту (автомат Ахо-Корасик).
+// Автомат строится один раз из списка образцов (встроенного или из
+// конфигурации) и превращается в полный DFA: на каждый байт текста -
+// одна загрузка из таблицы переходов, без возвратов. Регистр ASCII не
+// учитывается. Находятся все вхождения, в том числе перекрывающиеся.
+class PatternMatcher {
+public:
+    struct Match {
+        size_t pattern;  // номер образца в списке
+        size_t offset;   // начало вхождения в тексте
+        size_t length;
+    };
+
+    PatternMatcher() { build({}); }
+    explicit PatternMatcher(const std::vector<std::string>& patterns) { build(patterns); }
+
+    // Пустые образцы пропускаются
+    void build(const std::vector<std::string>& patterns) {
+        patterns_ = patterns;
+        buildAlphabet();
+
+        // Бор: переходы только по существующим рёбрам (0 - нет ребра)
+        transitions_.assign(alphabet_, 0);
+        std::vector<std::vector<uint32_t>> outputs(1);
+        for (size_t p = 0; p < patterns_.size(); ++p) {
+            if (patterns_[p].empty()) continue;
+            uint32_t state = 0;
+            for (char c : patterns_[p]) {
+                size_t cls = classes_[static_cast<unsigned char>(c)];
+                uint32_t& next = transitions_[state * alphabet_ + cls];
+                if (next == 0) {
+                    next = static_cast<uint32_t>(outputs.size());
+                    outputs.emplace_back();
+                    transitions_.resize(transitions_.size() + alphabet_, 0);
+                }
+                state = transitions_[state * alphabet_ + cls];
+            }
+            outputs[state].push_back(static_cast<uint32_t>(p));
+        }
+
+        // Обход в ширину: ссылки на наибольший собственный суффикс, недостающие
+        // переходы берутся у суффикса, выходы суффикса добавляются к своим
+        const size_t states = outputs.size();
+        std::vector<uint32_t> fail(states, 0);
+        std::queue<uint32_t> queue;
+        for (size_t cls = 0; cls < alphabet_; ++cls) {
+            if (uint32_t next = transitions_[cls]) queue.push(next);
+        }
+        while (!queue.empty()) {
+            uint32_t state = queue.front();
+            queue.pop();
+            const auto& inherited = outputs[fail[state]];
+            outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+            for (size_t cls = 0; cls < alphabet_; ++cls) {
+                uint32_t& next = transitions_[state * alphabet_ + cls];
+                uint32_t viaFail = transitions_[fail[state] * alphabet_ + cls];
+                if (next != 0) {
+                    fail[next] = viaFail;
+                    queue.push(next);
+                } else {
+                    next = viaFail;
+                }
+            }
+        }
+
+        // Выходы всех состояний одним массивом
+        outputStart_.assign(states + 1, 0);
+        outputPatterns_.clear();
+        for (size_t s = 0; s < states; ++s) {
+            outputStart_[s] = static_cast<uint32_t>(outputPatterns_.size());
+            outputPatterns_.insert(outputPatterns_.end(), outputs[s].begin(), outputs[s].end());
+        }
+        outputStart_[states] = static_cast<uint32_t>(outputPatterns_.size());
+    }
+
+    size_t size() const { return patterns_.size(); }
+    const std::string& pattern(size_t index) const { return patterns_[index]; }
+
+    // onMatch(const Match&) для каждого вхождения в порядке их окончания;
+    // false из onMatch прекращает поиск
+    template <typename OnMatch>
+    void scan(std::string_view text, OnMatch&& onMatch) const {
+        uint32_t state = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = transitions_[state * alphabet_ + classes_[static_cast<unsigned char>(text[i])]];
+            for (uint32_t k = outputStart_[state]; k < outputStart_[state + 1]; ++k) {
+                size_t length = patterns_[outputPatterns_[k]].size();
+                if (!onMatch(Match{outputPatterns_[k], i + 1 - length, length})) return;
+            }
+        }
+    }
+
+    std::vector<Match> findAll(std::string_view text) const {
+        std::vector<Match> matches;
+        scan(text, [&matches](const Match& m) {
+            matches.push_back(m);
+            return true;
+        });
+        return matches;
+    }
+
+    bool contains(std::string_view text) const {
+        bool found = false;
+        scan(text, [&found](const Match&) {
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+private:
+    // Байты, встречающиеся в образцах, получают свои классы (без учёта
+    // регистра), остальные - класс 0: строка таблицы переходов короткая
+    void buildAlphabet() {
+        for (auto& cls : classes_) cls = 0;
+        alphabet_ = 1;
+        for (const auto& p : patterns_) {
+            for (char c : p) {
+                unsigned char b = static_cast<unsigned char>(fold(c));
+                // Не больше 230 различных байтов после свёртки: класс помещается в uint8_t
+                if (classes_[b] == 0) classes_[b] = static_cast<uint8_t>(alphabet_++);
+            }
+        }
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            classes_[c] = classes_[c - 'A' + 'a'];
+        }
+    }
+
+    static char fold(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    std::vector<std::string> patterns_;
+    uint8_t classes_[256] = {};
+    size_t alphabet_ = 1;
+    std::vector<uint32_t> transitions_;   // состояние * alphabet_ + класс -> состояние
+    std::vector<uint32_t> outputStart_;   // выходы состояния s: [outputStart_[s], outputStart_[s + 1])
+    std::vector<uint32_t> outputPatterns_;
+};
+
+#endif // PATTERN_MATCHER_H
@@ -0,0 +1,193 @@
+#ifndef SHARDED_LRU_CACHE_H
+#define SHARDED_LRU_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Потокобезопасный LRU-кэш со строковыми ключами и бюджетом в байтах.
+// Ключи распределяются по шардам по хэшу, у каждого шарда свой мьютекс и
+// своя доля бюджета, поэтому обращения к разным шардам не конкурируют.
+// Записи могут иметь TTL: просроченная запись удаляется при обращении.
+template <typename Value>
+class ShardedLruCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t expirations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t byteBudget = 0;
+    };
+
+    explicit ShardedLruCache(size_t byteBudget, size_t shardCount = 16)
+        : byteBudget_(byteBudget) {
+        if (shardCount == 0) shardCount = 1;
+        shardBudget_ = byteBudget / shardCount;
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    std::optional<Value> get(const std::string& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        if (it->second->expires < Clock::now()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+            expirations_.fetch_add(1, std::memory_order_relaxed);
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        // Перемещение в голову списка без перевыделения узла
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    // valueBytes - оценка размера значения; ключ и служебные данные учитываются сами.
+    // ttl == 0 - запись живёт до вытеснения
+    void put(const std::string& key, Value value, size_t valueBytes,
+             Clock::duration ttl = Clock::duration::zero()) {
+        size_t bytes = key.size() + valueBytes + kEntryOverhead;
+        if (bytes > shardBudget_) {
+            return;
+        }
+
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+
+        auto expires = ttl > Clock::duration::zero() ? Clock::now() + ttl : Clock::time_point::max();
+        shard.lru.push_front(Entry{key, std::move(value), bytes, expires});
+        shard.index[key] = shard.lru.begin();
+        shard.bytes += bytes;
+
+        while (shard.bytes > shardBudget_ && !shard.lru.empty()) {
+            auto& victim = shard.lru.back();
+            shard.bytes -= victim.bytes;
+            shard.index.erase(victim.key);
+            shard.lru.pop_back();
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool erase(const std::string& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+        shard.bytes -= it->second->bytes;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        return true;
+    }
+
+    // Удалить все записи, для которых pred(key, value) == true
+    size_t eraseIf(const std::function<bool(const std::string&, const Value&)>& pred) {
+        size_t erased = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (auto it = shard->lru.begin(); it != shard->lru.end();) {
+                if (pred(it->key, it->value)) {
+                    shard->bytes -= it->bytes;
+                    shard->index.erase(it->key);
+                    it = shard->lru.erase(it);
+                    erased++;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return erased;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->lru.clear();
+            shard->index.clear();
+            shard->bytes = 0;
+        }
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.evictions = evictions_.load(std::memory_order_relaxed);
+        s.expirations = expirations_.load(std::memory_order_relaxed);
+        s.byteBudget = byteBudget_;
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            s.entries += shard->index.size();
+            s.bytes += shard->bytes;
+        }
+        return s;
+    }
+
+    ShardedLruCache(const ShardedLruCache&) = delete;
+    ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+private:
+    // Примерная стоимость узла списка и записи хэш-таблицы
+    static constexpr size_t kEntryOverhead = 96;
+
+    struct Entry {
+        std::string key;
+        Value value;
+        size_t bytes;
+        Clock::time_point expires;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(const std::string& key) {
+        return *shards_[std::hash<std::string>{}(key) % shards_.size()];
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t byteBudget_;
+    size_t shardBudget_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> expirations_{0};
+};
+
+#endif // SHARDED_LRU_CACHE_H
@@ -0,0 +1,112 @@
+#ifndef SIMD_DISTANCE_H
+#define SIMD_DISTANCE_H
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UTILS_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define UTILS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace Utils {
+    namespace detail {
+        inline float dotScalar(const float* a, const float* b, size_t n) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+#if defined(UTILS_SIMD_X86)
+        // SSE2 входит в базовый x86-64, поэтому это безопасный запасной путь
+        inline float dotSse(const float* a, const float* b, size_t n) {
+            __m128 acc0 = _mm_setzero_ps();
+            __m128 acc1 = _mm_setzero_ps();
+            const size_t blocks = n - n % 8;
+            size_t i = 0;
+            for (; i < blocks; i += 8) {
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+            }
+            __m128 acc = _mm_add_ps(acc0, acc1);
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 0x55));
+            float sum = _mm_cvtss_f32(acc);
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline float dotAvx2(const float* a, const float* b, size_t n) {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            const size_t pairs = n - n % 16;
+            const size_t blocks = n - n % 8;
+            size_t i = 0;
+            for (; i < pairs; i += 16) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+            }
+            for (; i < blocks; i += 8) {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            }
+            __m256 acc = _mm256_add_ps(acc0, acc1);
+            __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+            sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 0x55));
+            float sum = _mm_cvtss_f32(sum4);
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+#elif defined(UTILS_SIMD_NEON)
+        inline float dotNeon(const float* a, const float* b, size_t n) {
+            float32x4_t acc0 = vdupq_n_f32(0.0f);
+            float32x4_t acc1 = vdupq_n_f32(0.0f);
+            const size_t blocks = n - n % 8;
+            size_t i = 0;
+            for (; i < blocks; i += 8) {
+                acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+                acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            }
+            float sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+            for (; i < n; ++i) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+#endif
+    }
+
+    // Скалярное произведение; AVX2/FMA выбирается во время выполнения
+    inline float dotProduct(const float* a, const float* b, size_t n) {
+#if defined(UTILS_SIMD_X86)
+        static const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        return hasAvx2 ? detail::dotAvx2(a, b, n) : detail::dotSse(a, b, n);
+#elif defined(UTILS_SIMD_NEON)
+        return detail::dotNeon(a, b, n);
+#else
+        return detail::dotScalar(a, b, n);
+#endif
+    }
+
+    // Нормировка на единичную длину: после неё косинусная близость = dotProduct
+    inline void normalize(float* v, size_t n) {
+        float norm = std::sqrt(dotProduct(v, v, n));
+        if (norm > 0.0f) {
+            for (size_t i = 0; i < n; ++i) {
+                v[i] /= norm;
+            }
+        }
+    }
+}
+
+#endif // SIMD_DISTANCE_H
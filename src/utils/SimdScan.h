@@ -0,0 +1,177 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define UTILS_SIMD_X86 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define UTILS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Поиск байтов, требующих особой обработки при выводе, блоками по 16 байт.
+// Форматтеры копируют участки между найденными позициями целиком (memcpy),
+// не разбирая текст побайтно.
+namespace Utils {
+    namespace detail {
+        inline bool isJsonSpecial(unsigned char c) {
+            return c == '"' || c == '\\' || c < 0x20;
+        }
+
+        inline size_t firstBit(unsigned mask) {
+            return static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+
+    // Первый байт, который нельзя скопировать в строку JSON как есть
+    // ('"', '\\', управляющие < 0x20); size, если таких нет
+    inline size_t findJsonSpecial(const char* data, size_t size) {
+        size_t i = 0;
+#if defined(UTILS_SIMD_X86)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // max(v, 0x1F) == 0x1F  <=>  v <= 0x1F без знака
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                       _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+            if (mask) return i + detail::firstBit(mask);
+        }
+#elif defined(UTILS_SIMD_NEON)
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t control = vdupq_n_u8(0x20);
+        for (; i + 16 <= size; i += 16) {
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+            uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, control));
+            if (vmaxvq_u8(hit)) break;  // позицию в блоке найдёт скалярный хвост
+        }
+#endif
+        for (; i < size; ++i) {
+            if (detail::isJsonSpecial(static_cast<unsigned char>(data[i]))) return i;
+        }
+        return size;
+    }
+
+    // Первый байт, из-за которого поле CSV нужно брать в кавычки
+    // (разделитель, '"', '\n', '\r'); size, если таких нет
+    inline size_t findCsvSpecial(const char* data, size_t size, char delimiter) {
+        size_t i = 0;
+#if defined(UTILS_SIMD_X86)
+        const __m128i delim = _mm_set1_epi8(delimiter);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        auto scan = [&](size_t at) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + at));
+            __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, delim), _mm_cmpeq_epi8(v, quote)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+            return static_cast<unsigned>(_mm_movemask_epi8(hit));
+        };
+        for (; i + 16 <= size; i += 16) {
+            unsigned mask = scan(i);
+            if (mask) return i + detail::firstBit(mask);
+        }
+        // Хвост - последним блоком внахлёст с уже проверенными байтами
+        if (i < size && size >= 16) {
+            unsigned mask = scan(size - 16) >> (16 - (size - i));
+            return mask ? i + detail::firstBit(mask) : size;
+        }
+#elif defined(UTILS_SIMD_NEON)
+        const uint8x16_t delim = vdupq_n_u8(static_cast<uint8_t>(delimiter));
+        const uint8x16_t quote = vdupq_n_u8('"');
+        const uint8x16_t lf = vdupq_n_u8('\n');
+        const uint8x16_t cr = vdupq_n_u8('\r');
+        for (; i + 16 <= size; i += 16) {
+            uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+            uint8x16_t hit = vorrq_u8(vorrq_u8(vceqq_u8(v, delim), vceqq_u8(v, quote)),
+                                      vorrq_u8(vceqq_u8(v, lf), vceqq_u8(v, cr)));
+            if (vmaxvq_u8(hit)) break;
+        }
+#endif
+        for (; i < size; ++i) {
+            char c = data[i];
+            if (c == delimiter || c == '"' || c == '\n' || c == '\r') return i;
+        }
+        return size;
+    }
+
+    // Все байты < 0x80
+    inline bool isAscii(const char* data, size_t size) {
+        size_t i = 0;
+#if defined(UTILS_SIMD_X86)
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            if (_mm_movemask_epi8(v)) return false;
+        }
+#elif defined(UTILS_SIMD_NEON)
+        for (; i + 16 <= size; i += 16) {
+            if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i))) & 0x80) return false;
+        }
+#endif
+        for (; i < size; ++i) {
+            if (static_cast<unsigned char>(data[i]) & 0x80) return false;
+        }
+        return true;
+    }
+
+    // Длина корректной последовательности UTF-8 в начале data (1-4) или 0:
+    // недопустимый первый байт, обрыв, лишне длинная запись, суррогаты и
+    // значения больше U+10FFFF
+    inline size_t utf8SequenceLength(const char* data, size_t size) {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+        if (size == 0) return 0;
+        unsigned char c = s[0];
+        if (c < 0x80) return 1;
+
+        size_t length;
+        unsigned char low = 0x80;
+        unsigned char high = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0) low = 0xA0;
+            if (c == 0xED) high = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0) low = 0x90;
+            if (c == 0xF4) high = 0x8F;
+        } else {
+            return 0;
+        }
+
+        if (size < length) return 0;
+        if (s[1] < low || s[1] > high) return 0;
+        for (size_t k = 2; k < length; ++k) {
+            if ((s[k] & 0xC0) != 0x80) return 0;
+        }
+        return length;
+    }
+
+    // Весь текст - корректный UTF-8; ASCII-участки проходятся блоками
+    inline bool isValidUtf8(const char* data, size_t size) {
+        size_t i = 0;
+        while (i < size) {
+            if (!(static_cast<unsigned char>(data[i]) & 0x80)) {
+                size_t block = size - i < 16 ? size - i : 16;
+                if (isAscii(data + i, block)) {
+                    i += block;
+                    continue;
+                }
+                while (!(static_cast<unsigned char>(data[i]) & 0x80)) ++i;
+            }
+            size_t length = utf8SequenceLength(data + i, size - i);
+            if (length == 0) return false;
+            i += length;
+        }
+        return true;
+    }
+}
+
+#endif // SIMD_SCAN_H
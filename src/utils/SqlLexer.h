@@ -0,0 +1,212 @@
+#ifndef SQL_LEXER_H
+#define SQL_LEXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Разбор SQL (диалект PostgreSQL) на лексемы за один проход без выделения
+// памяти: лексема - вид и положение в исходном тексте. Строки ('...',
+// E'...', $тег$...$тег$), идентификаторы в кавычках и комментарии (в том
+// числе вложенные /* */) распознаются целиком, поэтому содержимое литералов
+// не путается с ключевыми словами и разделителями.
+namespace Utils {
+    enum class SqlTokenKind {
+        Word,              // ключевое слово или идентификатор без кавычек
+        QuotedIdentifier,  // "..."
+        String,            // '...', E'...', $$...$$
+        Number,
+        Parameter,         // $1
+        Operator,          // знаки операций и пунктуация, кроме ';'
+        Semicolon,
+        Comment,           // -- ... или /* ... */
+        End,
+        Error              // незакрытая строка, идентификатор или комментарий
+    };
+
+    struct SqlToken {
+        SqlTokenKind kind;
+        size_t offset;
+        size_t length;
+    };
+
+    class SqlLexer {
+    public:
+        explicit SqlLexer(std::string_view sql) : sql_(sql) {}
+
+        SqlToken next() {
+            skipSpace();
+            const size_t start = pos_;
+            if (pos_ >= sql_.size()) return {SqlTokenKind::End, start, 0};
+
+            const char c = sql_[pos_];
+            const char n = pos_ + 1 < sql_.size() ? sql_[pos_ + 1] : '\0';
+
+            if (c == '-' && n == '-') {
+                while (pos_ < sql_.size() && sql_[pos_] != '\n') ++pos_;
+                return token(SqlTokenKind::Comment, start);
+            }
+            if (c == '/' && n == '*') return blockComment(start);
+            if (c == '\'') return quoted(start, '\'', SqlTokenKind::String, false);
+            if ((c == 'e' || c == 'E') && n == '\'') {
+                ++pos_;
+                return quoted(start, '\'', SqlTokenKind::String, true);
+            }
+            if (c == '"') return quoted(start, '"', SqlTokenKind::QuotedIdentifier, false);
+            if (c == '$') return dollar(start);
+            if (isDigit(c) || (c == '.' && isDigit(n))) return number(start);
+            if (isWordStart(c)) {
+                while (pos_ < sql_.size() && isWordChar(sql_[pos_])) ++pos_;
+                return token(SqlTokenKind::Word, start);
+            }
+            ++pos_;
+            return token(c == ';' ? SqlTokenKind::Semicolon : SqlTokenKind::Operator, start);
+        }
+
+        std::string_view text(const SqlToken& token) const {
+            return sql_.substr(token.offset, token.length);
+        }
+
+        static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+        // Буквы, '_' и байты UTF-8 (идентификаторы могут быть не ASCII)
+        static bool isWordStart(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+                   (static_cast<unsigned char>(c) & 0x80);
+        }
+        static bool isWordChar(char c) { return isWordStart(c) || isDigit(c) || c == '$'; }
+
+    private:
+        SqlToken token(SqlTokenKind kind, size_t start) const {
+            return {kind, start, pos_ - start};
+        }
+
+        void skipSpace() {
+            while (pos_ < sql_.size()) {
+                char c = sql_[pos_];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v') break;
+                ++pos_;
+            }
+        }
+
+        SqlToken blockComment(size_t start) {
+            pos_ += 2;
+            int depth = 1;
+            while (pos_ + 1 < sql_.size()) {
+                if (sql_[pos_] == '/' && sql_[pos_ + 1] == '*') {
+                    ++depth;
+                    pos_ += 2;
+                } else if (sql_[pos_] == '*' && sql_[pos_ + 1] == '/') {
+                    pos_ += 2;
+                    if (--depth == 0) return token(SqlTokenKind::Comment, start);
+                } else {
+                    ++pos_;
+                }
+            }
+            pos_ = sql_.size();
+            return token(SqlTokenKind::Error, start);
+        }
+
+        // Кавычка внутри удваивается; в E'...' ещё и экранируется '\'
+        SqlToken quoted(size_t start, char quote, SqlTokenKind kind, bool backslash) {
+            ++pos_;
+            while (pos_ < sql_.size()) {
+                char c = sql_[pos_++];
+                if (backslash && c == '\\') {
+                    ++pos_;
+                } else if (c == quote) {
+                    if (pos_ < sql_.size() && sql_[pos_] == quote) {
+                        ++pos_;
+                    } else {
+                        return token(kind, start);
+                    }
+                }
+            }
+            pos_ = sql_.size();
+            return token(SqlTokenKind::Error, start);
+        }
+
+        // $1 - параметр, $тег$...$тег$ - строка
+        SqlToken dollar(size_t start) {
+            ++pos_;
+            if (pos_ < sql_.size() && isDigit(sql_[pos_])) {
+                while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+                return token(SqlTokenKind::Parameter, start);
+            }
+            size_t tagEnd = pos_;
+            while (tagEnd < sql_.size() && sql_[tagEnd] != '$' && isWordChar(sql_[tagEnd])) ++tagEnd;
+            if (tagEnd >= sql_.size() || sql_[tagEnd] != '$') {
+                return token(SqlTokenKind::Operator, start);
+            }
+            std::string_view tag = sql_.substr(start, tagEnd + 1 - start);
+            size_t close = sql_.find(tag, tagEnd + 1);
+            if (close == std::string_view::npos) {
+                pos_ = sql_.size();
+                return token(SqlTokenKind::Error, start);
+            }
+            pos_ = close + tag.size();
+            return token(SqlTokenKind::String, start);
+        }
+
+        SqlToken number(size_t start) {
+            while (pos_ < sql_.size() && (isDigit(sql_[pos_]) || sql_[pos_] == '.' || sql_[pos_] == '_')) ++pos_;
+            if (pos_ < sql_.size() && (sql_[pos_] == 'e' || sql_[pos_] == 'E')) {
+                size_t exp = pos_ + 1;
+                if (exp < sql_.size() && (sql_[exp] == '+' || sql_[exp] == '-')) ++exp;
+                if (exp < sql_.size() && isDigit(sql_[exp])) {
+                    pos_ = exp;
+                    while (pos_ < sql_.size() && isDigit(sql_[pos_])) ++pos_;
+                }
+            }
+            return token(SqlTokenKind::Number, start);
+        }
+
+        std::string_view sql_;
+        size_t pos_ = 0;
+    };
+
+    // Множество ключевых слов с идеальной хеш-функцией, построенной при
+    // компиляции: слово проверяется одним сравнением без учёта регистра.
+    // Хеш - первая и последняя буквы и длина; отсутствие коллизий для
+    // набора проверяется static_assert у места объявления.
+    template <size_t N>
+    class KeywordSet {
+    public:
+        static constexpr size_t kSlots = 32;
+        static constexpr size_t kMaxLength = 16;
+
+        constexpr explicit KeywordSet(const std::string_view (&words)[N]) : slots_{} {
+            for (size_t i = 0; i < N; ++i) {
+                size_t h = hash(words[i]);
+                if (!slots_[h].empty()) collisions_++;
+                slots_[h] = words[i];
+            }
+        }
+
+        constexpr bool perfect() const { return collisions_ == 0; }
+
+        // Слово в нижнем регистре (ASCII) совпадает с одним из набора
+        constexpr bool contains(std::string_view word) const {
+            if (word.empty() || word.size() > kMaxLength) return false;
+            std::string_view candidate = slots_[hash(word)];
+            if (candidate.size() != word.size()) return false;
+            for (size_t i = 0; i < word.size(); ++i) {
+                if (lower(word[i]) != candidate[i]) return false;
+            }
+            return true;
+        }
+
+    private:
+        static constexpr char lower(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+        static constexpr size_t hash(std::string_view word) {
+            return (static_cast<size_t>(static_cast<unsigned char>(lower(word.front()))) * 3 +
+                    static_cast<unsigned char>(lower(word.back())) + word.size()) % kSlots;
+        }
+
+        std::string_view slots_[kSlots];
+        size_t collisions_ = 0;
+    };
+}
+
+#endif // SQL_LEXER_H
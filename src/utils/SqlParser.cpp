@@ -0,0 +1,1525 @@
+#include "src/utils/SqlParser.h"
+#include "src/utils/SqlLexer.h"
+#include <algorithm>
+#include <iterator>
+
+namespace Utils {
+
+void SqlArena::clear() {
+    if (blocks_.size() > 1) blocks_.resize(1);
+    if (!blocks_.empty()) {
+        cursor_ = blocks_.front().get();
+        left_ = kBlockSize;
+    }
+}
+
+void* SqlArena::allocate(size_t size, size_t align) {
+    size_t pad = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+    if (!cursor_ || pad + size > left_) {
+        size_t blockSize = std::max(kBlockSize, size + align);
+        blocks_.emplace_back(new char[blockSize]);
+        cursor_ = blocks_.back().get();
+        left_ = blockSize;
+        pad = (align - reinterpret_cast<uintptr_t>(cursor_) % align) % align;
+    }
+    void* result = cursor_ + pad;
+    cursor_ += pad + size;
+    left_ -= pad + size;
+    return result;
+}
+
+namespace {
+    char lowerAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // word без учёта регистра равно lower (в нижнем регистре)
+    bool equalsWord(std::string_view word, std::string_view lower) {
+        if (word.size() != lower.size()) return false;
+        for (size_t i = 0; i < word.size(); ++i) {
+            if (lowerAscii(word[i]) != lower[i]) return false;
+        }
+        return true;
+    }
+
+    // Слова, которые не могут быть псевдонимом или именем колонки без кавычек
+    constexpr std::string_view kReserved[] = {
+        "all", "and", "as", "asc", "between", "by", "case", "cast", "cross", "desc",
+        "distinct", "else", "end", "except", "exists", "false", "fetch", "for", "from",
+        "full", "group", "having", "ilike", "in", "inner", "intersect", "into", "is",
+        "join", "lateral", "left", "like", "limit", "natural", "not", "null", "offset",
+        "on", "or", "order", "outer", "over", "returning", "right", "select", "similar",
+        "then", "true", "union", "using", "values", "when", "where", "window", "with"
+    };
+
+    constexpr bool sortedWords() {
+        for (size_t i = 1; i < std::size(kReserved); ++i) {
+            if (!(kReserved[i - 1] < kReserved[i])) return false;
+        }
+        return true;
+    }
+    static_assert(sortedWords(), "kReserved must be sorted for binary search");
+
+    bool isReserved(std::string_view word) {
+        constexpr size_t kLongest = 9;
+        if (word.size() < 2 || word.size() > kLongest) return false;
+        char buffer[kLongest];
+        for (size_t i = 0; i < word.size(); ++i) buffer[i] = lowerAscii(word[i]);
+        return std::binary_search(std::begin(kReserved), std::end(kReserved),
+                                  std::string_view(buffer, word.size()));
+    }
+
+    bool isOperatorChar(char c) {
+        return std::string_view("+-*/<>=~!@#%^&|`?").find(c) != std::string_view::npos;
+    }
+
+    bool isComparison(std::string_view op) {
+        return op == "=" || op == "<>" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">=";
+    }
+
+    class Parser {
+    public:
+        Parser(std::string_view sql, SqlArena& arena) : sql_(sql), lexer_(sql), arena_(arena) {}
+
+        SqlParseResult run() {
+            SqlParseResult result;
+            SqlNode* root = query();
+            if (!error_.empty()) root = nullptr;
+            if (root) {
+                if (peek().kind == SqlTokenKind::Semicolon) take();
+                if (peek().kind != SqlTokenKind::End) root = fail("unexpected input after statement");
+            }
+            if (root) {
+                result.root = root;
+                result.hasParameters = hasParameters_;
+            } else {
+                result.error = error_;
+                result.errorOffset = errorOffset_;
+            }
+            return result;
+        }
+
+    private:
+        static constexpr size_t kLookahead = 8;
+        static constexpr int kMaxDepth = 200;
+        // Цепочка a + b + ... растёт в глубину дерева без рекурсии разбора;
+        // ограничение числа узлов держит в пределах и рекурсию печати
+        static constexpr size_t kMaxNodes = 10000;
+
+        // Вложенность ограничена, чтобы запрос не исчерпал стек
+        struct Depth {
+            explicit Depth(Parser& p) : parser(p) { ok = ++parser.depth_ <= kMaxDepth; }
+            ~Depth() { --parser.depth_; }
+            Parser& parser;
+            bool ok;
+        };
+
+        // --- Лексемы ---
+
+        const SqlToken& peek(size_t ahead = 0) {
+            while (count_ <= ahead) {
+                SqlToken token = lexer_.next();
+                if (token.kind == SqlTokenKind::Comment) continue;
+                ring_[(head_ + count_) % kLookahead] = token;
+                ++count_;
+            }
+            return ring_[(head_ + ahead) % kLookahead];
+        }
+
+        SqlToken take() {
+            SqlToken token = peek();
+            if (token.kind != SqlTokenKind::End) {
+                head_ = (head_ + 1) % kLookahead;
+                --count_;
+                lastEnd_ = token.offset + token.length;
+            }
+            return token;
+        }
+
+        std::string_view text(const SqlToken& token) const {
+            return sql_.substr(token.offset, token.length);
+        }
+
+        bool word(size_t ahead, std::string_view lower) {
+            const SqlToken& token = peek(ahead);
+            return token.kind == SqlTokenKind::Word && equalsWord(text(token), lower);
+        }
+
+        bool acceptWord(std::string_view lower) {
+            if (!word(0, lower)) return false;
+            take();
+            return true;
+        }
+
+        bool expectWord(std::string_view lower) {
+            if (acceptWord(lower)) return true;
+            fail("expected " + std::string(lower));
+            return false;
+        }
+
+        bool isChar(size_t ahead, char c) {
+            const SqlToken& token = peek(ahead);
+            return token.kind == SqlTokenKind::Operator && token.length == 1 && sql_[token.offset] == c;
+        }
+
+        bool acceptChar(char c) {
+            if (!isChar(0, c)) return false;
+            take();
+            return true;
+        }
+
+        bool expectChar(char c) {
+            if (acceptChar(c)) return true;
+            fail(std::string("expected '") + c + "'");
+            return false;
+        }
+
+        // Идентификатор: слово, кроме зарезервированных, или имя в кавычках
+        bool isName(size_t ahead) {
+            const SqlToken& token = peek(ahead);
+            return token.kind == SqlTokenKind::QuotedIdentifier ||
+                   (token.kind == SqlTokenKind::Word && !isReserved(text(token)));
+        }
+
+        // Оператор из подряд идущих знаков (лексер выдаёт их по одному).
+        // Как в PostgreSQL, оператор из нескольких знаков не заканчивается
+        // на + или -, если в нём нет ни одного из ~!@#%^&|`?
+        std::string_view peekOperator(size_t& tokens) {
+            tokens = 0;
+            size_t start = peek().offset;
+            size_t end = start;
+            while (tokens < kLookahead - 1) {
+                const SqlToken& token = peek(tokens);
+                if (token.kind != SqlTokenKind::Operator || token.length != 1 || token.offset != end ||
+                    !isOperatorChar(sql_[token.offset])) {
+                    break;
+                }
+                ++end;
+                ++tokens;
+            }
+            std::string_view op = sql_.substr(start, end - start);
+            if (op.size() > 1 && op.find_first_of("~!@#%^&|`?") == std::string_view::npos) {
+                while (op.size() > 1 && (op.back() == '+' || op.back() == '-')) {
+                    op.remove_suffix(1);
+                    --tokens;
+                }
+            }
+            return op;
+        }
+
+        void skip(size_t tokens) {
+            while (tokens-- > 0) take();
+        }
+
+        SqlNode* fail(const std::string& message) {
+            if (error_.empty()) {
+                error_ = message;
+                errorOffset_ = peek().offset;
+            }
+            return nullptr;
+        }
+
+        // --- Узлы ---
+
+        SqlNode* make(SqlNodeKind kind, size_t offset) {
+            if (++nodes_ > kMaxNodes) fail("query is too large");
+            SqlNode* node = arena_.make<SqlNode>();
+            node->kind = kind;
+            node->offset = offset;
+            node->end = offset;
+            return node;
+        }
+
+        SqlNode* done(SqlNode* node) {
+            node->end = lastEnd_;
+            return node;
+        }
+
+        // Дочерние узлы добавляются в конец списка
+        struct Children {
+            explicit Children(SqlNode* p) : parent(p) {
+                for (last = p->first; last && last->next; last = last->next) {}
+            }
+            void add(SqlNode* child) {
+                if (last) {
+                    last->next = child;
+                } else {
+                    parent->first = child;
+                }
+                last = child;
+            }
+            SqlNode* parent;
+            SqlNode* last;
+        };
+
+        SqlNode* binary(std::string_view op, SqlNode* left, SqlNode* right) {
+            SqlNode* node = make(SqlNodeKind::Binary, left->offset);
+            node->name = op;
+            node->first = left;
+            left->next = right;
+            return done(node);
+        }
+
+        // Список выражений через запятую
+        bool expressionList(SqlNode* parent) {
+            Children children(parent);
+            do {
+                SqlNode* e = expression();
+                if (!e) return false;
+                children.add(e);
+            } while (acceptChar(','));
+            return true;
+        }
+
+        // --- Запросы ---
+
+        SqlNode* query() {
+            Depth depth(*this);
+            if (!depth.ok) return fail("query is nested too deeply");
+
+            SqlNode* node = make(SqlNodeKind::Query, peek().offset);
+            Children children(node);
+
+            if (acceptWord("with")) {
+                SqlNode* with = make(SqlNodeKind::With, lastEnd_);
+                if (acceptWord("recursive")) with->flags |= kSqlAll;
+                Children ctes(with);
+                do {
+                    if (!isName(0)) return fail("expected CTE name");
+                    SqlToken name = take();
+                    SqlNode* cte = make(SqlNodeKind::Cte, name.offset);
+                    cte->name = text(name);
+                    if (!expectWord("as") || !expectChar('(')) return nullptr;
+                    SqlNode* body = query();
+                    if (!body || !expectChar(')')) return nullptr;
+                    cte->first = body;
+                    ctes.add(done(cte));
+                } while (acceptChar(','));
+                children.add(done(with));
+            }
+
+            SqlNode* body = setExpression();
+            if (!body) return nullptr;
+            children.add(body);
+
+            if (word(0, "order") && word(1, "by")) {
+                SqlNode* order = orderBy();
+                if (!order) return nullptr;
+                children.add(order);
+            }
+
+            // LIMIT и OFFSET в любом порядке, в дереве - LIMIT первым
+            SqlNode* limit = nullptr;
+            SqlNode* offset = nullptr;
+            while (true) {
+                if (!limit && word(0, "limit")) {
+                    limit = make(SqlNodeKind::Limit, take().offset);
+                    SqlNode* value = nullptr;
+                    if (word(0, "all")) {
+                        SqlToken all = take();
+                        value = make(SqlNodeKind::Keyword, all.offset);
+                        value->name = text(all);
+                        done(value);
+                    } else {
+                        value = expression();
+                    }
+                    if (!value) return nullptr;
+                    limit->first = value;
+                    done(limit);
+                } else if (!offset && word(0, "offset")) {
+                    offset = make(SqlNodeKind::Offset, take().offset);
+                    offset->first = expression();
+                    if (!offset->first) return nullptr;
+                    if (!acceptWord("rows")) acceptWord("row");
+                    done(offset);
+                } else {
+                    break;
+                }
+            }
+            if (limit) children.add(limit);
+            if (offset) children.add(offset);
+
+            return done(node);
+        }
+
+        SqlNode* setExpression() {
+            SqlNode* left = selectCore();
+            while (left) {
+                std::string_view op;
+                if (word(0, "union")) {
+                    op = "union";
+                } else if (word(0, "intersect")) {
+                    op = "intersect";
+                } else if (word(0, "except")) {
+                    op = "except";
+                } else {
+                    break;
+                }
+                take();
+                SqlNode* node = make(SqlNodeKind::SetOp, left->offset);
+                node->name = op;
+                if (acceptWord("all")) {
+                    node->flags |= kSqlAll;
+                } else if (acceptWord("distinct")) {
+                    node->flags |= kSqlDistinct;
+                }
+                SqlNode* right = selectCore();
+                if (!right) return nullptr;
+                node->first = left;
+                left->next = right;
+                left = done(node);
+            }
+            return left;
+        }
+
+        SqlNode* selectCore() {
+            if (isChar(0, '(')) {
+                size_t open = take().offset;
+                SqlNode* inner = query();
+                if (!inner || !expectChar(')')) return nullptr;
+                inner->flags |= kSqlParens;
+                inner->offset = open;
+                return done(inner);
+            }
+            if (!word(0, "select")) return fail("expected SELECT");
+
+            SqlNode* node = make(SqlNodeKind::Select, take().offset);
+            if (acceptWord("distinct")) {
+                if (word(0, "on")) return fail("DISTINCT ON is not supported");
+                node->flags |= kSqlDistinct;
+            } else {
+                acceptWord("all");
+            }
+            Children children(node);
+
+            SqlNode* list = make(SqlNodeKind::SelectList, peek().offset);
+            Children items(list);
+            do {
+                SqlNode* e = expression();
+                if (!e) return nullptr;
+                SqlNode* item = make(SqlNodeKind::SelectItem, e->offset);
+                item->first = e;
+                if (!alias(item)) return nullptr;
+                items.add(done(item));
+            } while (acceptChar(','));
+            children.add(done(list));
+
+            if (word(0, "from")) {
+                SqlNode* from = make(SqlNodeKind::From, take().offset);
+                Children sources(from);
+                do {
+                    SqlNode* source = fromItem();
+                    if (!source) return nullptr;
+                    sources.add(source);
+                } while (acceptChar(','));
+                children.add(done(from));
+            }
+            if (word(0, "where")) {
+                SqlNode* where = make(SqlNodeKind::Where, take().offset);
+                if (!(where->first = expression())) return nullptr;
+                children.add(done(where));
+            }
+            if (word(0, "group") && word(1, "by")) {
+                SqlNode* group = make(SqlNodeKind::GroupBy, take().offset);
+                take();
+                if (!expressionList(group)) return nullptr;
+                children.add(done(group));
+            }
+            if (word(0, "having")) {
+                SqlNode* having = make(SqlNodeKind::Having, take().offset);
+                if (!(having->first = expression())) return nullptr;
+                children.add(done(having));
+            }
+            return done(node);
+        }
+
+        // [AS] псевдоним; список колонок после псевдонима не поддерживается
+        bool alias(SqlNode* node) {
+            if (acceptWord("as")) {
+                const SqlToken& token = peek();
+                if (token.kind != SqlTokenKind::Word && token.kind != SqlTokenKind::QuotedIdentifier) {
+                    fail("expected alias");
+                    return false;
+                }
+                node->alias = text(take());
+            } else if (isName(0)) {
+                node->alias = text(take());
+            } else {
+                return true;
+            }
+            if (isChar(0, '(')) {
+                fail("column alias lists are not supported");
+                return false;
+            }
+            return true;
+        }
+
+        SqlNode* fromItem() {
+            SqlNode* left = fromPrimary();
+            while (left) {
+                std::string_view kind;
+                if (word(0, "join")) {
+                    kind = "join";
+                } else if (word(0, "inner") && word(1, "join")) {
+                    take();
+                    kind = "join";
+                } else if (word(0, "left") || word(0, "right") || word(0, "full")) {
+                    kind = word(0, "left") ? "left join" : word(0, "right") ? "right join" : "full join";
+                    take();
+                    acceptWord("outer");
+                    if (!word(0, "join")) return fail("expected JOIN");
+                } else if (word(0, "cross") && word(1, "join")) {
+                    take();
+                    kind = "cross join";
+                } else {
+                    break;
+                }
+                take();
+
+                SqlNode* join = make(SqlNodeKind::Join, left->offset);
+                join->name = kind;
+                SqlNode* right = fromPrimary();
+                if (!right) return nullptr;
+                join->first = left;
+                left->next = right;
+                if (kind != "cross join") {
+                    if (word(0, "on")) {
+                        SqlNode* on = make(SqlNodeKind::On, take().offset);
+                        if (!(on->first = expression())) return nullptr;
+                        right->next = done(on);
+                    } else if (word(0, "using")) {
+                        SqlNode* usingNode = make(SqlNodeKind::Using, take().offset);
+                        if (!expectChar('(')) return nullptr;
+                        Children columns(usingNode);
+                        do {
+                            if (!isName(0)) return fail("expected column name");
+                            SqlToken name = take();
+                            SqlNode* column = make(SqlNodeKind::Column, name.offset);
+                            column->name = text(name);
+                            columns.add(done(column));
+                        } while (acceptChar(','));
+                        if (!expectChar(')')) return nullptr;
+                        right->next = done(usingNode);
+                    } else {
+                        return fail("expected ON or USING");
+                    }
+                }
+                left = done(join);
+            }
+            return left;
+        }
+
+        SqlNode* fromPrimary() {
+            if (isChar(0, '(')) {
+                if (!word(1, "select") && !word(1, "with")) return fail("parenthesized joins are not supported");
+                SqlNode* node = make(SqlNodeKind::Subquery, take().offset);
+                node->first = query();
+                if (!node->first || !expectChar(')') || !alias(node)) return nullptr;
+                return done(node);
+            }
+            if (!isName(0)) return fail("expected table name");
+
+            size_t start = peek().offset;
+            qualifiedName();
+            std::string_view name = sql_.substr(start, lastEnd_ - start);
+            SqlNode* node = isChar(0, '(') ? function(name, start) : make(SqlNodeKind::Table, start);
+            if (!node) return nullptr;
+            node->name = name;
+            if (!alias(node)) return nullptr;
+            return done(node);
+        }
+
+        // имя[.имя...] - текущая лексема уже проверена
+        void qualifiedName() {
+            take();
+            while (isChar(0, '.') && isNameToken(peek(1))) {
+                take();
+                take();
+            }
+        }
+
+        static bool isNameToken(const SqlToken& token) {
+            return token.kind == SqlTokenKind::Word || token.kind == SqlTokenKind::QuotedIdentifier;
+        }
+
+        SqlNode* orderBy() {
+            SqlNode* node = make(SqlNodeKind::OrderBy, take().offset);
+            take();
+            Children items(node);
+            do {
+                SqlNode* e = expression();
+                if (!e) return nullptr;
+                SqlNode* item = make(SqlNodeKind::SortItem, e->offset);
+                item->first = e;
+                if (acceptWord("desc")) {
+                    item->flags |= kSqlDesc;
+                } else {
+                    acceptWord("asc");
+                }
+                if (acceptWord("nulls")) {
+                    if (acceptWord("first")) {
+                        item->flags |= kSqlNullsFirst;
+                    } else if (acceptWord("last")) {
+                        item->flags |= kSqlNullsLast;
+                    } else {
+                        return fail("expected FIRST or LAST");
+                    }
+                }
+                items.add(done(item));
+            } while (acceptChar(','));
+            return done(node);
+        }
+
+        // --- Выражения (приоритеты как в PostgreSQL) ---
+
+        SqlNode* expression() {
+            Depth depth(*this);
+            if (!depth.ok) return fail("expression is nested too deeply");
+            SqlNode* left = conjunction();
+            while (left && word(0, "or")) {
+                take();
+                SqlNode* right = conjunction();
+                if (!right) return nullptr;
+                left = binary("or", left, right);
+            }
+            return left;
+        }
+
+        SqlNode* conjunction() {
+            SqlNode* left = negation();
+            while (left && word(0, "and")) {
+                take();
+                SqlNode* right = negation();
+                if (!right) return nullptr;
+                left = binary("and", left, right);
+            }
+            return left;
+        }
+
+        SqlNode* negation() {
+            if (!word(0, "not")) return predicate();
+            Depth depth(*this);
+            if (!depth.ok) return fail("expression is nested too deeply");
+            SqlNode* node = make(SqlNodeKind::Unary, take().offset);
+            node->name = "not";
+            if (!(node->first = negation())) return nullptr;
+            return done(node);
+        }
+
+        SqlNode* predicate() {
+            SqlNode* left = otherOperator();
+            while (left) {
+                size_t tokens = 0;
+                std::string_view op = peekOperator(tokens);
+                if (isComparison(op)) {
+                    skip(tokens);
+                    SqlNode* right = otherOperator();
+                    if (!right) return nullptr;
+                    left = binary(op == "!=" ? "<>" : op, left, right);
+                    continue;
+                }
+
+                bool negated = false;
+                if (word(0, "not") && (word(1, "like") || word(1, "ilike") || word(1, "between") || word(1, "in"))) {
+                    take();
+                    negated = true;
+                }
+                if (word(0, "like") || word(0, "ilike")) {
+                    bool ilike = word(0, "ilike");
+                    take();
+                    SqlNode* right = otherOperator();
+                    if (!right) return nullptr;
+                    left = binary(ilike ? (negated ? "not ilike" : "ilike") : (negated ? "not like" : "like"),
+                                  left, right);
+                } else if (word(0, "between")) {
+                    take();
+                    if (word(0, "symmetric") || word(0, "asymmetric")) return fail("BETWEEN SYMMETRIC is not supported");
+                    SqlNode* node = make(SqlNodeKind::Between, left->offset);
+                    if (negated) node->flags |= kSqlNot;
+                    SqlNode* low = otherOperator();
+                    if (!low || !expectWord("and")) return nullptr;
+                    SqlNode* high = otherOperator();
+                    if (!high) return nullptr;
+                    node->first = left;
+                    left->next = low;
+                    low->next = high;
+                    left = done(node);
+                } else if (word(0, "in")) {
+                    take();
+                    SqlNode* node = make(SqlNodeKind::In, left->offset);
+                    if (negated) node->flags |= kSqlNot;
+                    node->first = left;
+                    if (!expectChar('(')) return nullptr;
+                    if (word(0, "select") || word(0, "with")) {
+                        if (!(left->next = query())) return nullptr;
+                    } else if (!expressionList(node)) {
+                        return nullptr;
+                    }
+                    if (!expectChar(')')) return nullptr;
+                    left = done(node);
+                } else if (negated) {
+                    return fail("unexpected NOT");
+                } else if (word(0, "is")) {
+                    take();
+                    bool isNot = acceptWord("not");
+                    if (acceptWord("distinct")) {
+                        if (!expectWord("from")) return nullptr;
+                        SqlNode* right = otherOperator();
+                        if (!right) return nullptr;
+                        left = binary(isNot ? "is not distinct from" : "is distinct from", left, right);
+                        continue;
+                    }
+                    static constexpr std::string_view kTests[][2] = {
+                        {"is null", "is not null"}, {"is true", "is not true"},
+                        {"is false", "is not false"}, {"is unknown", "is not unknown"}
+                    };
+                    std::string_view test;
+                    for (const auto& pair : kTests) {
+                        if (word(0, pair[0].substr(3))) test = pair[isNot ? 1 : 0];
+                    }
+                    if (test.empty()) return fail("unsupported IS test");
+                    take();
+                    SqlNode* node = make(SqlNodeKind::Is, left->offset);
+                    node->name = test;
+                    node->first = left;
+                    left = done(node);
+                } else {
+                    break;
+                }
+            }
+            return left;
+        }
+
+        // Прочие операторы (||, ->>, @>, ~ ...): выше сравнений, ниже + и -
+        SqlNode* otherOperator() {
+            SqlNode* left = additive();
+            while (left) {
+                size_t tokens = 0;
+                std::string_view op = peekOperator(tokens);
+                if (op.empty() || isComparison(op) || op == "+" || op == "-" || op == "*" || op == "/" ||
+                    op == "%" || op == "^") {
+                    break;
+                }
+                skip(tokens);
+                SqlNode* right = additive();
+                if (!right) return nullptr;
+                left = binary(op, left, right);
+            }
+            return left;
+        }
+
+        SqlNode* additive() {
+            SqlNode* left = multiplicative();
+            while (left) {
+                size_t tokens = 0;
+                std::string_view op = peekOperator(tokens);
+                if (op != "+" && op != "-") break;
+                skip(tokens);
+                SqlNode* right = multiplicative();
+                if (!right) return nullptr;
+                left = binary(op, left, right);
+            }
+            return left;
+        }
+
+        SqlNode* multiplicative() {
+            SqlNode* left = unary();
+            while (left) {
+                size_t tokens = 0;
+                std::string_view op = peekOperator(tokens);
+                if (op != "*" && op != "/" && op != "%" && op != "^") break;
+                skip(tokens);
+                SqlNode* right = unary();
+                if (!right) return nullptr;
+                left = binary(op, left, right);
+            }
+            return left;
+        }
+
+        SqlNode* unary() {
+            if (isChar(0, '-') || isChar(0, '+')) {
+                Depth depth(*this);
+                if (!depth.ok) return fail("expression is nested too deeply");
+                SqlToken sign = take();
+                SqlNode* node = make(SqlNodeKind::Unary, sign.offset);
+                node->name = text(sign);
+                if (!(node->first = unary())) return nullptr;
+                return done(node);
+            }
+            SqlNode* node = primary();
+            // Приведение x::тип связывает сильнее всех операторов
+            while (node && isChar(0, ':') && isChar(1, ':') && peek(1).offset == peek().offset + 1) {
+                take();
+                take();
+                SqlNode* cast = make(SqlNodeKind::Cast, node->offset);
+                cast->name = typeName();
+                if (cast->name.empty()) return nullptr;
+                cast->first = node;
+                node = done(cast);
+            }
+            return node;
+        }
+
+        // Имя типа: double precision, timestamp(3) with time zone, numeric(10, 2), int[]
+        std::string_view typeName() {
+            if (!isNameToken(peek())) {
+                fail("expected type name");
+                return {};
+            }
+            size_t start = peek().offset;
+            qualifiedName();
+            auto words = [this]() {
+                while (word(0, "precision") || word(0, "varying") || word(0, "with") || word(0, "without") ||
+                       word(0, "time") || word(0, "zone")) {
+                    take();
+                }
+            };
+            words();
+            if (acceptChar('(')) {
+                do {
+                    if (peek().kind != SqlTokenKind::Number) {
+                        fail("expected type modifier");
+                        return {};
+                    }
+                    take();
+                } while (acceptChar(','));
+                if (!expectChar(')')) return {};
+                words();
+            }
+            while (isChar(0, '[') && isChar(1, ']')) {
+                take();
+                take();
+            }
+            return sql_.substr(start, lastEnd_ - start);
+        }
+
+        SqlNode* primary() {
+            const SqlToken token = peek();
+            switch (token.kind) {
+                case SqlTokenKind::Number:
+                case SqlTokenKind::String:
+                case SqlTokenKind::Parameter: {
+                    take();
+                    SqlNode* node = make(token.kind == SqlTokenKind::Number ? SqlNodeKind::Number
+                                         : token.kind == SqlTokenKind::String ? SqlNodeKind::String
+                                         : SqlNodeKind::Param, token.offset);
+                    if (token.kind == SqlTokenKind::Parameter) hasParameters_ = true;
+                    node->name = text(token);
+                    return done(node);
+                }
+                case SqlTokenKind::Word:
+                case SqlTokenKind::QuotedIdentifier:
+                    return namedPrimary(token);
+                case SqlTokenKind::Operator:
+                    if (isChar(0, '(')) {
+                        if (word(1, "select") || word(1, "with")) {
+                            SqlNode* node = make(SqlNodeKind::Subquery, take().offset);
+                            node->first = query();
+                            if (!node->first || !expectChar(')')) return nullptr;
+                            return done(node);
+                        }
+                        size_t open = take().offset;
+                        SqlNode* inner = expression();
+                        if (!inner || !expectChar(')')) return nullptr;
+                        inner->flags |= kSqlParens;
+                        inner->offset = open;
+                        return done(inner);
+                    }
+                    if (isChar(0, '*')) {
+                        take();
+                        SqlNode* node = make(SqlNodeKind::Star, token.offset);
+                        node->name = text(token);
+                        return done(node);
+                    }
+                    return fail("unexpected '" + std::string(text(token)) + "'");
+                default:
+                    return fail(token.kind == SqlTokenKind::End ? "unexpected end of query" : "unexpected token");
+            }
+        }
+
+        SqlNode* namedPrimary(const SqlToken& token) {
+            std::string_view name = text(token);
+            if (token.kind == SqlTokenKind::Word) {
+                if (equalsWord(name, "null") || equalsWord(name, "true") || equalsWord(name, "false")) {
+                    take();
+                    SqlNode* node = make(SqlNodeKind::Keyword, token.offset);
+                    node->name = name;
+                    return done(node);
+                }
+                if (equalsWord(name, "case")) return caseExpression();
+                if (equalsWord(name, "cast") && isChar(1, '(')) {
+                    SqlNode* node = make(SqlNodeKind::Cast, take().offset);
+                    take();
+                    node->flags |= kSqlKeywordForm;
+                    node->first = expression();
+                    if (!node->first || !expectWord("as")) return nullptr;
+                    node->name = typeName();
+                    if (node->name.empty() || !expectChar(')')) return nullptr;
+                    return done(node);
+                }
+                if (equalsWord(name, "exists") && isChar(1, '(')) {
+                    SqlNode* node = make(SqlNodeKind::Exists, take().offset);
+                    take();
+                    node->first = query();
+                    if (!node->first || !expectChar(')')) return nullptr;
+                    return done(node);
+                }
+                // Литерал с типом: date '2024-01-01', interval '1 day'
+                if (peek(1).kind == SqlTokenKind::String && !isReserved(name)) {
+                    take();
+                    SqlNode* node = make(SqlNodeKind::TypedLiteral, token.offset);
+                    node->name = name;
+                    SqlToken literal = take();
+                    node->first = make(SqlNodeKind::String, literal.offset);
+                    node->first->name = text(literal);
+                    done(node->first);
+                    return done(node);
+                }
+                // left(...), right(...) - функции, хотя слова зарезервированы
+                if (isReserved(name) && !isChar(1, '(')) {
+                    return fail("unexpected keyword " + std::string(name));
+                }
+            }
+
+            size_t start = token.offset;
+            take();
+            while (isChar(0, '.')) {
+                if (isChar(1, '*')) {
+                    take();
+                    take();
+                    SqlNode* node = make(SqlNodeKind::Star, start);
+                    node->name = sql_.substr(start, lastEnd_ - start);
+                    return done(node);
+                }
+                if (!isNameToken(peek(1))) break;
+                take();
+                take();
+            }
+            std::string_view qualified = sql_.substr(start, lastEnd_ - start);
+            if (isChar(0, '(')) return function(qualified, start);
+            SqlNode* node = make(SqlNodeKind::Column, start);
+            node->name = qualified;
+            return done(node);
+        }
+
+        // Вызов функции; текущая лексема - '('
+        SqlNode* function(std::string_view name, size_t start) {
+            SqlNode* node = make(SqlNodeKind::Function, start);
+            node->name = name;
+            take();
+            Children children(node);
+
+            if (equalsWord(name, "extract")) {
+                const SqlToken field = peek();
+                if (field.kind != SqlTokenKind::Word && field.kind != SqlTokenKind::String) {
+                    return fail("expected EXTRACT field");
+                }
+                take();
+                SqlNode* fieldNode = make(field.kind == SqlTokenKind::Word ? SqlNodeKind::Keyword
+                                                                           : SqlNodeKind::String, field.offset);
+                fieldNode->name = text(field);
+                children.add(done(fieldNode));
+                if (!expectWord("from")) return nullptr;
+                SqlNode* source = expression();
+                if (!source) return nullptr;
+                children.add(source);
+                node->flags |= kSqlKeywordForm;
+            } else if (isChar(0, '*')) {
+                SqlToken star = take();
+                SqlNode* starNode = make(SqlNodeKind::Star, star.offset);
+                starNode->name = text(star);
+                children.add(done(starNode));
+            } else if (!isChar(0, ')')) {
+                if (acceptWord("distinct")) {
+                    node->flags |= kSqlDistinct;
+                } else {
+                    acceptWord("all");
+                }
+                if (!expressionList(node)) return nullptr;
+                children = Children(node);
+                if (word(0, "order") && word(1, "by")) {
+                    SqlNode* order = orderBy();
+                    if (!order) return nullptr;
+                    children.add(order);
+                }
+            }
+            if (!expectChar(')')) return nullptr;
+
+            if (word(0, "within")) return fail("WITHIN GROUP is not supported");
+            if (word(0, "filter") && isChar(1, '(')) {
+                SqlNode* filter = make(SqlNodeKind::Filter, take().offset);
+                take();
+                if (!expectWord("where")) return nullptr;
+                if (!(filter->first = expression()) || !expectChar(')')) return nullptr;
+                children.add(done(filter));
+            }
+            if (word(0, "over")) {
+                SqlNode* over = make(SqlNodeKind::Over, take().offset);
+                if (!expectChar('(')) return nullptr;
+                Children window(over);
+                if (word(0, "partition") && word(1, "by")) {
+                    SqlNode* partition = make(SqlNodeKind::PartitionBy, take().offset);
+                    take();
+                    if (!expressionList(partition)) return nullptr;
+                    window.add(done(partition));
+                }
+                if (word(0, "order") && word(1, "by")) {
+                    SqlNode* order = orderBy();
+                    if (!order) return nullptr;
+                    window.add(order);
+                }
+                if (!expectChar(')')) return nullptr;
+                children.add(done(over));
+            }
+            return done(node);
+        }
+
+        SqlNode* caseExpression() {
+            SqlNode* node = make(SqlNodeKind::Case, take().offset);
+            Children children(node);
+            if (!word(0, "when")) {
+                SqlNode* operand = expression();
+                if (!operand) return nullptr;
+                children.add(operand);
+            }
+            if (!word(0, "when")) return fail("expected WHEN");
+            while (word(0, "when")) {
+                SqlNode* when = make(SqlNodeKind::When, take().offset);
+                SqlNode* condition = expression();
+                if (!condition || !expectWord("then")) return nullptr;
+                SqlNode* result = expression();
+                if (!result) return nullptr;
+                when->first = condition;
+                condition->next = result;
+                children.add(done(when));
+            }
+            if (word(0, "else")) {
+                SqlNode* otherwise = make(SqlNodeKind::Else, take().offset);
+                if (!(otherwise->first = expression())) return nullptr;
+                children.add(done(otherwise));
+            }
+            if (!expectWord("end")) return nullptr;
+            return done(node);
+        }
+
+        std::string_view sql_;
+        SqlLexer lexer_;
+        SqlArena& arena_;
+        SqlToken ring_[kLookahead] = {};
+        size_t head_ = 0;
+        size_t count_ = 0;
+        size_t lastEnd_ = 0;
+        int depth_ = 0;
+        size_t nodes_ = 0;
+        bool hasParameters_ = false;
+        std::string error_;
+        size_t errorOffset_ = 0;
+    };
+
+    // Имя, тип или ключевое слово из исходного текста: слова без кавычек
+    // в нижнем регистре, пробел только между словами и после запятой
+    void appendName(std::string& out, std::string_view text) {
+        // Обычно это одно слово или имя с таблицей - без разбора на лексемы
+        if (text.find_first_of("\" \t\n\r\f\v,([") == std::string_view::npos) {
+            for (char c : text) out += lowerAscii(c);
+            return;
+        }
+        SqlLexer lexer(text);
+        SqlTokenKind previous = SqlTokenKind::End;
+        char previousChar = 0;
+        for (SqlToken token = lexer.next(); token.kind != SqlTokenKind::End; token = lexer.next()) {
+            std::string_view part = lexer.text(token);
+            bool wordLike = token.kind != SqlTokenKind::Operator;
+            bool previousWordLike = previous != SqlTokenKind::End && previous != SqlTokenKind::Operator;
+            if ((wordLike && previousWordLike) || previousChar == ',') out += ' ';
+            if (token.kind == SqlTokenKind::Word) {
+                for (char c : part) out += lowerAscii(c);
+            } else {
+                out.append(part);
+            }
+            previous = token.kind;
+            previousChar = token.kind == SqlTokenKind::Operator ? part.front() : 0;
+        }
+    }
+
+    bool isLiteral(const SqlNode* node) {
+        switch (node->kind) {
+            case SqlNodeKind::Number:
+            case SqlNodeKind::String:
+            case SqlNodeKind::Keyword:
+            case SqlNodeKind::Param:
+            case SqlNodeKind::TypedLiteral:
+                return true;
+            case SqlNodeKind::Unary:
+                return node->name == "-" && node->first->kind == SqlNodeKind::Number;
+            default:
+                return false;
+        }
+    }
+
+    bool isComparisonNode(const SqlNode* node) {
+        std::string_view op = node->name;
+        return isComparison(op) || op == "like" || op == "ilike" || op == "not like" || op == "not ilike";
+    }
+
+    // Только последовательность цифр
+    bool isPlainNumber(std::string_view text) {
+        return !text.empty() && text.find_first_not_of("0123456789") == std::string_view::npos;
+    }
+
+    // Целое, которое можно вынести в параметр (как в parameterizeSql):
+    // дробное или длинное число для целой колонки параметром не пройдёт
+    bool isLiftableNumber(const SqlNode* node) {
+        return node->kind == SqlNodeKind::Number && isPlainNumber(node->name) &&
+               node->name.size() <= kMaxLiftedDigits;
+    }
+
+    class Printer {
+    public:
+        Printer(std::string& out, std::vector<std::string>* params) : out_(out), params_(params) {}
+
+        void print(const SqlNode* node) {
+            const bool parens = (node->flags & kSqlParens) != 0;
+            if (parens) out_ += '(';
+            body(node);
+            if (parens) out_ += ')';
+        }
+
+    private:
+        // Литерал в позиции значения заменяется параметром ($n) при
+        // построении формы оператора; дробные и длинные числа остаются в тексте
+        void value(const SqlNode* node, bool liftable) {
+            if (!params_ || !liftable) {
+                print(node);
+                return;
+            }
+            std::string literal;
+            if (isLiftableNumber(node)) {
+                literal.assign(node->name);
+            } else if (node->kind == SqlNodeKind::Unary && node->name == "-" &&
+                       isLiftableNumber(node->first) && !(node->first->flags & kSqlParens)) {
+                literal = "-" + std::string(node->first->name);
+            } else if (node->kind == SqlNodeKind::String && node->name.front() == '\'') {
+                // '' внутри литерала - одна кавычка
+                std::string_view quoted = node->name.substr(1, node->name.size() - 2);
+                literal.reserve(quoted.size());
+                for (size_t i = 0; i < quoted.size(); ++i) {
+                    literal += quoted[i];
+                    if (quoted[i] == '\'') ++i;
+                }
+            } else {
+                print(node);
+                return;
+            }
+            const bool parens = (node->flags & kSqlParens) != 0;
+            if (parens) out_ += '(';
+            params_->push_back(std::move(literal));
+            out_ += '$';
+            out_ += std::to_string(params_->size());
+            if (parens) out_ += ')';
+        }
+
+        void list(const SqlNode* node, const char* separator = ", ") {
+            for (const SqlNode* c = node; c; c = c->next) {
+                if (c != node) out_ += separator;
+                print(c);
+            }
+        }
+
+        void aliasOf(const SqlNode* node) {
+            if (node->alias.empty()) return;
+            out_ += " as ";
+            appendName(out_, node->alias);
+        }
+
+        void body(const SqlNode* node) {
+            switch (node->kind) {
+                case SqlNodeKind::Query:
+                    for (const SqlNode* c = node->first; c; c = c->next) {
+                        if (c != node->first) out_ += ' ';
+                        print(c);
+                    }
+                    break;
+                case SqlNodeKind::With:
+                    out_ += (node->flags & kSqlAll) ? "with recursive " : "with ";
+                    list(node->first);
+                    break;
+                case SqlNodeKind::Cte:
+                    appendName(out_, node->name);
+                    out_ += " as (";
+                    print(node->first);
+                    out_ += ')';
+                    break;
+                case SqlNodeKind::SetOp:
+                    print(node->first);
+                    out_ += ' ';
+                    out_ += node->name;
+                    if (node->flags & kSqlAll) out_ += " all";
+                    if (node->flags & kSqlDistinct) out_ += " distinct";
+                    out_ += ' ';
+                    print(node->first->next);
+                    break;
+                case SqlNodeKind::Select:
+                    out_ += (node->flags & kSqlDistinct) ? "select distinct " : "select ";
+                    for (const SqlNode* c = node->first; c; c = c->next) {
+                        if (c != node->first) out_ += ' ';
+                        print(c);
+                    }
+                    break;
+                case SqlNodeKind::SelectList:
+                    list(node->first);
+                    break;
+                case SqlNodeKind::SelectItem:
+                    print(node->first);
+                    aliasOf(node);
+                    break;
+                case SqlNodeKind::From:
+                    out_ += "from ";
+                    list(node->first);
+                    break;
+                case SqlNodeKind::Table:
+                    appendName(out_, node->name);
+                    aliasOf(node);
+                    break;
+                case SqlNodeKind::Subquery:
+                    out_ += '(';
+                    print(node->first);
+                    out_ += ')';
+                    aliasOf(node);
+                    break;
+                case SqlNodeKind::Join: {
+                    const SqlNode* right = node->first->next;
+                    print(node->first);
+                    out_ += ' ';
+                    out_ += node->name;
+                    out_ += ' ';
+                    print(right);
+                    if (right->next) {
+                        out_ += ' ';
+                        print(right->next);
+                    }
+                    break;
+                }
+                case SqlNodeKind::On:
+                    out_ += "on ";
+                    print(node->first);
+                    break;
+                case SqlNodeKind::Using:
+                    out_ += "using (";
+                    list(node->first);
+                    out_ += ')';
+                    break;
+                case SqlNodeKind::Where:
+                    out_ += "where ";
+                    print(node->first);
+                    break;
+                case SqlNodeKind::GroupBy:
+                    out_ += "group by ";
+                    list(node->first);
+                    break;
+                case SqlNodeKind::Having:
+                    out_ += "having ";
+                    print(node->first);
+                    break;
+                case SqlNodeKind::OrderBy:
+                    out_ += "order by ";
+                    list(node->first);
+                    break;
+                case SqlNodeKind::SortItem:
+                    print(node->first);
+                    if (node->flags & kSqlDesc) out_ += " desc";
+                    if (node->flags & kSqlNullsFirst) out_ += " nulls first";
+                    if (node->flags & kSqlNullsLast) out_ += " nulls last";
+                    break;
+                case SqlNodeKind::Limit:
+                    out_ += "limit ";
+                    value(node->first, true);
+                    break;
+                case SqlNodeKind::Offset:
+                    out_ += "offset ";
+                    value(node->first, true);
+                    break;
+                case SqlNodeKind::Column:
+                case SqlNodeKind::Star:
+                case SqlNodeKind::Keyword:
+                    appendName(out_, node->name);
+                    break;
+                case SqlNodeKind::Number:
+                case SqlNodeKind::String:
+                case SqlNodeKind::Param:
+                    out_ += node->name;
+                    break;
+                case SqlNodeKind::TypedLiteral:
+                    appendName(out_, node->name);
+                    out_ += ' ';
+                    print(node->first);
+                    break;
+                case SqlNodeKind::Unary:
+                    out_ += node->name;
+                    // "- -1" без пробела стал бы комментарием
+                    if (node->name == "not" || (node->first->kind == SqlNodeKind::Unary &&
+                                                !(node->first->flags & kSqlParens) &&
+                                                node->first->name != "not")) {
+                        out_ += ' ';
+                    }
+                    print(node->first);
+                    break;
+                case SqlNodeKind::Binary: {
+                    const SqlNode* left = node->first;
+                    const SqlNode* right = left->next;
+                    const bool compare = isComparisonNode(node);
+                    value(left, compare && !isLiteral(right));
+                    out_ += ' ';
+                    out_ += node->name;
+                    out_ += ' ';
+                    value(right, compare && !isLiteral(left));
+                    break;
+                }
+                case SqlNodeKind::Is:
+                    print(node->first);
+                    out_ += ' ';
+                    out_ += node->name;
+                    break;
+                case SqlNodeKind::Between: {
+                    const SqlNode* subject = node->first;
+                    const bool liftable = !isLiteral(subject);
+                    print(subject);
+                    out_ += (node->flags & kSqlNot) ? " not between " : " between ";
+                    value(subject->next, liftable);
+                    out_ += " and ";
+                    value(subject->next->next, liftable);
+                    break;
+                }
+                case SqlNodeKind::In: {
+                    const SqlNode* subject = node->first;
+                    print(subject);
+                    out_ += (node->flags & kSqlNot) ? " not in (" : " in (";
+                    const bool liftable = !isLiteral(subject);
+                    for (const SqlNode* c = subject->next; c; c = c->next) {
+                        if (c != subject->next) out_ += ", ";
+                        value(c, liftable);
+                    }
+                    out_ += ')';
+                    break;
+                }
+                case SqlNodeKind::Exists:
+                    out_ += "exists (";
+                    print(node->first);
+                    out_ += ')';
+                    break;
+                case SqlNodeKind::Function:
+                    function(node);
+                    break;
+                case SqlNodeKind::Filter:
+                    out_ += "filter (where ";
+                    print(node->first);
+                    out_ += ')';
+                    break;
+                case SqlNodeKind::Over:
+                    out_ += "over (";
+                    list(node->first, " ");
+                    out_ += ')';
+                    break;
+                case SqlNodeKind::PartitionBy:
+                    out_ += "partition by ";
+                    list(node->first);
+                    break;
+                case SqlNodeKind::Case:
+                    out_ += "case";
+                    for (const SqlNode* c = node->first; c; c = c->next) {
+                        out_ += ' ';
+                        print(c);
+                    }
+                    out_ += " end";
+                    break;
+                case SqlNodeKind::When:
+                    out_ += "when ";
+                    print(node->first);
+                    out_ += " then ";
+                    print(node->first->next);
+                    break;
+                case SqlNodeKind::Else:
+                    out_ += "else ";
+                    print(node->first);
+                    break;
+                case SqlNodeKind::Cast:
+                    if (node->flags & kSqlKeywordForm) {
+                        out_ += "cast(";
+                        print(node->first);
+                        out_ += " as ";
+                        appendName(out_, node->name);
+                        out_ += ')';
+                    } else {
+                        print(node->first);
+                        out_ += "::";
+                        appendName(out_, node->name);
+                    }
+                    break;
+            }
+        }
+
+        void function(const SqlNode* node) {
+            appendName(out_, node->name);
+            out_ += '(';
+            if (node->flags & kSqlKeywordForm) {
+                print(node->first);
+                out_ += " from ";
+                print(node->first->next);
+                out_ += ')';
+                return;
+            }
+            if (node->flags & kSqlDistinct) out_ += "distinct ";
+            const SqlNode* c = node->first;
+            for (bool firstArgument = true; c && c->kind != SqlNodeKind::OrderBy &&
+                 c->kind != SqlNodeKind::Filter && c->kind != SqlNodeKind::Over; c = c->next) {
+                if (!firstArgument) out_ += ", ";
+                print(c);
+                firstArgument = false;
+            }
+            if (c && c->kind == SqlNodeKind::OrderBy) {
+                out_ += ' ';
+                print(c);
+                c = c->next;
+            }
+            out_ += ')';
+            for (; c; c = c->next) {
+                out_ += ' ';
+                print(c);
+            }
+            aliasOf(node);
+        }
+
+        std::string& out_;
+        std::vector<std::string>* params_;
+    };
+
+    std::string tableName(std::string_view name) {
+        std::string folded;
+        appendName(folded, name);
+        if (folded.compare(0, 7, "public.") == 0) folded.erase(0, 7);
+        return folded;
+    }
+
+    void collectCtes(const SqlNode* node, std::vector<std::string>& names) {
+        if (node->kind == SqlNodeKind::Cte) names.push_back(tableName(node->name));
+        for (const SqlNode* c = node->first; c; c = c->next) collectCtes(c, names);
+    }
+
+    // source - узел стоит на месте таблицы (в FROM или JOIN)
+    void collectTables(const SqlNode* node, bool source, const std::vector<std::string>& ctes,
+                       std::vector<std::string>& tables) {
+        if (source && (node->kind == SqlNodeKind::Table || node->kind == SqlNodeKind::Function)) {
+            std::string name = tableName(node->name);
+            if (std::find(ctes.begin(), ctes.end(), name) == ctes.end()) {
+                tables.push_back(std::move(name));
+            }
+        }
+        const bool sources = node->kind == SqlNodeKind::From || node->kind == SqlNodeKind::Join;
+        for (const SqlNode* c = node->first; c; c = c->next) {
+            collectTables(c, sources && c->kind != SqlNodeKind::On && c->kind != SqlNodeKind::Using,
+                          ctes, tables);
+        }
+    }
+
+    // a > b для десятичных записей без знака
+    bool greaterNumber(std::string_view a, std::string_view b) {
+        while (a.size() > 1 && a.front() == '0') a.remove_prefix(1);
+        while (b.size() > 1 && b.front() == '0') b.remove_prefix(1);
+        return a.size() != b.size() ? a.size() > b.size() : a > b;
+    }
+
+    // Арена на поток: разбор на каждом запросе не выделяет память заново
+    SqlArena& threadArena() {
+        thread_local SqlArena arena;
+        arena.clear();
+        return arena;
+    }
+}
+
+SqlParseResult parseSelect(std::string_view sql, SqlArena& arena) {
+    return Parser(sql, arena).run();
+}
+
+std::string printSql(const SqlNode* root) {
+    std::string out;
+    out.reserve(root->end - root->offset + 16);
+    Printer(out, nullptr).print(root);
+    return out;
+}
+
+ParameterizedSql shapeSql(const SqlNode* root) {
+    ParameterizedSql shape;
+    shape.text.reserve(root->end - root->offset + 16);
+    Printer(shape.text, &shape.params).print(root);
+    return shape;
+}
+
+std::vector<std::string> sqlTables(const SqlNode* root) {
+    std::vector<std::string> ctes;
+    collectCtes(root, ctes);
+    std::vector<std::string> tables;
+    collectTables(root, false, ctes, tables);
+    return tables;
+}
+
+SqlShape analyzeSql(const std::string& sql) {
+    SqlShape shape;
+    SqlArena& arena = threadArena();
+    SqlParseResult parsed = parseSelect(sql, arena);
+    if (parsed.root) {
+        shape.parsed = true;
+        shape.key = printSql(parsed.root);
+        shape.statement = parsed.hasParameters ? ParameterizedSql{shape.key, {}} : shapeSql(parsed.root);
+        shape.tables = sqlTables(parsed.root);
+    } else {
+        shape.key = normalizeSql(sql);
+        shape.statement = parameterizeSql(shape.key);
+        if (shape.key.compare(0, 7, "select ") == 0) {
+            shape.tables = referencedTables(shape.key);
+        }
+    }
+    arena.clear();
+    return shape;
+}
+
+bool isReadOnlySelect(const std::string& sql) {
+    SqlArena& arena = threadArena();
+    bool parsed = parseSelect(sql, arena).root != nullptr;
+    arena.clear();
+    return parsed;
+}
+
+std::string limitRows(const std::string& sql, size_t maxRows) {
+    if (maxRows == 0) return sql;
+    SqlArena& arena = threadArena();
+    SqlParseResult parsed = parseSelect(sql, arena);
+    if (!parsed.root) {
+        return applyRowLimit(sql, maxRows);
+    }
+
+    const size_t end = parsed.root->end;
+    const std::string limit = std::to_string(maxRows);
+    std::string result;
+    const SqlNode* limitNode = parsed.root->child(SqlNodeKind::Limit);
+    if (!limitNode) {
+        result = sql.substr(0, end) + " LIMIT " + limit;
+    } else {
+        const SqlNode* value = limitNode->first;
+        bool all = value->kind == SqlNodeKind::Keyword && equalsWord(value->name, "all");
+        bool larger = value->kind == SqlNodeKind::Number && isPlainNumber(value->name) &&
+                      greaterNumber(value->name, limit);
+        bool bounded = value->kind == SqlNodeKind::Number && isPlainNumber(value->name);
+        if (all || larger) {
+            result = sql.substr(0, value->offset) + limit + sql.substr(value->end, end - value->end);
+        } else if (bounded) {
+            result = sql.substr(0, end);
+        } else {
+            // LIMIT $1 или выражение: значение известно только серверу
+            result = "SELECT * FROM (" + sql.substr(0, end) + ") q LIMIT " + limit;
+        }
+    }
+    arena.clear();
+    return result;
+}
+
+}
@@ -0,0 +1,170 @@
+#ifndef SQL_PARSER_H
+#define SQL_PARSER_H
+
+#include "src/utils/SqlText.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Разбор SELECT рекурсивным спуском в дерево, размещённое в арене.
+// Поддерживается подмножество PostgreSQL, которое порождает модель: WITH,
+// UNION/INTERSECT/EXCEPT, JOIN, подзапросы, CASE, CAST и ::, агрегаты с
+// DISTINCT/FILTER/OVER, ORDER BY/LIMIT/OFFSET. Остальное (FETCH, FOR
+// UPDATE, WINDOW, массивы, изменяющие операторы) - ошибка разбора, и
+// вызывающий код переходит к текстовым функциям из SqlText.h.
+// Узлы ссылаются на исходный текст (string_view) и не копируют строк.
+namespace Utils {
+    // Узлы выделяются блоками и освобождаются все сразу (clear или деструктор)
+    class SqlArena {
+    public:
+        SqlArena() = default;
+        SqlArena(const SqlArena&) = delete;
+        SqlArena& operator=(const SqlArena&) = delete;
+
+        template <typename T>
+        T* make() {
+            static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+            return new (allocate(sizeof(T), alignof(T))) T();
+        }
+
+        // Освободить всё, сохранив первый блок для следующего разбора
+        void clear();
+
+    private:
+        static constexpr size_t kBlockSize = 8192;
+
+        void* allocate(size_t size, size_t align);
+
+        std::vector<std::unique_ptr<char[]>> blocks_;
+        char* cursor_ = nullptr;
+        size_t left_ = 0;
+    };
+
+    enum class SqlNodeKind : uint8_t {
+        Query,         // [With] тело [OrderBy] [Limit] [Offset]
+        With,          // Cte...
+        Cte,           // name; Query
+        SetOp,         // name - union/intersect/except; левая и правая части
+        Select,        // SelectList [From] [Where] [GroupBy] [Having]
+        SelectList,    // SelectItem...
+        SelectItem,    // выражение; alias
+        From,          // Table, Subquery, Function или Join через запятую
+        Table,         // name; alias
+        Subquery,      // Query; alias
+        Join,          // name - вид соединения; левая, правая часть, [On | Using]
+        On,
+        Using,         // Column...
+        Where,
+        GroupBy,
+        Having,
+        OrderBy,       // SortItem...
+        SortItem,      // выражение
+        Limit,         // значение
+        Offset,        // значение
+        Column,        // name - имя, возможно с таблицей
+        Star,          // name - * или t.*
+        Number,
+        String,        // name - литерал как в тексте ('...', E'...', $$...$$)
+        Keyword,       // null, true, false, all
+        Param,         // $n
+        TypedLiteral,  // name - тип; String
+        Unary,         // name - оператор
+        Binary,        // name - оператор
+        Is,            // name - "is null", "is not true", ...
+        Between,       // выражение, нижняя и верхняя граница
+        In,            // выражение, затем значения или Query
+        Exists,        // Query
+        Function,      // name; аргументы [OrderBy] [Filter] [Over]
+        Filter,        // условие
+        Over,          // [PartitionBy] [OrderBy]
+        PartitionBy,
+        Case,          // [выражение] When... [Else]
+        When,          // условие, результат
+        Else,
+        Cast           // name - тип; выражение
+    };
+
+    // Флаги узла
+    enum : uint8_t {
+        kSqlDistinct = 1,    // Select, Function: DISTINCT; SetOp: без ALL
+        kSqlAll = 2,         // SetOp: UNION ALL; With: RECURSIVE
+        kSqlNot = 4,         // In, Between
+        kSqlDesc = 8,        // SortItem
+        kSqlNullsFirst = 16, // SortItem
+        kSqlNullsLast = 32,  // SortItem
+        kSqlParens = 64,     // выражение или запрос были в скобках
+        kSqlKeywordForm = 128 // Cast: CAST(x AS t); Function: extract(f FROM x)
+    };
+
+    struct SqlNode {
+        SqlNodeKind kind = SqlNodeKind::Query;
+        uint8_t flags = 0;
+        std::string_view name;
+        std::string_view alias;
+        size_t offset = 0;  // положение в исходном тексте: [offset, end)
+        size_t end = 0;
+        SqlNode* first = nullptr;
+        SqlNode* next = nullptr;
+
+        SqlNode* child(SqlNodeKind k) const {
+            for (SqlNode* c = first; c; c = c->next) {
+                if (c->kind == k) return c;
+            }
+            return nullptr;
+        }
+    };
+
+    struct SqlParseResult {
+        SqlNode* root = nullptr;       // Query; nullptr - запрос не разобран
+        std::string error;
+        size_t errorOffset = 0;
+        bool hasParameters = false;    // в тексте уже есть $n
+    };
+
+    SqlParseResult parseSelect(std::string_view sql, SqlArena& arena);
+
+    // Канонический текст: ключевые слова и имена без кавычек в нижнем
+    // регистре, одиночные пробелы, AS перед псевдонимами, скобки там же,
+    // где в исходном тексте; литералы сохраняются
+    std::string printSql(const SqlNode* root);
+    // То же, но литералы в позициях значений (сравнения, LIKE, BETWEEN, IN,
+    // LIMIT/OFFSET - тип параметра сервер выводит из контекста) заменены на
+    // $1..$n: одинаковая форма у запросов, различающихся только значениями.
+    // Дробные числа и целые длиннее kMaxLiftedDigits остаются в тексте
+    ParameterizedSql shapeSql(const SqlNode* root);
+    // Таблицы из FROM и JOIN (и функции на их месте) без схемы public,
+    // кроме имён из WITH
+    std::vector<std::string> sqlTables(const SqlNode* root);
+
+    // Всё, что нужно для кэша результатов и подготовленных операторов
+    struct SqlShape {
+        bool parsed = false;
+        std::string key;                // канонический текст
+        ParameterizedSql statement;     // форма с параметрами
+        std::vector<std::string> tables;
+    };
+    // Запрос вне поддерживаемого подмножества обрабатывается текстовыми
+    // функциями (normalizeSql, parameterizeSql, referencedTables)
+    SqlShape analyzeSql(const std::string& sql);
+
+    // Запрос, который можно отправить на реплику и выполнить без BEGIN/COMMIT:
+    // одиночный SELECT из разбираемого подмножества (то же, что
+    // SqlShape::parsed). Разбор не принимает FOR UPDATE/SHARE, SELECT INTO и
+    // несколько операторов; функции с записью (nextval, pg_advisory_lock) по
+    // тексту не отличить - реплика отвечает на них ошибкой 25006
+    bool isReadOnlySelect(const std::string& sql);
+
+    // applyRowLimit по дереву: LIMIT дописывается в конец запроса верхнего
+    // уровня или заменяется его числовое значение (и ALL), если оно больше
+    // maxRows. LIMIT с параметром или выражением не проверить по тексту -
+    // запрос оборачивается: SELECT * FROM (...) q LIMIT maxRows. Исходный
+    // текст сохраняется (кроме завершающих ';' и пробелов)
+    std::string limitRows(const std::string& sql, size_t maxRows);
+}
+
+#endif // SQL_PARSER_H
@@ -0,0 +1,418 @@
+#ifndef SQL_TEXT_H
+#define SQL_TEXT_H
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace Utils {
+    // Нормализация SQL для ключей кэша: нижний регистр и одиночные пробелы
+    // вне кавычек, без завершающих ';' и пробелов. Литералы и идентификаторы
+    // в кавычках сохраняются как есть.
+    inline std::string normalizeSql(const std::string& sql) {
+        std::string out;
+        out.reserve(sql.size());
+        char quote = 0;
+        bool pendingSpace = false;
+        for (char c : sql) {
+            if (quote) {
+                out += c;
+                if (c == quote) quote = 0;
+                continue;
+            }
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                pendingSpace = !out.empty();
+                continue;
+            }
+            if (pendingSpace) {
+                out += ' ';
+                pendingSpace = false;
+            }
+            if (c == '\'' || c == '"') quote = c;
+            out += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        while (!out.empty() && (out.back() == ';' || out.back() == ' ')) {
+            out.pop_back();
+        }
+        return out;
+    }
+
+    // Таблицы из списков FROM и JOIN нормализованного запроса (схема public
+    // отбрасывается). Подзапросы обходятся рекурсивно по тем же правилам;
+    // вызовы функций и CTE попадают в список под своими именами, поэтому
+    // вызывающий код должен сверять результат со списком известных таблиц.
+    inline std::vector<std::string> referencedTables(const std::string& sql) {
+        std::vector<std::string> tables;
+        bool expectTable = false;
+        bool inFromList = false;
+        int depth = 0;
+        int listDepth = 0;
+
+        auto isWordChar = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '.' || c == '"';
+        };
+
+        size_t i = 0;
+        while (i < sql.size()) {
+            char c = sql[i];
+            if (c == ' ') {
+                ++i;
+                continue;
+            }
+            if (c == '\'') {
+                size_t end = sql.find('\'', i + 1);
+                i = (end == std::string::npos) ? sql.size() : end + 1;
+                expectTable = false;
+                continue;
+            }
+            if (!isWordChar(c)) {
+                if (c == '(') {
+                    depth++;
+                    expectTable = false;
+                } else if (c == ')') {
+                    depth--;
+                    if (depth < listDepth) inFromList = false;
+                } else if (c == ',' && inFromList && depth == listDepth) {
+                    expectTable = true;
+                }
+                ++i;
+                continue;
+            }
+
+            size_t start = i;
+            while (i < sql.size() && isWordChar(sql[i])) {
+                if (sql[i] == '"') {
+                    size_t end = sql.find('"', i + 1);
+                    i = (end == std::string::npos) ? sql.size() : end + 1;
+                } else {
+                    ++i;
+                }
+            }
+            std::string word = sql.substr(start, i - start);
+
+            if (word == "from") {
+                expectTable = true;
+                inFromList = true;
+                listDepth = depth;
+            } else if (word == "join") {
+                expectTable = true;
+                inFromList = false;
+            } else if (expectTable) {
+                if (word == "only" || word == "lateral") continue;
+                if (word.compare(0, 7, "public.") == 0) word.erase(0, 7);
+                tables.push_back(word);
+                expectTable = false;
+            } else if (word == "where" || word == "group" || word == "order" ||
+                       word == "limit" || word == "having" || word == "union" ||
+                       word == "on" || word == "using" || word == "offset") {
+                inFromList = false;
+            }
+        }
+
+        return tables;
+    }
+
+    struct ParameterizedSql {
+        std::string text;                // запрос с $1..$n вместо литералов
+        std::vector<std::string> params; // значения литералов в текстовом виде
+    };
+
+    // Целые длиннее этого могут не поместиться в integer
+    constexpr size_t kMaxLiftedDigits = 9;
+
+    // Вынос литералов нормализованного запроса в параметры $n. Выносятся
+    // только литералы в позициях значений (после операторов сравнения,
+    // LIKE, BETWEEN/AND, LIMIT/OFFSET и в списках IN), где тип параметра
+    // выводится сервером из контекста; остальные (ORDER BY 1, interval '1 day',
+    // 'x' AS label) остаются в тексте, как и дробные числа и целые длиннее
+    // kMaxLiftedDigits. Запрос, уже содержащий '$', не меняется.
+    inline ParameterizedSql parameterizeSql(const std::string& sql) {
+        ParameterizedSql out;
+        if (sql.find('$') != std::string::npos) {
+            out.text = sql;
+            return out;
+        }
+        out.text.reserve(sql.size());
+
+        auto isWordChar = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        };
+
+        std::string prev;            // последний значимый токен
+        int depth = 0;
+        std::vector<int> inLists;    // глубины открытых списков IN (...)
+        bool betweenPending = false;
+
+        auto liftable = [&]() {
+            return prev == "=" || prev == "<" || prev == ">" || prev == "<=" || prev == ">=" ||
+                   prev == "<>" || prev == "!=" || prev == "like" || prev == "ilike" ||
+                   prev == "limit" || prev == "offset" || prev == "between" ||
+                   prev == "between-and" || prev == "in-item";
+        };
+        auto lift = [&](std::string value) {
+            out.params.push_back(std::move(value));
+            out.text += "$" + std::to_string(out.params.size());
+        };
+
+        size_t i = 0;
+        while (i < sql.size()) {
+            char c = sql[i];
+
+            if (c == ' ') {
+                out.text += c;
+                ++i;
+                continue;
+            }
+
+            if (c == '\'') {
+                size_t start = i++;
+                std::string value;
+                while (i < sql.size()) {
+                    if (sql[i] == '\'') {
+                        if (i + 1 < sql.size() && sql[i + 1] == '\'') {
+                            value += '\'';
+                            i += 2;
+                            continue;
+                        }
+                        ++i;
+                        break;
+                    }
+                    value += sql[i++];
+                }
+                if (liftable()) {
+                    lift(std::move(value));
+                } else {
+                    out.text.append(sql, start, i - start);
+                }
+                prev = "'";
+                continue;
+            }
+
+            if (c == '"') {
+                size_t end = sql.find('"', i + 1);
+                end = (end == std::string::npos) ? sql.size() : end + 1;
+                out.text.append(sql, i, end - i);
+                i = end;
+                prev = "ident";
+                continue;
+            }
+
+            bool startsNumber = std::isdigit(static_cast<unsigned char>(c)) ||
+                                (c == '.' && i + 1 < sql.size() &&
+                                 std::isdigit(static_cast<unsigned char>(sql[i + 1])));
+            if (startsNumber) {
+                size_t start = i;
+                while (i < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[i])) || sql[i] == '.')) ++i;
+                if (i < sql.size() && sql[i] == 'e') {
+                    size_t j = i + 1;
+                    if (j < sql.size() && (sql[j] == '+' || sql[j] == '-')) ++j;
+                    if (j < sql.size() && std::isdigit(static_cast<unsigned char>(sql[j]))) {
+                        i = j;
+                        while (i < sql.size() && std::isdigit(static_cast<unsigned char>(sql[i]))) ++i;
+                    }
+                }
+                // Дробные и длинные числа остаются в тексте: параметр получает
+                // тип другой стороны сравнения, и для целой колонки '30.5' или
+                // '3000000000' не пройдёт, а литерал в тексте корректен
+                bool integral = i - start <= kMaxLiftedDigits &&
+                                sql.find_first_not_of("0123456789", start) >= i;
+                if (liftable() && integral) {
+                    lift(sql.substr(start, i - start));
+                } else {
+                    out.text.append(sql, start, i - start);
+                }
+                prev = "num";
+                continue;
+            }
+
+            if (isWordChar(c)) {
+                size_t start = i;
+                while (i < sql.size() && (isWordChar(sql[i]) || sql[i] == '.')) ++i;
+                std::string word = sql.substr(start, i - start);
+                out.text += word;
+                if (word == "between") {
+                    betweenPending = true;
+                    prev = word;
+                } else if (word == "and" && betweenPending) {
+                    betweenPending = false;
+                    prev = "between-and";
+                } else {
+                    prev = word;
+                }
+                continue;
+            }
+
+            if (c == '<' || c == '>' || c == '=' || c == '!') {
+                size_t start = i;
+                while (i < sql.size() && (sql[i] == '<' || sql[i] == '>' || sql[i] == '=' || sql[i] == '!')) ++i;
+                prev = sql.substr(start, i - start);
+                out.text += prev;
+                continue;
+            }
+
+            out.text += c;
+            ++i;
+            if (c == '(') {
+                depth++;
+                if (prev == "in") {
+                    inLists.push_back(depth);
+                    prev = "in-item";
+                    continue;
+                }
+            } else if (c == ')') {
+                if (!inLists.empty() && inLists.back() == depth) inLists.pop_back();
+                depth--;
+            } else if (c == ',' && !inLists.empty() && inLists.back() == depth) {
+                prev = "in-item";
+                continue;
+            }
+            prev = std::string(1, c);
+        }
+
+        return out;
+    }
+
+    // Один оператор чтения (SELECT, VALUES, TABLE, SHOW) в нормализованном
+    // виде: его можно выполнять без явной транзакции - неявная даёт ту же
+    // согласованность без лишних BEGIN/COMMIT.
+    inline bool isReadOnlySql(const std::string& sql) {
+        static const char* const kReadPrefixes[] = {"select ", "values ", "table ", "show "};
+        bool read = false;
+        for (const char* prefix : kReadPrefixes) {
+            if (sql.compare(0, std::char_traits<char>::length(prefix), prefix) == 0) {
+                read = true;
+                break;
+            }
+        }
+        if (!read) return false;
+
+        // Несколько операторов через ';' или SELECT ... INTO (создаёт таблицу)
+        char quote = 0;
+        for (size_t i = 0; i < sql.size(); ++i) {
+            char c = sql[i];
+            if (quote) {
+                if (c == quote) quote = 0;
+                continue;
+            }
+            if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (c == ';') {
+                return false;
+            } else if (c == ' ' && sql.compare(i, 6, " into ") == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Одиночный SELECT в нормализованном виде: его можно обернуть в
+    // COPY (...) TO STDOUT
+    inline bool isPlainSelect(const std::string& sql) {
+        return sql.compare(0, 7, "select ") == 0 && isReadOnlySql(sql);
+    }
+
+    // Текст оператора без завершающих ';' и пробелов - для вставки в
+    // объемлющий запрос
+    inline std::string stripStatementEnd(const std::string& sql) {
+        size_t end = sql.size();
+        while (end > 0 && (sql[end - 1] == ';' || std::isspace(static_cast<unsigned char>(sql[end - 1])))) {
+            --end;
+        }
+        return sql.substr(0, end);
+    }
+
+    // Ограничить число строк SELECT: дописать LIMIT, если его нет на верхнем
+    // уровне, или уменьшить числовой LIMIT больше maxRows. Запрос с FETCH или
+    // LIMIT-выражением ($1, подзапрос) оборачивается во внешний
+    // SELECT * FROM (...) q LIMIT maxRows; с FOR UPDATE/SHARE не меняется.
+    // Исходный текст сохраняется (кроме завершающих ';' и пробелов).
+    inline std::string applyRowLimit(const std::string& sql, size_t maxRows) {
+        std::string normalized = normalizeSql(sql);
+        if (maxRows == 0 || normalized.compare(0, 7, "select ") != 0 || !isReadOnlySql(normalized)) {
+            return sql;
+        }
+
+        auto isWordChar = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+        };
+
+        size_t end = sql.size();
+        while (end > 0 && (sql[end - 1] == ';' || std::isspace(static_cast<unsigned char>(sql[end - 1])))) {
+            --end;
+        }
+
+        std::string limit = std::to_string(maxRows);
+        auto wrap = [&]() {
+            return "SELECT * FROM (" + sql.substr(0, end) + ") q LIMIT " + limit;
+        };
+
+        size_t limitValue = std::string::npos;  // начало значения LIMIT верхнего уровня
+        bool fetch = false;
+        int depth = 0;
+        char quote = 0;
+        for (size_t i = 0; i < end; ++i) {
+            char c = sql[i];
+            if (quote) {
+                if (c == quote) quote = 0;
+                continue;
+            }
+            if (c == '\'' || c == '"') {
+                quote = c;
+                continue;
+            }
+            if (c == '(') depth++;
+            if (c == ')') depth--;
+            if (depth != 0 || !std::isalpha(static_cast<unsigned char>(c)) || (i > 0 && isWordChar(sql[i - 1]))) {
+                continue;
+            }
+
+            size_t wordEnd = i;
+            std::string word;
+            while (wordEnd < end && isWordChar(sql[wordEnd])) {
+                word += static_cast<char>(std::tolower(static_cast<unsigned char>(sql[wordEnd])));
+                ++wordEnd;
+            }
+            if (word == "for") {
+                return sql;
+            }
+            if (word == "fetch") {
+                fetch = true;
+            }
+            if (word == "limit") {
+                limitValue = wordEnd;
+                while (limitValue < end && std::isspace(static_cast<unsigned char>(sql[limitValue]))) {
+                    ++limitValue;
+                }
+            }
+            i = wordEnd - 1;
+        }
+
+        if (fetch) {
+            return wrap();
+        }
+        if (limitValue == std::string::npos) {
+            return sql.substr(0, end) + " LIMIT " + limit;
+        }
+
+        size_t valueEnd = limitValue;
+        while (valueEnd < end && isWordChar(sql[valueEnd])) ++valueEnd;
+        std::string value = sql.substr(limitValue, valueEnd - limitValue);
+        size_t next = valueEnd;
+        while (next < end && std::isspace(static_cast<unsigned char>(sql[next]))) ++next;
+        // Число, за которым идёт не OFFSET, а продолжение выражения (2+3, 10.5)
+        bool numeric = !value.empty() &&
+                       value.find_first_not_of("0123456789") == std::string::npos &&
+                       (next == end || std::isalpha(static_cast<unsigned char>(sql[next])));
+        bool all = normalizeSql(value) == "all";
+        if (!all && !numeric) {
+            return wrap();
+        }
+        if (!all && (value.size() < limit.size() ||
+                     (value.size() == limit.size() && value <= limit))) {
+            return sql.substr(0, end);
+        }
+        return sql.substr(0, limitValue) + limit + sql.substr(valueEnd, end - valueEnd);
+    }
+}
+
+#endif // SQL_TEXT_H
@@ -0,0 +1,113 @@
+#ifndef TEXT_WIDTH_H
+#define TEXT_WIDTH_H
+
+#include "src/utils/SimdScan.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Ширина текста в колонках терминала. Длина в байтах для UTF-8 не годится:
+// кириллическая буква занимает два байта и одну колонку, иероглиф - три
+// байта и две колонки. ASCII-текст (обычный случай) проверяется блоками
+// и считается по длине без разбора символов.
+namespace Utils {
+    namespace detail {
+        struct CodepointRange {
+            uint32_t first;
+            uint32_t last;
+        };
+
+        inline bool inRanges(uint32_t cp, const CodepointRange* ranges, size_t count) {
+            size_t lo = 0;
+            size_t hi = count;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (cp < ranges[mid].first) {
+                    hi = mid;
+                } else if (cp > ranges[mid].last) {
+                    lo = mid + 1;
+                } else {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    // Ширина символа: 0 - комбинируемые знаки и символы нулевой ширины,
+    // 2 - восточноазиатские широкие символы и эмодзи, иначе 1
+    inline int codepointWidth(uint32_t cp) {
+        static const detail::CodepointRange kZero[] = {
+            {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A},
+            {0x064B, 0x065F}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E},
+            {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x2028, 0x202E},
+            {0x2060, 0x2064}, {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F},
+            {0xFEFF, 0xFEFF}, {0xE0100, 0xE01EF},
+        };
+        static const detail::CodepointRange kWide[] = {
+            {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+            {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x26AA, 0x26AB},
+            {0x26BD, 0x26BE}, {0x26F5, 0x26F5}, {0x26FA, 0x26FA}, {0x2705, 0x2705},
+            {0x270A, 0x270B}, {0x2728, 0x2728}, {0x274C, 0x274C}, {0x2753, 0x2755},
+            {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x2B1B, 0x2B1C},
+            {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E}, {0x3041, 0x33FF},
+            {0x3400, 0x4DBF}, {0x4E00, 0x9FFF}, {0xA000, 0xA4CF}, {0xA960, 0xA97F},
+            {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F},
+            {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4}, {0x17000, 0x18CFF},
+            {0x1B000, 0x1B2FF}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E},
+            {0x1F191, 0x1F19A}, {0x1F200, 0x1F251}, {0x1F300, 0x1F64F}, {0x1F680, 0x1F6FF},
+            {0x1F7E0, 0x1F7EB}, {0x1F90C, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x3FFFD},
+        };
+        // Латиница с диакритикой, кириллица, греческий - до первого диапазона
+        if (cp < 0x0300) return 1;
+        if (detail::inRanges(cp, kZero, sizeof(kZero) / sizeof(kZero[0]))) return 0;
+        if (cp >= 0x1100 && detail::inRanges(cp, kWide, sizeof(kWide) / sizeof(kWide[0]))) return 2;
+        return 1;
+    }
+
+    // Символ в начале data: его длина в байтах и ширина. Некорректный байт
+    // UTF-8 считается одним символом ширины 1 (выводится как есть)
+    inline size_t nextCharacter(const char* data, size_t size, int& width) {
+        const unsigned char* s = reinterpret_cast<const unsigned char*>(data);
+        size_t length = utf8SequenceLength(data, size);
+        if (length <= 1) {
+            width = 1;
+            return 1;
+        }
+        uint32_t cp = s[0] & (0x7F >> length);
+        for (size_t k = 1; k < length; ++k) {
+            cp = (cp << 6) | (s[k] & 0x3F);
+        }
+        width = codepointWidth(cp);
+        return length;
+    }
+
+    inline size_t displayWidth(std::string_view text) {
+        if (isAscii(text.data(), text.size())) return text.size();
+
+        size_t width = 0;
+        for (size_t i = 0; i < text.size();) {
+            int w;
+            i += nextCharacter(text.data() + i, text.size() - i, w);
+            width += static_cast<size_t>(w);
+        }
+        return width;
+    }
+
+    // Длина в байтах самого длинного начала text шириной не больше
+    // maxWidth (символы не разрезаются); ширина этого начала - в width
+    inline size_t fitWidth(std::string_view text, size_t maxWidth, size_t& width) {
+        width = 0;
+        size_t i = 0;
+        while (i < text.size()) {
+            int w;
+            size_t length = nextCharacter(text.data() + i, text.size() - i, w);
+            if (width + static_cast<size_t>(w) > maxWidth) break;
+            width += static_cast<size_t>(w);
+            i += length;
+        }
+        return i;
+    }
+}
+
+#endif // TEXT_WIDTH_H
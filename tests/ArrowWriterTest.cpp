@@ -0,0 +1,148 @@
+#include "tests/Check.h"
+#include "src/core/ArrowWriter.h"
+#include "src/core/PgValue.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr uint8_t kHeaderSchema = 1;
+    constexpr uint8_t kHeaderRecordBatch = 3;
+
+    struct Message {
+        uint8_t headerType = 0;
+        std::string body;
+    };
+
+    template <typename T>
+    T load(const std::string& data, size_t pos) {
+        T value{};
+        if (pos + sizeof(T) <= data.size()) std::memcpy(&value, data.data() + pos, sizeof(T));
+        return value;
+    }
+
+    // Поле таблицы Message (FlatBuffers): 0, если поля нет в vtable
+    template <typename T>
+    T messageField(const std::string& metadata, size_t field) {
+        const size_t table = load<uint32_t>(metadata, 0);
+        const size_t vtable = table - load<int32_t>(metadata, table);
+        const size_t vtableSize = load<uint16_t>(metadata, vtable);
+        const size_t slot = 4 + field * 2;
+        if (slot >= vtableSize) return T{};
+        const uint16_t offset = load<uint16_t>(metadata, vtable + slot);
+        return offset == 0 ? T{} : load<T>(metadata, table + offset);
+    }
+
+    // Разбор потока Arrow IPC по рамкам: 0xFFFFFFFF, длина метаданных,
+    // метаданные, тело длиной Message.bodyLength. false - рамки нарушены
+    bool parseStream(const std::string& stream, std::vector<Message>& messages) {
+        size_t pos = 0;
+        while (pos + 8 <= stream.size()) {
+            if (load<uint32_t>(stream, pos) != 0xFFFFFFFFu) return false;
+            const uint32_t length = load<uint32_t>(stream, pos + 4);
+            pos += 8;
+            if (length == 0) return pos == stream.size();  // конец потока
+            if (length % 8 != 0 || pos + length > stream.size()) return false;
+
+            const std::string metadata = stream.substr(pos, length);
+            pos += length;
+            Message message;
+            message.headerType = messageField<uint8_t>(metadata, 1);
+            const int64_t bodyLength = messageField<int64_t>(metadata, 3);
+            if (bodyLength % 8 != 0 || pos + bodyLength > stream.size()) return false;
+            message.body = stream.substr(pos, static_cast<size_t>(bodyLength));
+            pos += static_cast<size_t>(bodyLength);
+            messages.push_back(std::move(message));
+        }
+        return false;
+    }
+
+    void appendInt4(QueryResult::Column& column, int32_t value) {
+        column.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // id int4 (машинный) {1, 2, NULL}, name text {"alpha", "", "beta"}
+    QueryResult sampleBatch() {
+        QueryResult batch;
+        batch.columns = {"id", "name"};
+        batch.columnTypes = {PgValue::kInt4, 25};
+        batch.data.emplace_back(PgValue::kInt4, true);
+        batch.data.emplace_back(25, false);
+        appendInt4(batch.data[0], 1);
+        appendInt4(batch.data[0], 2);
+        batch.data[0].appendNull();
+        batch.data[1].append("alpha", 5);
+        batch.data[1].append("", 0);
+        batch.data[1].append("beta", 4);
+        batch.rowCount = 3;
+        batch.success = true;
+        return batch;
+    }
+}
+
+TEST(streamFraming) {
+    StringSink sink;
+    ArrowWriter writer(sink);
+    QueryResult batch = sampleBatch();
+    writer.write(batch);
+    writer.finish(3, false);
+    const std::string stream = sink.take();
+
+    std::vector<Message> messages;
+    CHECK(parseStream(stream, messages));
+    CHECK_EQ(messages.size(), 2u);
+    if (messages.size() != 2) return;
+    CHECK_EQ(int(messages[0].headerType), int(kHeaderSchema));
+    CHECK(messages[0].body.empty());
+    CHECK_EQ(int(messages[1].headerType), int(kHeaderRecordBatch));
+
+    // Буферы тела по 8 байт: маска id, значения id, (маски name нет),
+    // смещения name, байты name
+    const std::string& body = messages[1].body;
+    CHECK_EQ(body.size(), 56u);
+    if (body.size() != 56) return;
+    CHECK_EQ(int(static_cast<unsigned char>(body[0])), 0x03);
+    CHECK_EQ(load<int32_t>(body, 8), 1);
+    CHECK_EQ(load<int32_t>(body, 12), 2);
+    CHECK_EQ(load<int32_t>(body, 16), 0);
+    CHECK_EQ(load<int32_t>(body, 24), 0);
+    CHECK_EQ(load<int32_t>(body, 28), 5);
+    CHECK_EQ(load<int32_t>(body, 32), 5);
+    CHECK_EQ(load<int32_t>(body, 36), 9);
+    CHECK_EQ(body.substr(40, 9), "alphabeta");
+}
+
+TEST(schemaIsWrittenOnce) {
+    StringSink sink;
+    ArrowWriter writer(sink);
+    QueryResult batch = sampleBatch();
+    writer.write(batch);
+    writer.write(batch);
+    writer.finish(6, false);
+
+    std::vector<Message> messages;
+    CHECK(parseStream(sink.take(), messages));
+    CHECK_EQ(messages.size(), 3u);
+    for (size_t i = 0; i < messages.size(); ++i) {
+        CHECK_EQ(int(messages[i].headerType), int(i == 0 ? kHeaderSchema : kHeaderRecordBatch));
+    }
+}
+
+TEST(emptyResultIsValidStream) {
+    StringSink sink;
+    ArrowWriter writer(sink);
+    writer.finish(0, false);
+
+    std::vector<Message> messages;
+    CHECK(parseStream(sink.take(), messages));
+    CHECK_EQ(messages.size(), 1u);
+}
+
+TEST(typeMapping) {
+    CHECK(ArrowWriter::typeOf(PgValue::kInt8, true) == ArrowWriter::Type::Int64);
+    CHECK(ArrowWriter::typeOf(PgValue::kFloat4, false) == ArrowWriter::Type::Float32);
+    CHECK(ArrowWriter::typeOf(PgValue::kDate, true) == ArrowWriter::Type::Date32);
+    CHECK(ArrowWriter::typeOf(PgValue::kDate, false) == ArrowWriter::Type::Utf8);
+    CHECK(ArrowWriter::typeOf(PgValue::kNumeric, true) == ArrowWriter::Type::Utf8);
+}
@@ -0,0 +1,60 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Минимальные модульные тесты без внешних зависимостей: TEST(имя)
+// регистрирует функцию, CHECK/CHECK_EQ отмечают ошибку и продолжают тест.
+// main (TestMain.cpp) выполняет все тесты исполняемого файла; код возврата
+// ненулевой, если была хотя бы одна ошибка.
+namespace Check {
+    struct TestCase {
+        const char* name;
+        void (*run)();
+    };
+
+    inline std::vector<TestCase>& registry() {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool add(const char* name, void (*run)()) {
+        registry().push_back({name, run});
+        return true;
+    }
+
+    inline void fail(const char* file, int line, const std::string& message) {
+        failures()++;
+        std::cerr << file << ":" << line << ": " << message << "\n";
+    }
+
+    template <typename A, typename B>
+    void equal(const A& actual, const B& expected, const char* expression, const char* file, int line) {
+        if (actual == expected) return;
+        std::ostringstream message;
+        message << expression << ": got \"" << actual << "\", expected \"" << expected << "\"";
+        fail(file, line, message.str());
+    }
+}
+
+#define TEST(name)                                                      \
+    static void name();                                                 \
+    static const bool name##Registered = Check::add(#name, &name);      \
+    static void name()
+
+#define CHECK(condition)                                                \
+    do {                                                                \
+        if (!(condition)) Check::fail(__FILE__, __LINE__, #condition);  \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) Check::equal((actual), (expected), #actual, __FILE__, __LINE__)
+
+#endif // TESTS_CHECK_H
@@ -0,0 +1,92 @@
+#include "tests/Check.h"
+#include "src/core/CsvWriter.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr Oid kText = 25;
+
+    // Одна текстовая колонка; nullptr - NULL
+    QueryResult column(const std::string& name, const std::vector<const char*>& values) {
+        QueryResult result;
+        result.addColumn(name, kText);
+        for (const char* value : values) {
+            if (value) {
+                result.data[0].append(value, std::strlen(value));
+            } else {
+                result.data[0].appendNull();
+            }
+        }
+        result.rowCount = static_cast<int>(values.size());
+        result.success = true;
+        return result;
+    }
+
+    std::string csv(const QueryResult& result, CsvWriter::Options options = {}, size_t capacity = 16 * 1024) {
+        StringSink sink(capacity);
+        CsvWriter writer(sink, std::move(options));
+        writer.write(result);
+        writer.finish(static_cast<size_t>(result.rowCount), false);
+        return sink.take();
+    }
+}
+
+TEST(quotingShortFields) {
+    QueryResult result = column("v", {"plain", "a\"b", "x,y", "cr\rlf", "line\nbreak", "", nullptr});
+    CHECK_EQ(csv(result), "v\nplain\n\"a\"\"b\"\n\"x,y\"\n\"cr\rlf\"\n\"line\nbreak\"\n\"\"\n\n");
+}
+
+TEST(quotingLongFieldsUsesSameRules) {
+    // 16 байт и больше - поиск спецсимволов блоками SIMD, в том числе в хвосте
+    const std::string quote = std::string(40, 'a') + "\"" + std::string(7, 'b');
+    const std::string delimiter = std::string(31, 'c') + ",";
+    const std::string tail = std::string(17, 'd') + "\n";
+    const std::string clean = std::string(64, 'e');
+    QueryResult result = column("v", {quote.c_str(), delimiter.c_str(), tail.c_str(), clean.c_str()});
+    CHECK_EQ(csv(result), "v\n\"" + std::string(40, 'a') + "\"\"" + std::string(7, 'b') + "\"\n\"" +
+                              delimiter + "\"\n\"" + tail + "\"\n" + clean + "\n");
+}
+
+TEST(nullTextCollision) {
+    CsvWriter::Options options;
+    options.nullText = "\\N";
+    QueryResult result = column("v", {"\\N", nullptr, ""});
+    CHECK_EQ(csv(result, options), "v\n\"\\N\"\n\\N\n\n");
+}
+
+TEST(customDelimiter) {
+    CsvWriter::Options options;
+    options.delimiter = ';';
+    QueryResult result;
+    result.addColumn("a;b", kText);
+    result.addColumn("c", kText);
+    result.data[0].append("x,y", 3);
+    result.data[1].append("p;q", 3);
+    result.rowCount = 1;
+    result.success = true;
+    CHECK_EQ(csv(result, options), "\"a;b\";c\nx,y;\"p;q\"\n");
+    CHECK_EQ(CsvWriter::copyOptions(options), "FORMAT csv, HEADER, DELIMITER ';', NULL ''");
+}
+
+TEST(invalidOptionsFallBack) {
+    CsvWriter::Options options;
+    options.delimiter = '"';
+    CHECK(!CsvWriter::valid(options));
+    options.delimiter = '|';
+    options.nullText = "a|b";
+    CHECK(!CsvWriter::valid(options));
+    QueryResult result = column("v", {"x|y", nullptr});
+    CHECK_EQ(csv(result, options), "v\nx|y\n\n");
+}
+
+TEST(smallSinkWithMediumField) {
+    // Поле больше ёмкости приёмника (минимум 256), но меньше kInlineField
+    const std::string field(600, 'z');
+    QueryResult result = column("v", {field.c_str(), "end"});
+    CHECK_EQ(csv(result, {}, 256), "v\n" + field + "\nend\n");
+}
+
+TEST(headerOnlyForEmptyResult) {
+    CHECK_EQ(csv(column("v", {})), "v\n");
+}
@@ -0,0 +1,126 @@
+#include "tests/Check.h"
+#include "src/core/JsonWriter.h"
+#include "src/core/PgValue.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr Oid kText = 25;
+
+    // Текстовые колонки; nullptr - NULL
+    QueryResult textResult(const std::vector<std::string>& names, const std::vector<Oid>& types,
+                           const std::vector<std::vector<const char*>>& rows) {
+        QueryResult result;
+        for (size_t i = 0; i < names.size(); ++i) result.addColumn(names[i], types[i]);
+        for (const auto& row : rows) {
+            for (size_t i = 0; i < row.size(); ++i) {
+                if (row[i]) {
+                    result.data[i].append(row[i], std::strlen(row[i]));
+                } else {
+                    result.data[i].appendNull();
+                }
+            }
+        }
+        result.rowCount = static_cast<int>(rows.size());
+        result.success = true;
+        return result;
+    }
+
+    // Эталон Layout::Objects; некорректный UTF-8 nlohmann тоже заменяет на U+FFFD
+    std::string reference(const QueryResult& result) {
+        return ResponseParser().toJSON(result).dump(2, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+
+    std::string written(const QueryResult& result, ResponseParser::OutputFormat format) {
+        return ResponseParser().formatResponse(result, format);
+    }
+}
+
+TEST(objectsMatchDump) {
+    QueryResult result = textResult(
+        {"id", "name", "score", "active"},
+        {PgValue::kInt4, kText, PgValue::kFloat8, PgValue::kBool},
+        {
+            {"1", "plain", "2.5", "t"},
+            {"-7", "quote \" backslash \\ tab \t newline \n ctl \x01", "NaN", "f"},
+            {nullptr, "юникод ✓", "1e300", nullptr},
+            {"3", "bad \xff utf8 \xc3", "-0.125", "t"},
+            {"not a number", "", "Infinity", "yes"},
+        });
+    CHECK_EQ(written(result, ResponseParser::OutputFormat::JSON), reference(result));
+}
+
+TEST(duplicateColumnNamesKeepLastValue) {
+    QueryResult result = textResult({"a", "b", "a"}, {kText, kText, PgValue::kInt4},
+                                    {{"first", "x", "10"}, {nullptr, "y", nullptr}});
+    CHECK_EQ(written(result, ResponseParser::OutputFormat::JSON), reference(result));
+}
+
+TEST(emptyAndTruncatedResults) {
+    QueryResult empty = textResult({"id"}, {PgValue::kInt4}, {});
+    CHECK_EQ(written(empty, ResponseParser::OutputFormat::JSON), reference(empty));
+
+    QueryResult truncated = textResult({"id"}, {PgValue::kInt4}, {{"1"}});
+    truncated.truncated = true;
+    CHECK_EQ(written(truncated, ResponseParser::OutputFormat::JSON), reference(truncated));
+}
+
+TEST(nativeValuesMatchDump) {
+    QueryResult result;
+    result.columns = {"n", "f"};
+    result.columnTypes = {PgValue::kInt8, PgValue::kFloat8};
+    result.data.emplace_back(PgValue::kInt8, true);
+    result.data.emplace_back(PgValue::kFloat8, true);
+    const int64_t integers[] = {9000000000, -1};
+    const double reals[] = {0.1, std::nan("")};
+    for (int r = 0; r < 2; ++r) {
+        result.data[0].append(reinterpret_cast<const char*>(&integers[r]), sizeof(int64_t));
+        result.data[1].append(reinterpret_cast<const char*>(&reals[r]), sizeof(double));
+    }
+    result.rowCount = 2;
+    result.success = true;
+    CHECK_EQ(written(result, ResponseParser::OutputFormat::JSON), reference(result));
+}
+
+TEST(numericIsExact) {
+    QueryResult result = textResult({"amount"}, {PgValue::kNumeric},
+                                    {{"12345678901234567890.123"}, {"1234.5600"}, {"NaN"}, {"42"}});
+    const std::string out = written(result, ResponseParser::OutputFormat::JSON);
+    CHECK(out.find("\"amount\": 12345678901234567890.123\n") != std::string::npos);
+    CHECK(out.find("\"amount\": 1234.5600\n") != std::string::npos);
+    CHECK(out.find("\"amount\": \"NaN\"\n") != std::string::npos);
+    CHECK(out.find("\"amount\": 42\n") != std::string::npos);
+
+    // toJSON: не представимое точно - строкой, а не округлённым double
+    auto json = ResponseParser().toJSON(result);
+    CHECK(json["data"][0]["amount"].is_string());
+    CHECK(json["data"][3]["amount"] == 42);
+}
+
+TEST(compactLayout) {
+    QueryResult result = textResult({"b", "a", "b"}, {kText, PgValue::kInt4, kText},
+                                    {{"x\"y", "1", nullptr}, {"\xff", nullptr, "z"}});
+    CHECK_EQ(written(result, ResponseParser::OutputFormat::JSON_COMPACT),
+             "{\"columns\":[\"b\",\"a\",\"b\"],\"data\":[[\"x\\\"y\",1,\"NULL\"],"
+             "[\"\xef\xbf\xbd\",\"NULL\",\"z\"]],\"rowCount\":2,\"success\":true}");
+
+    QueryResult empty = textResult({}, {}, {});
+    CHECK_EQ(written(empty, ResponseParser::OutputFormat::JSON_COMPACT),
+             "{\"columns\":[],\"data\":[],\"rowCount\":0,\"success\":true}");
+}
+
+TEST(streamedBatchesMatchWholeResult) {
+    QueryResult whole = textResult({"id", "name"}, {PgValue::kInt4, kText},
+                                   {{"1", "a"}, {"2", nullptr}, {"3", "c"}});
+    QueryResult first = textResult({"id", "name"}, {PgValue::kInt4, kText}, {{"1", "a"}, {"2", nullptr}});
+    QueryResult second = textResult({"id", "name"}, {PgValue::kInt4, kText}, {{"3", "c"}});
+
+    StringSink sink;
+    JsonWriter writer(sink);
+    writer.write(first);
+    writer.write(second);
+    writer.finish(3, false);
+    CHECK_EQ(sink.take(), reference(whole));
+}
@@ -0,0 +1,73 @@
+#include "tests/Check.h"
+#include "src/core/QueryBuilder.h"
+#include "src/utils/PatternMatcher.h"
+#include <string>
+#include <vector>
+
+namespace {
+    // Вхождения как "номер@начало" в порядке их окончания
+    std::string describe(const PatternMatcher& matcher, std::string_view text) {
+        std::string out;
+        for (const auto& m : matcher.findAll(text)) {
+            if (!out.empty()) out += ' ';
+            out += std::to_string(m.pattern) + "@" + std::to_string(m.offset);
+        }
+        return out;
+    }
+}
+
+TEST(overlappingMatches) {
+    // Классический пример Ахо-Корасик: he, she, his, hers в "ushers"
+    PatternMatcher matcher({"he", "she", "his", "hers"});
+    CHECK_EQ(describe(matcher, "ushers"), "1@1 0@2 3@2");
+    CHECK_EQ(describe(matcher, "ahishers"), "2@1 1@3 0@4 3@4");
+}
+
+TEST(caseInsensitive) {
+    PatternMatcher matcher({"drop", "Select"});
+    CHECK_EQ(describe(matcher, "DROP; select; SeLeCt"), "0@0 1@6 1@14");
+    CHECK_EQ(matcher.findAll("DrOp")[0].length, 4u);
+}
+
+TEST(suffixPatterns) {
+    // Выход суффикса наследуется: "--" находится внутри "---"
+    PatternMatcher matcher({"--", "/*", "*/"});
+    CHECK_EQ(describe(matcher, "a---b"), "0@1 0@2");
+    CHECK_EQ(describe(matcher, "/*/"), "1@0 2@1");
+}
+
+TEST(emptyPatternsAndText) {
+    PatternMatcher none;
+    CHECK(!none.contains("anything"));
+    CHECK_EQ(none.size(), 0u);
+
+    PatternMatcher matcher({"", "x"});
+    CHECK_EQ(describe(matcher, "axb"), "1@1");
+    CHECK(!matcher.contains(""));
+}
+
+TEST(scanStopsEarly) {
+    PatternMatcher matcher({"a"});
+    size_t seen = 0;
+    matcher.scan("aaaa", [&seen](const PatternMatcher::Match&) {
+        return ++seen < 2;
+    });
+    CHECK_EQ(seen, 2u);
+    CHECK(matcher.contains("bba"));
+}
+
+TEST(rebuildReplacesPatterns) {
+    PatternMatcher matcher({"old"});
+    matcher.build({"new"});
+    CHECK(!matcher.contains("old"));
+    CHECK(matcher.contains("brand new"));
+    CHECK_EQ(matcher.pattern(0), "new");
+}
+
+TEST(sanitizeRemovesInjectionFragments) {
+    QueryBuilder builder;
+    CHECK_EQ(builder.sanitize("name; drop"), "name drop");
+    CHECK_EQ(builder.sanitize(" a--b/*/c */ "), "abc");
+    CHECK_EQ(builder.sanitize("\"col\"'"), "col");
+    CHECK_EQ(builder.sanitize("plain_name"), "plain_name");
+}
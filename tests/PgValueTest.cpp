@@ -0,0 +1,113 @@
+#include "tests/Check.h"
+#include "src/core/PgValue.h"
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
+
+namespace {
+    // Значение в сетевом порядке байтов, как его присылает сервер
+    std::string bigEndian(uint64_t value, size_t bytes) {
+        std::string out(bytes, '\0');
+        for (size_t i = 0; i < bytes; ++i) {
+            out[bytes - 1 - i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+        return out;
+    }
+
+    // decodeBinary + formatNative; "<error>", если данные отвергнуты
+    std::string roundTrip(Oid type, const std::string& wire) {
+        std::string native;
+        if (!PgValue::decodeBinary(type, wire.data(), wire.size(), native)) return "<error>";
+        return PgValue::formatNative(type, native);
+    }
+
+    // numeric_send: ndigits, weight, sign, dscale, цифры по основанию 10000
+    std::string numeric(int16_t weight, uint16_t sign, int16_t dscale, std::initializer_list<uint16_t> digits) {
+        std::string out = bigEndian(digits.size(), 2) + bigEndian(static_cast<uint16_t>(weight), 2) +
+                          bigEndian(sign, 2) + bigEndian(static_cast<uint16_t>(dscale), 2);
+        for (uint16_t d : digits) out += bigEndian(d, 2);
+        return out;
+    }
+}
+
+TEST(integers) {
+    CHECK_EQ(roundTrip(PgValue::kInt2, bigEndian(static_cast<uint16_t>(-7), 2)), "-7");
+    CHECK_EQ(roundTrip(PgValue::kInt4, bigEndian(static_cast<uint32_t>(-42), 4)), "-42");
+    CHECK_EQ(roundTrip(PgValue::kInt8, bigEndian(INT64_C(9000000000), 8)), "9000000000");
+    CHECK_EQ(roundTrip(PgValue::kBool, std::string(1, '\1')), "t");
+}
+
+TEST(wrongLengthIsRejected) {
+    CHECK_EQ(roundTrip(PgValue::kInt4, bigEndian(1, 2)), "<error>");
+    CHECK_EQ(roundTrip(PgValue::kInt8, bigEndian(1, 4)), "<error>");
+    CHECK_EQ(roundTrip(PgValue::kNumeric, std::string(6, '\0')), "<error>");
+    CHECK_EQ(roundTrip(PgValue::kNumeric, numeric(0, 0, 0, {1}).substr(0, 9)), "<error>");
+}
+
+TEST(floatsMatchServerOutput) {
+    double tenth = 0.1;
+    uint64_t bits;
+    std::memcpy(&bits, &tenth, sizeof(bits));
+    CHECK_EQ(roundTrip(PgValue::kFloat8, bigEndian(bits, 8)), "0.1");
+
+    double large = 1e20;
+    std::memcpy(&bits, &large, sizeof(bits));
+    CHECK_EQ(roundTrip(PgValue::kFloat8, bigEndian(bits, 8)), "1e+20");
+
+    float half = 1.5f;
+    uint32_t bits32;
+    std::memcpy(&bits32, &half, sizeof(bits32));
+    CHECK_EQ(roundTrip(PgValue::kFloat4, bigEndian(bits32, 4)), "1.5");
+}
+
+TEST(numericKeepsScale) {
+    CHECK_EQ(roundTrip(PgValue::kNumeric, numeric(0, 0x0000, 4, {1234, 5600})), "1234.5600");
+    CHECK_EQ(roundTrip(PgValue::kNumeric, numeric(1, 0x4000, 0, {12, 3})), "-120003");
+    CHECK_EQ(roundTrip(PgValue::kNumeric, numeric(-1, 0x0000, 2, {500})), "0.05");
+    CHECK_EQ(roundTrip(PgValue::kNumeric, numeric(0, 0xC000, 0, {})), "NaN");
+}
+
+TEST(datesAndTimestamps) {
+    CHECK_EQ(roundTrip(PgValue::kDate, bigEndian(0, 4)), "2000-01-01");
+    CHECK_EQ(roundTrip(PgValue::kDate, bigEndian(static_cast<uint32_t>(-1), 4)), "1999-12-31");
+    CHECK_EQ(roundTrip(PgValue::kDate, bigEndian(std::numeric_limits<int32_t>::max(), 4)), "infinity");
+
+    const int64_t day = INT64_C(86400000000);
+    CHECK_EQ(roundTrip(PgValue::kTimestamp, bigEndian(day + 1500000, 8)), "2000-01-02 00:00:01.5");
+    CHECK_EQ(roundTrip(PgValue::kTimestamp, bigEndian(static_cast<uint64_t>(-1000000), 8)),
+             "1999-12-31 23:59:59");
+}
+
+TEST(numbersFromCells) {
+    int64_t integer = 0;
+    std::string native;
+    const std::string wire = bigEndian(123, 4);
+    CHECK(PgValue::decodeBinary(PgValue::kInt4, wire.data(), wire.size(), native));
+    CHECK(PgValue::toInt64(PgValue::kInt4, true, native, integer) && integer == 123);
+    CHECK(PgValue::toInt64(PgValue::kInt4, false, "-5", integer) && integer == -5);
+    CHECK(!PgValue::toInt64(PgValue::kInt4, false, "12x", integer));
+
+    double value = 0;
+    CHECK(PgValue::toDouble(PgValue::kNumeric, true, "2.5", value) && value == 2.5);
+    CHECK(!PgValue::toDouble(PgValue::kFloat8, false, "NaN", value));
+
+    bool flag = false;
+    CHECK(PgValue::toBool(false, "t", flag) && flag);
+    CHECK(!PgValue::toBool(false, "yes", flag));
+}
+
+TEST(numericAsJsonNumber) {
+    CHECK(PgValue::isJsonNumber("12345678901234567890.123"));
+    CHECK(PgValue::isJsonNumber("-0.50"));
+    CHECK(PgValue::isJsonNumber("0"));
+    CHECK(PgValue::isJsonNumber("1.5e-7"));
+    CHECK(!PgValue::isJsonNumber("NaN"));
+    CHECK(!PgValue::isJsonNumber("-Infinity"));
+    CHECK(!PgValue::isJsonNumber("007"));
+    CHECK(!PgValue::isJsonNumber(".5"));
+    CHECK(!PgValue::isJsonNumber("5."));
+    CHECK(!PgValue::isJsonNumber("-"));
+    CHECK(!PgValue::isJsonNumber(""));
+}
@@ -0,0 +1,97 @@
+#include "tests/Check.h"
+#include "src/core/QueryBuilder.h"
+#include "src/utils/SqlLexer.h"
+#include <string>
+#include <vector>
+
+namespace {
+    using Utils::SqlTokenKind;
+
+    struct Lexed {
+        SqlTokenKind kind;
+        std::string text;
+    };
+
+    std::vector<Lexed> lex(std::string_view sql) {
+        Utils::SqlLexer lexer(sql);
+        std::vector<Lexed> tokens;
+        for (Utils::SqlToken token = lexer.next(); token.kind != SqlTokenKind::End; token = lexer.next()) {
+            tokens.push_back({token.kind, std::string(lexer.text(token))});
+        }
+        return tokens;
+    }
+
+    bool valid(const std::string& sql) {
+        return QueryBuilder().validateSQL(sql);
+    }
+}
+
+TEST(literalsAreSingleTokens) {
+    auto tokens = lex("select 'a;b''c', E'it\\'s', $$x;y$$, $tag$ $$ $tag$, \"Col\"\"x\" from t");
+    std::vector<SqlTokenKind> kinds;
+    for (const auto& t : tokens) kinds.push_back(t.kind);
+    CHECK(kinds == (std::vector<SqlTokenKind>{
+        SqlTokenKind::Word, SqlTokenKind::String, SqlTokenKind::Operator, SqlTokenKind::String,
+        SqlTokenKind::Operator, SqlTokenKind::String, SqlTokenKind::Operator, SqlTokenKind::String,
+        SqlTokenKind::Operator, SqlTokenKind::QuotedIdentifier, SqlTokenKind::Word, SqlTokenKind::Word}));
+    if (tokens.size() != 12) return;
+    CHECK_EQ(tokens[1].text, "'a;b''c'");
+    CHECK_EQ(tokens[3].text, "E'it\\'s'");
+    CHECK_EQ(tokens[7].text, "$tag$ $$ $tag$");
+    CHECK_EQ(tokens[9].text, "\"Col\"\"x\"");
+}
+
+TEST(numbersParametersAndComments) {
+    // Операторы - по одному знаку: ">=" - две лексемы
+    auto tokens = lex("x >= 1.5e-3 and y = $12 /* a /* nested */ b */ -- tail");
+    CHECK_EQ(tokens.size(), 10u);
+    if (tokens.size() != 10) return;
+    CHECK(tokens[1].kind == SqlTokenKind::Operator && tokens[2].kind == SqlTokenKind::Operator);
+    CHECK(tokens[3].kind == SqlTokenKind::Number);
+    CHECK_EQ(tokens[3].text, "1.5e-3");
+    CHECK(tokens[7].kind == SqlTokenKind::Parameter);
+    CHECK_EQ(tokens[7].text, "$12");
+    CHECK(tokens[8].kind == SqlTokenKind::Comment);
+    CHECK_EQ(tokens[8].text, "/* a /* nested */ b */");
+    CHECK(tokens[9].kind == SqlTokenKind::Comment);
+    CHECK_EQ(tokens[9].text, "-- tail");
+}
+
+TEST(unterminatedIsError) {
+    CHECK(lex("select 'abc").back().kind == SqlTokenKind::Error);
+    CHECK(lex("select \"abc").back().kind == SqlTokenKind::Error);
+    CHECK(lex("select /* /* */").back().kind == SqlTokenKind::Error);
+    CHECK(lex("select $q$ abc").back().kind == SqlTokenKind::Error);
+}
+
+TEST(keywordSet) {
+    constexpr std::string_view words[] = {"drop", "alter"};
+    constexpr Utils::KeywordSet set(words);
+    static_assert(set.perfect(), "collision in test set");
+    CHECK(set.contains("DROP"));
+    CHECK(set.contains("Alter"));
+    CHECK(!set.contains("dropped"));
+    CHECK(!set.contains(""));
+}
+
+TEST(validateAcceptsReadQueries) {
+    CHECK(valid("SELECT created_at, executed FROM jobs WHERE note = 'drop table x';"));
+    CHECK(valid("select $$; delete$$ as text  ;  "));
+    CHECK(valid("select \"drop\" from t"));
+}
+
+TEST(validateRejectsDangerousInput) {
+    CHECK(!valid("DROP TABLE users"));
+    CHECK(!valid("select 1; select 2"));
+    CHECK(!valid("select 1 -- comment"));
+    CHECK(!valid("select /* x */ 1"));
+    CHECK(!valid("select 'unterminated"));
+    CHECK(!valid("EXECUTE plan(1)"));
+    CHECK(!valid("grant all on t to public"));
+    // Опасный текст в строке выполняется через DO и динамический SQL
+    CHECK(!valid("DO $$BEGIN EXECUTE 'DROP TABLE users'; END$$"));
+    CHECK(!valid("DO $x$ BEGIN DELETE FROM users; END $x$"));
+    CHECK(!valid("SELECT query_to_xml('drop table users', true, true, '')"));
+    CHECK(!valid("select * from dblink_exec('conn', 'drop table users')"));
+    CHECK(!valid("CALL cleanup()"));
+}
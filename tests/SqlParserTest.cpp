@@ -0,0 +1,109 @@
+#include "tests/Check.h"
+#include "src/utils/SqlParser.h"
+#include <string>
+#include <vector>
+
+namespace {
+    std::string joined(const std::vector<std::string>& items) {
+        std::string out;
+        for (const auto& item : items) {
+            if (!out.empty()) out += ',';
+            out += item;
+        }
+        return out;
+    }
+}
+
+TEST(canonicalKeyAndShape) {
+    auto shape = Utils::analyzeSql(
+        "SELECT  Id, u.Name FROM public.users u JOIN orders o ON o.user_id = u.id "
+        "WHERE u.age > 30 AND u.city = 'Kyiv' ORDER BY 1 LIMIT 10;");
+    CHECK(shape.parsed);
+    CHECK_EQ(shape.key,
+             "select id, u.name from public.users as u join orders as o on o.user_id = u.id "
+             "where u.age > 30 and u.city = 'Kyiv' order by 1 limit 10");
+    // ORDER BY 1 - номер колонки, не значение: остаётся в тексте
+    CHECK_EQ(shape.statement.text,
+             "select id, u.name from public.users as u join orders as o on o.user_id = u.id "
+             "where u.age > $1 and u.city = $2 order by 1 limit $3");
+    CHECK_EQ(joined(shape.statement.params), "30,Kyiv,10");
+    CHECK_EQ(joined(shape.tables), "users,orders");
+}
+
+TEST(sameShapeForDifferentValues) {
+    auto a = Utils::analyzeSql("select a from t where x in (1, 2) and z like 'a%'");
+    auto b = Utils::analyzeSql("SELECT a FROM t WHERE x IN (7, 8) AND z LIKE 'b%'");
+    CHECK(a.key != b.key);
+    CHECK_EQ(a.statement.text, b.statement.text);
+    CHECK_EQ(a.statement.text, "select a from t where x in ($1, $2) and z like $3");
+}
+
+TEST(onlySmallIntegersAreLifted) {
+    // Дробное и длинное число для целой колонки параметром не пройдут
+    auto shape = Utils::analyzeSql("select * from t where price = 19.99 and code = 1234567890 "
+                                   "and qty = 123456789 and delta = -4 and ratio = -0.5");
+    CHECK_EQ(shape.statement.text, "select * from t where price = 19.99 and code = 1234567890 "
+                                   "and qty = $1 and delta = $2 and ratio = -0.5");
+    CHECK_EQ(joined(shape.statement.params), "123456789,-4");
+}
+
+TEST(existingParametersAreKept) {
+    auto shape = Utils::analyzeSql("select * from t where a = $1 and b = 2");
+    CHECK(shape.parsed);
+    CHECK_EQ(shape.statement.text, "select * from t where a = $1 and b = 2");
+    CHECK(shape.statement.params.empty());
+}
+
+TEST(unsupportedStatementsAreNotParsed) {
+    const char* rejected[] = {
+        "select 1 from t for update",
+        "select 1; select 2",
+        "select a into b from t",
+        "values (1)",
+        "show all",
+        "with d as (delete from t returning *) select * from d",
+    };
+    for (const char* sql : rejected) {
+        CHECK(!Utils::analyzeSql(sql).parsed);
+        CHECK(!Utils::isReadOnlySelect(sql));
+    }
+    CHECK(Utils::isReadOnlySelect("with r as (select * from t) select * from r join s using (id);"));
+}
+
+TEST(parseErrorPosition) {
+    Utils::SqlArena arena;
+    auto result = Utils::parseSelect("select a from where", arena);
+    CHECK(result.root == nullptr);
+    CHECK(!result.error.empty());
+    CHECK_EQ(result.errorOffset, 14u);
+}
+
+TEST(limitRowsAppendsOrLowers) {
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t;  ", 100), "SELECT a FROM t LIMIT 100");
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t LIMIT 5", 100), "SELECT a FROM t LIMIT 5");
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t LIMIT 500 OFFSET 2", 100), "SELECT a FROM t LIMIT 100 OFFSET 2");
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t LIMIT ALL", 100), "SELECT a FROM t LIMIT 100");
+    // LIMIT в подзапросе не ограничивает результат
+    CHECK_EQ(Utils::limitRows("select * from (select a from t limit 5) s", 100),
+             "select * from (select a from t limit 5) s LIMIT 100");
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t", 0), "SELECT a FROM t");
+}
+
+TEST(limitRowsWrapsUnknownLimits) {
+    CHECK_EQ(Utils::limitRows("SELECT a FROM t LIMIT $1", 100),
+             "SELECT * FROM (SELECT a FROM t LIMIT $1) q LIMIT 100");
+    CHECK_EQ(Utils::limitRows("select a from t limit 2 + 3;", 100),
+             "SELECT * FROM (select a from t limit 2 + 3) q LIMIT 100");
+}
+
+TEST(applyRowLimitTextFallback) {
+    CHECK_EQ(Utils::applyRowLimit("SELECT a FROM t LIMIT 500", 100), "SELECT a FROM t LIMIT 100");
+    CHECK_EQ(Utils::applyRowLimit("SELECT a FROM t LIMIT $1", 100),
+             "SELECT * FROM (SELECT a FROM t LIMIT $1) q LIMIT 100");
+    CHECK_EQ(Utils::applyRowLimit("select a from t limit 2+3", 100),
+             "SELECT * FROM (select a from t limit 2+3) q LIMIT 100");
+    CHECK_EQ(Utils::applyRowLimit("SELECT a FROM t FETCH FIRST 5 ROWS ONLY", 100),
+             "SELECT * FROM (SELECT a FROM t FETCH FIRST 5 ROWS ONLY) q LIMIT 100");
+    CHECK_EQ(Utils::applyRowLimit("SELECT a FROM t FOR UPDATE", 100), "SELECT a FROM t FOR UPDATE");
+    CHECK_EQ(Utils::applyRowLimit("DELETE FROM t", 100), "DELETE FROM t");
+}
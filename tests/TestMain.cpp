@@ -0,0 +1,10 @@
+#include "tests/Check.h"
+
+int main() {
+    for (const auto& test : Check::registry()) {
+        const int before = Check::failures();
+        test.run();
+        std::cout << (Check::failures() == before ? "[ OK ] " : "[FAIL] ") << test.name << "\n";
+    }
+    return Check::failures() == 0 ? 0 : 1;
+}
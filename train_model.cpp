@@ -8,10 +8,12 @@ int main(int argc, char** argv) {
     
     MLModelTrainer trainer;
     
-    // CLI: train_model [epochs] [lr] [--resume]
+    // CLI: train_model [epochs] [lr] [--resume] [--eval-cache[=threshold]]
     int epochs = 50;
     float lr = 0.001f;
     bool resume = false;
+    bool eval_cache = false;
+    float cache_threshold = 0.95f;
     if (argc >= 2) {
         epochs = std::stoi(argv[1]);
     }
@@ -19,8 +21,14 @@ int main(int argc, char** argv) {
         lr = std::stof(argv[2]);
     }
     for (int i = 1; i < argc; ++i) {
-        if (std::string(argv[i]) == "--resume") {
+        std::string arg = argv[i];
+        if (arg == "--resume") {
             resume = true;
+        } else if (arg.rfind("--eval-cache", 0) == 0) {
+            eval_cache = true;
+            if (arg.size() > 13 && arg[12] == '=') {
+                cache_threshold = std::stof(arg.substr(13));
+            }
         }
     }
 
@@ -65,5 +73,15 @@ int main(int argc, char** argv) {
         std::cout << "SQL: " << sql << std::endl << std::endl;
     }
     
+    if (eval_cache) {
+        std::cout << "=== Semantic Cache Evaluation (threshold " << cache_threshold << ") ===" << std::endl;
+        auto report = trainer.evaluateSemanticCache(cache_threshold, 4096);
+        double hit_rate = report.lookups ? 100.0 * report.hits / report.lookups : 0.0;
+        double false_rate = report.hits ? 100.0 * report.false_hits / report.hits : 0.0;
+        std::cout << "Lookups: " << report.lookups << std::endl;
+        std::cout << "Hits: " << report.hits << " (" << hit_rate << "%)" << std::endl;
+        std::cout << "False hits: " << report.false_hits << " (" << false_rate << "% of hits)" << std::endl;
+    }
+    
     return 0;
 }
\ No newline at end of file